@@ -0,0 +1,57 @@
+#version 430 core
+
+// One invocation per run: writes the indirect commands of its draws in order.
+// When compacting, draws left without instances are skipped and the rest packed
+// to the front of the run, their number going to glMultiDrawElementsIndirectCount.
+// Otherwise every draw keeps its slot and empty ones draw no instances.
+layout(local_size_x = 64) in;
+
+// Matches GpuCuller::GpuDraw
+struct Draw {
+    vec4 boundsMin;
+    vec4 boundsMax;
+    uint count;
+    uint firstIndex;
+    int baseVertex;
+    uint baseInstance;
+    uint instanceCount;
+    uint visibleCount;
+    uint pad0;
+    uint pad1;
+};
+
+// Matches GpuCuller::GpuRun
+struct Run {
+    uint first;
+    uint count;
+    uint drawCount;
+    uint pad;
+};
+
+layout(std430, binding = 1) readonly buffer Draws {Draw draws[];};
+layout(std430, binding = 4) writeonly buffer Commands {uint commands[];};
+layout(std430, binding = 5) buffer Runs {Run runs[];};
+
+uniform int runCount;
+uniform int compact;
+
+void main() {
+    uint runIndex = gl_GlobalInvocationID.x;
+    if (runIndex >= uint(runCount)) return;
+
+    Run run = runs[runIndex];
+    uint target = run.first;
+    for (uint d = run.first; d < run.first + run.count; d++) {
+        Draw draw = draws[d];
+        if (compact != 0 && draw.visibleCount == 0u) continue;
+
+        // DrawElementsIndirectCommand
+        commands[target * 5u + 0u] = draw.count;
+        commands[target * 5u + 1u] = draw.visibleCount;
+        commands[target * 5u + 2u] = draw.firstIndex;
+        commands[target * 5u + 3u] = uint(draw.baseVertex);
+        commands[target * 5u + 4u] = draw.baseInstance;
+        target++;
+    }
+    runs[runIndex].drawCount = target - run.first;
+}
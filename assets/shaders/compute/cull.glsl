@@ -0,0 +1,137 @@
+#version 430 core
+
+// One workgroup per draw: its instances are tested against the frustum, then
+// against last frame's depth, and survivors are packed in their original order
+// at the start of the draw's range of the culled instance buffer.
+layout(local_size_x = 64) in;
+
+struct Instance {
+    mat4 model;
+    vec4 params;
+    vec4 normalMatrix[3];
+};
+
+// Matches GpuCuller::GpuDraw
+struct Draw {
+    vec4 boundsMin;
+    vec4 boundsMax;
+    uint count;
+    uint firstIndex;
+    int baseVertex;
+    uint baseInstance;
+    uint instanceCount;
+    uint visibleCount;
+    uint pad0;
+    uint pad1;
+};
+
+layout(std430, binding = 0) readonly buffer Instances {Instance instances[];};
+layout(std430, binding = 1) buffer Draws {Draw draws[];};
+layout(std430, binding = 2) writeonly buffer Culled {Instance culled[];};
+layout(std430, binding = 3) buffer Stats {uint visible; uint frustumCulled; uint occluded;};
+
+uniform vec4 planes[6];
+
+// Hi-Z pyramid of the previous frame, texels hold the farthest depth under them
+uniform int occlusion;
+uniform sampler2D hiz;
+uniform ivec2 hizSize;
+uniform int hizLevels;
+uniform mat4 previousViewProjection;
+
+bool isOccluded(vec3 center, vec3 extent) {
+    vec2 uvMin = vec2(1.0);
+    vec2 uvMax = vec2(0.0);
+    float nearest = 1.0;
+    for (int i = 0; i < 8; i++) {
+        vec3 corner = center + extent * vec3((i & 1) != 0 ? 1.0 : -1.0, (i & 2) != 0 ? 1.0 : -1.0, (i & 4) != 0 ? 1.0 : -1.0);
+        vec4 clip = previousViewProjection * vec4(corner, 1.0);
+
+        // Crossing the near plane, the projection is meaningless
+        if (clip.w <= 1e-4) return false;
+        vec3 ndc = clip.xyz / clip.w;
+        uvMin = min(uvMin, ndc.xy * 0.5 + 0.5);
+        uvMax = max(uvMax, ndc.xy * 0.5 + 0.5);
+        nearest = min(nearest, ndc.z * 0.5 + 0.5);
+    }
+
+    // Outside last frame's view, nothing known about it
+    if (any(lessThan(uvMin, vec2(0.0))) || any(greaterThan(uvMax, vec2(1.0)))) return false;
+
+    // The level where the rectangle spans at most two texels each way
+    vec2 size = (uvMax - uvMin) * vec2(hizSize);
+    int level = clamp(int(ceil(log2(max(max(size.x, size.y), 1.0)))), 0, hizLevels - 1);
+    ivec2 levelSize = max(hizSize >> level, ivec2(1));
+    ivec2 texelMin = clamp(ivec2(uvMin * vec2(levelSize)), ivec2(0), levelSize - 1);
+    ivec2 texelMax = clamp(ivec2(uvMax * vec2(levelSize)), ivec2(0), levelSize - 1);
+
+    float farthest = max(max(texelFetch(hiz, texelMin, level).r, texelFetch(hiz, ivec2(texelMax.x, texelMin.y), level).r),
+                         max(texelFetch(hiz, ivec2(texelMin.x, texelMax.y), level).r, texelFetch(hiz, texelMax, level).r));
+    return nearest > farthest;
+}
+
+shared uint flags[64];
+shared uint groupFrustumCulled;
+shared uint groupOccluded;
+
+// 0 visible, 1 outside the frustum, 2 occluded
+uint test(mat4 model, Draw draw) {
+    vec3 localCenter = (draw.boundsMin.xyz + draw.boundsMax.xyz) * 0.5;
+    vec3 localExtent = (draw.boundsMax.xyz - draw.boundsMin.xyz) * 0.5;
+    vec3 center = vec3(model * vec4(localCenter, 1.0));
+    mat3 axes = mat3(model);
+    vec3 extent = mat3(abs(axes[0]), abs(axes[1]), abs(axes[2])) * localExtent;
+
+    for (int i = 0; i < 6; i++) {
+        if (dot(planes[i].xyz, center) + planes[i].w < -dot(abs(planes[i].xyz), extent)) return 1u;
+    }
+    if (occlusion != 0 && isOccluded(center, extent)) return 2u;
+    return 0u;
+}
+
+void main() {
+    uint drawIndex = gl_WorkGroupID.x;
+    uint lane = gl_LocalInvocationID.x;
+    Draw draw = draws[drawIndex];
+
+    // Draws without a mesh are never culled
+    bool cullable = all(lessThanEqual(draw.boundsMin.xyz, draw.boundsMax.xyz));
+    if (lane == 0u) {
+        groupFrustumCulled = 0u;
+        groupOccluded = 0u;
+    }
+    barrier();
+
+    // 64 instances at a time, a prefix sum over the survivors gives their packed slots
+    uint written = 0u;
+    for (uint first = 0u; first < draw.instanceCount; first += 64u) {
+        uint index = first + lane;
+        uint result = 0u;
+        if (index < draw.instanceCount && cullable) {
+            result = test(instances[draw.baseInstance + index].model, draw);
+            if (result == 1u) atomicAdd(groupFrustumCulled, 1u);
+            if (result == 2u) atomicAdd(groupOccluded, 1u);
+        }
+        bool survives = index < draw.instanceCount && result == 0u;
+        flags[lane] = survives ? 1u : 0u;
+        barrier();
+
+        for (uint offset = 1u; offset < 64u; offset <<= 1) {
+            uint previous = lane >= offset ? flags[lane - offset] : 0u;
+            barrier();
+            flags[lane] += previous;
+            barrier();
+        }
+
+        if (survives) culled[draw.baseInstance + written + flags[lane] - 1u] = instances[draw.baseInstance + index];
+        written += flags[63];
+        barrier();
+    }
+
+    if (lane == 0u) {
+        draws[drawIndex].visibleCount = written;
+        atomicAdd(visible, written);
+        atomicAdd(frustumCulled, groupFrustumCulled);
+        atomicAdd(occluded, groupOccluded);
+    }
+}
@@ -0,0 +1,27 @@
+#version 430 core
+
+// Builds one level of the Hi-Z pyramid, each texel keeps the farthest depth under it.
+// Level 0 reduces the scene depth to the pyramid's power-of-two size, later levels halve it.
+layout(local_size_x = 8, local_size_y = 8) in;
+
+layout(r32f, binding = 0) writeonly uniform image2D destination;
+uniform sampler2D source;
+uniform ivec2 sourceSize;
+uniform int sourceLevel;
+uniform ivec2 destinationSize;
+
+void main() {
+    ivec2 texel = ivec2(gl_GlobalInvocationID.xy);
+    if (any(greaterThanEqual(texel, destinationSize))) return;
+
+    // Every source texel the destination texel touches
+    ivec2 first = texel * sourceSize / destinationSize;
+    ivec2 last = min(((texel + 1) * sourceSize + destinationSize - 1) / destinationSize, sourceSize) - 1;
+    float farthest = 0.0;
+    for (int y = first.y; y <= last.y; y++) {
+        for (int x = first.x; x <= last.x; x++) {
+            farthest = max(farthest, texelFetch(source, ivec2(x, y), sourceLevel).r);
+        }
+    }
+    imageStore(destination, texel, vec4(farthest));
+}
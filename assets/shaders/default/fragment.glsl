@@ -1,9 +1,11 @@
 #version 330 core
+#pragma feature HIGHLIGHT FOG SPECULAR LOCAL_LIGHTS
 
 in vec3 FragPos;
 in vec3 Normal;
 in vec3 Color;
 in vec2 TexCoords;
+flat in float Highlight;
 
 out vec4 FragColor;
 
@@ -11,13 +13,69 @@ uniform vec3 lightDir;
 uniform vec3 lightColor;
 uniform vec3 viewPos;
 uniform sampler2D texture1;
-uniform vec2 textureScale;
-uniform bool isSelected;
 
+// Material constants, see MaterialParams for the layout
+layout(std140) uniform Material {
+    vec4 color;
+    float specularStrength;
+    float shininess;
+} material;
+
+#ifdef FOG
 // Fog uniforms
 uniform vec3 fogColor;
 uniform float fogStart;
 uniform float fogEnd;
+#endif
+
+#ifdef LOCAL_LIGHTS
+// Clustered lights, see LightGrid for the layout
+uniform samplerBuffer lightData;    // Four texels per light
+uniform usamplerBuffer clusterData; // Offset and count per cluster
+uniform usamplerBuffer lightIndices;
+uniform vec3 clusterGrid;
+uniform vec2 clusterScale;          // Clusters per pixel
+uniform vec2 clusterDepth;          // slice = log(depth) * x - y
+uniform mat4 view;
+
+vec3 clusterLighting(vec3 norm, vec3 viewDir) {
+    // Find this fragment's cluster
+    float depth = max(-(view * vec4(FragPos, 1.0)).z, 1e-4);
+    ivec3 cluster = ivec3(ivec2(gl_FragCoord.xy * clusterScale), int(log(depth) * clusterDepth.x - clusterDepth.y));
+    cluster = clamp(cluster, ivec3(0), ivec3(clusterGrid) - 1);
+    int index = (cluster.z * int(clusterGrid.y) + cluster.y) * int(clusterGrid.x) + cluster.x;
+    uvec2 span = texelFetch(clusterData, index).xy;
+
+    vec3 result = vec3(0.0);
+    for (uint i = 0u; i < span.y; i++) {
+        int light = int(texelFetch(lightIndices, int(span.x + i)).r) * 4;
+        vec4 positionRange = texelFetch(lightData, light);
+        vec4 colorType = texelFetch(lightData, light + 1);
+
+        vec3 toLight = positionRange.xyz - FragPos;
+        float dist = length(toLight);
+        if (dist >= positionRange.w) continue;
+        vec3 L = toLight / max(dist, 1e-4);
+
+        // Inverse square, windowed to reach zero at the range
+        float window = clamp(1.0 - pow(dist / positionRange.w, 4.0), 0.0, 1.0);
+        float attenuation = window * window / (1.0 + dist * dist);
+
+        if (colorType.a > 0.5) {
+            vec4 directionSpot = texelFetch(lightData, light + 2);
+            float spotScale = texelFetch(lightData, light + 3).x;
+            attenuation *= clamp((dot(-L, directionSpot.xyz) - directionSpot.w) * spotScale, 0.0, 1.0);
+        }
+
+        float diff = max(dot(norm, L), 0.0);
+#ifdef SPECULAR
+        diff += material.specularStrength * pow(max(dot(norm, normalize(L + viewDir)), 0.0), material.shininess);
+#endif
+        result += diff * colorType.rgb * attenuation;
+    }
+    return result;
+}
+#endif
 
 void main() {
     vec3 norm = normalize(Normal);
@@ -32,16 +90,21 @@ void main() {
     float diff = max(dot(norm, lightDirNorm), 0.0);
     vec3 diffuse = diff * lightColor;
 
+    vec3 lighting = ambient + diffuse;
+
+#ifdef SPECULAR
     // Specular (Blinn-Phong)
-    float specularStrength = 0.5;
     vec3 halfwayDir = normalize(lightDirNorm + viewDir);
-    float spec = pow(max(dot(norm, halfwayDir), 0.0), 32.0); // shininess = 32
-    vec3 specular = specularStrength * spec * lightColor;
+    float spec = pow(max(dot(norm, halfwayDir), 0.0), material.shininess);
+    lighting += material.specularStrength * spec * lightColor;
+#endif
 
-    vec3 lighting = ambient + diffuse + specular;
+#ifdef LOCAL_LIGHTS
+    lighting += clusterLighting(norm, viewDir);
+#endif
 
     // Sample the texture color
-    vec3 texColor = texture(texture1, TexCoords * textureScale).rgb;
+    vec3 texColor = texture(texture1, TexCoords).rgb * material.color.rgb;
 
     // Combine lighting with texture (ignore Color from vertex)
     vec3 result = lighting * texColor;
@@ -52,14 +115,20 @@ void main() {
     // Gamma correction (assuming gamma = 2.2)
     result = pow(result, vec3(1.0 / 2.2));
 
+    vec3 finalColor = result;
+
+#ifdef FOG
     // Fog calculation
     float distance = length(viewPos - FragPos);
     float fogFactor = clamp((fogEnd - distance) / (fogEnd - fogStart), 0.0, 1.0);
-    vec3 finalColor = mix(fogColor, result, fogFactor);
+    finalColor = mix(fogColor, result, fogFactor);
+#endif
 
-    if (isSelected) {
+#ifdef HIGHLIGHT
+    if (Highlight > 0.5) {
         finalColor = mix(finalColor, vec3(1.0, 1.0, 0.0), 0.25); // Tint yellow
     }
+#endif
 
     FragColor = vec4(finalColor, 1.0);
 }
@@ -5,19 +5,28 @@ layout(location = 1) in vec3 aColor;
 layout(location = 2) in vec3 aNormal;
 layout(location = 3) in vec2 aTexCoords;
 
+// Per-instance attributes
+layout(location = 4) in mat4 aModel;
+layout(location = 8) in vec4 aParams; // xy: texture scale, z: highlight
+layout(location = 9) in mat3 aNormalMatrix; // Computed on the CPU
+
 out vec3 FragPos;
 out vec3 Normal;
 out vec3 Color;
 out vec2 TexCoords;
+flat out float Highlight;
+
+// Matches the depth pre-pass bit for bit
+invariant gl_Position;
 
-uniform mat4 model;
 uniform mat4 view;
 uniform mat4 projection;
 
 void main() {
-    FragPos = vec3(model * vec4(aPos, 1.0));
-    Normal = mat3(transpose(inverse(model))) * aNormal;
+    FragPos = vec3(aModel * vec4(aPos, 1.0));
+    Normal = aNormalMatrix * aNormal;
     Color = aColor;
-    TexCoords = aTexCoords;
+    TexCoords = aTexCoords * aParams.xy;
+    Highlight = aParams.z;
     gl_Position = projection * view * vec4(FragPos, 1.0);
 }
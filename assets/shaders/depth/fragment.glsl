@@ -0,0 +1,8 @@
+#version 330 core
+
+out vec4 FragColor;
+
+void main() {
+    // Color writes are masked during the pre-pass, only depth is kept
+    FragColor = vec4(1.0);
+}
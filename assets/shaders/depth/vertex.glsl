@@ -0,0 +1,17 @@
+#version 330 core
+
+layout(location = 0) in vec3 aPos;
+
+// Per-instance attributes
+layout(location = 4) in mat4 aModel;
+
+// Must match the main pass bit for bit so GL_EQUAL depth testing passes
+invariant gl_Position;
+
+uniform mat4 view;
+uniform mat4 projection;
+
+void main() {
+    vec3 fragPos = vec3(aModel * vec4(aPos, 1.0));
+    gl_Position = projection * view * vec4(fragPos, 1.0);
+}
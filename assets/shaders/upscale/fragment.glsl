@@ -0,0 +1,25 @@
+#version 330 core
+
+in vec2 TexCoords;
+out vec4 FragColor;
+
+uniform sampler2D source;
+uniform float sharpness; // 0 is plain bilinear
+
+void main() {
+    vec3 color = texture(source, TexCoords).rgb;
+    if (sharpness > 0.0) {
+        // Unsharp mask against the four neighbors, clamped to them so edges do not ring
+        vec2 texel = 1.0 / vec2(textureSize(source, 0));
+        vec3 north = texture(source, TexCoords + vec2(0.0, texel.y)).rgb;
+        vec3 south = texture(source, TexCoords - vec2(0.0, texel.y)).rgb;
+        vec3 east = texture(source, TexCoords + vec2(texel.x, 0.0)).rgb;
+        vec3 west = texture(source, TexCoords - vec2(texel.x, 0.0)).rgb;
+
+        vec3 blurred = (north + south + east + west) * 0.25;
+        vec3 low = min(min(north, south), min(east, west));
+        vec3 high = max(max(north, south), max(east, west));
+        color = clamp(color + (color - blurred) * sharpness, min(low, color), max(high, color));
+    }
+    FragColor = vec4(color, 1.0);
+}
@@ -0,0 +1,82 @@
+#pragma once
+
+#include <vector>
+#include <cstddef>
+
+#include "mesh.hpp"
+
+// Matches the layout GL expects in a GL_DRAW_INDIRECT_BUFFER
+struct DrawElementsIndirectCommand {
+    unsigned int count;
+    unsigned int instanceCount;
+    unsigned int firstIndex;
+    int baseVertex;
+    unsigned int baseInstance;
+};
+
+// Element range inside one of the arena buffers
+struct ArenaRange {
+    size_t offset = 0;
+    size_t count = 0;
+};
+
+// Geometry arena definition
+// All meshes share one vertex buffer, one index buffer and one VAO.
+class GeometryArena {
+public:
+    // Singleton access
+    static GeometryArena& get();
+
+    // Allocation handling
+    int allocate(const std::vector<Vertex>& vertices, const std::vector<unsigned int>& indices);
+    void release(int handle);
+    void defragment();
+
+    // Getters
+    DrawElementsIndirectCommand getCommand(int handle) const;
+    unsigned int getVAO() const {return VAO;}
+    size_t getVertexCapacity() const {return vertexPool.capacity;}
+    size_t getIndexCapacity() const {return indexPool.capacity;}
+    float getFragmentation() const;
+
+    // Usage
+    void bind() const;
+
+    // Shutdown
+    void shutdown();
+
+private:
+    // Free-list sub-allocator over a single GL buffer
+    struct Pool {
+        unsigned int buffer = 0;
+        size_t elementSize = 0;
+        size_t capacity = 0;
+        size_t top = 0;
+        std::vector<ArenaRange> freeList;
+
+        bool allocate(size_t count, ArenaRange& out);
+        void release(const ArenaRange& range);
+        void grow(size_t minCapacity);
+        size_t freeInHoles() const;
+    };
+
+    // Live allocation slot
+    struct Allocation {
+        ArenaRange vertices;
+        ArenaRange indices;
+        bool live = false;
+    };
+
+    // Arena data
+    unsigned int VAO = 0;
+    Pool vertexPool;
+    Pool indexPool;
+    std::vector<Allocation> allocations;
+    std::vector<int> freeHandles;
+
+    // Internal setup
+    GeometryArena() = default;
+    void init();
+    void setupVertexAttributes() const;
+    void compact(Pool& pool, bool vertices);
+};
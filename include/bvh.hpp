@@ -0,0 +1,75 @@
+#pragma once
+
+#include <vector>
+#include <functional>
+#include <cfloat>
+#include <glm/glm.hpp>
+
+#include "frustum.hpp"
+
+// Axis-aligned bounding box definition
+struct AABB {
+    glm::vec3 min = glm::vec3(FLT_MAX);
+    glm::vec3 max = glm::vec3(-FLT_MAX);
+
+    // Constructors
+    AABB() = default;
+    AABB(const glm::vec3& min, const glm::vec3& max) : min(min), max(max) {}
+    static AABB fromOBB(const OBB& obb);
+
+    // Helpers
+    void expand(const AABB& other);
+    void expand(const glm::vec3& point);
+    glm::vec3 getCenter() const {return (min + max) * 0.5f;}
+    float getSurfaceArea() const;
+    bool overlaps(const AABB& other) const;
+    bool operator==(const AABB& other) const {return min == other.min && max == other.max;}
+};
+
+// Bounding volume hierarchy definition
+// Items are indices into the bounds array given to build().
+class BVH {
+public:
+    // Building
+    void build(const std::vector<AABB>& itemBounds);
+    void update(int item, const AABB& itemBounds);
+    bool needsRebuild();
+    void clear();
+
+    // Queries
+    void queryFrustum(const Frustum& frustum, std::vector<int>& inside, std::vector<int>& partial) const;
+    void queryAABB(const AABB& box, std::vector<int>& out) const;
+    void querySphere(const glm::vec3& center, float radius, std::vector<int>& out) const;
+    int queryRay(const glm::vec3& origin, const glm::vec3& dir, const std::function<bool(int, float&)>& hitTest, float& tOut) const;
+
+    // Getters
+    size_t getItemCount() const {return bounds.size();}
+    size_t getNodeCount() const {return nodes.size();}
+    float getCost() const;
+
+private:
+    // Node definition, leaves reference a run of the items array
+    struct Node {
+        AABB bounds;
+        int left = -1;
+        int right = -1;
+        int parent = -1;
+        int first = 0;
+        int count = 0;
+        bool isLeaf() const {return count > 0;}
+    };
+
+    // Tree data
+    std::vector<Node> nodes;
+    std::vector<int> items;
+    std::vector<AABB> bounds;
+    std::vector<int> itemLeaf;
+
+    // Refit bookkeeping
+    float builtCost = 0.0f;
+    size_t updatesSinceCheck = 0;
+
+    // Internal building
+    int buildRecursive(int first, int count, int parent);
+    void collectLeaves(int node, std::vector<int>& out) const;
+};
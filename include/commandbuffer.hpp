@@ -0,0 +1,172 @@
+#pragma once
+
+#include <vector>
+#include <cstdint>
+#include <glm/glm.hpp>
+
+#include "arena.hpp"
+#include "mesh.hpp"
+#include "shader.hpp"
+#include "texture.hpp"
+#include "material.hpp"
+
+// Per-instance data streamed next to the arena geometry
+struct InstanceData {
+    glm::mat4 model;
+    glm::vec4 params; // xy: texture scale, z: highlight
+    glm::mat3x4 normalMatrix; // Columns padded to vec4, the shader reads xyz
+};
+
+// Recorded draw request, the material's id and texture are copied so later edits do not race the replay
+struct DrawItem {
+    const Mesh* mesh;
+    Shader* shader;
+    unsigned int material;
+    Texture* texture;
+    InstanceData instance;
+    float depth; // View distance of the mesh center, for front-to-back order
+    float textureSize; // View-space size of one texture repeat, times the projection's y scale gives NDC height
+};
+
+// Largest on-screen size of a texture in a frame, for mip streaming
+struct TextureUse {
+    Texture* texture;
+    float size; // Same units as DrawItem::textureSize
+};
+
+// Local bounds of a draw's mesh, for culling on the GPU. Draws without a mesh have min above max and are never culled.
+struct DrawBounds {
+    glm::vec4 min;
+    glm::vec4 max;
+};
+
+// Command kinds, draws carry their own instance range
+enum class CommandType : uint8_t {
+    BindProgram,
+    BindMaterial,
+    Draw
+};
+
+// One fixed-size command, only the fields of its type are meaningful
+struct Command {
+    CommandType type;
+    unsigned int material = 0;
+    Shader* shader = nullptr;
+    Texture* texture = nullptr;
+    DrawElementsIndirectCommand draw = {}; // baseInstance is relative to the owning buffer
+};
+
+// Command buffer definition
+// Linear list of commands recorded by one thread, with the instance data its
+// draws read. Draw requests are collected with submit() and turned into
+// commands by end(): sorted by program, material and mesh so equal meshes
+// become one instanced draw, then runs and draws ordered front to back.
+class CommandBuffer {
+public:
+    // Recording
+    void begin(const glm::mat4& view);
+    void submit(const Mesh* mesh, Shader* shader, const Material& material, const InstanceData& instance);
+    void end();
+
+    // Direct recording, instances are appended in draw order
+    void bindProgram(Shader* shader);
+    void bindMaterial(unsigned int material, Texture* texture);
+    void draw(const DrawElementsIndirectCommand& geometry, const InstanceData* instances, size_t count);
+
+    // Getters
+    const std::vector<Command>& getCommands() const {return commands;}
+    const std::vector<InstanceData>& getInstances() const {return instances;}
+    const std::vector<TextureUse>& getTextureUses() const {return textureUses;}
+    const std::vector<DrawBounds>& getDrawBounds() const {return drawBounds;} // One per draw command, in order
+
+private:
+    // Sorted items sharing a mesh, or groups sharing a program and material, nearest depth first
+    struct Range {
+        size_t first;
+        size_t count;
+        float depth;
+    };
+
+    // Recorded data
+    std::vector<Command> commands;
+    std::vector<InstanceData> instances;
+    std::vector<TextureUse> textureUses;
+    std::vector<DrawBounds> drawBounds;
+
+    // Collected requests and sorting scratch
+    glm::mat4 view = glm::mat4(1.0f);
+    std::vector<DrawItem> items;
+    std::vector<const DrawItem*> order;
+    std::vector<Range> groups;
+    std::vector<Range> runs;
+};
+
+// Receives a replayed stream, the renderer implements it on GL
+class CommandBackend {
+public:
+    virtual ~CommandBackend() = default;
+    virtual void bindProgram(Shader* shader) = 0;
+    virtual void bindMaterial(unsigned int material, Texture* texture) = 0;
+    virtual void draw(size_t firstCommand, size_t commandCount) = 0;
+};
+
+// Command stream definition
+// A frame's command buffers merged in order. Instance data and draws are
+// concatenated with their instance ranges rebased, repeated binds across
+// buffer boundaries are dropped, and consecutive draws become one run.
+class CommandStream {
+public:
+    // Merging and replay
+    void merge(const std::vector<CommandBuffer>& buffers);
+    void replay(CommandBackend& backend) const;
+
+    // Getters
+    const std::vector<InstanceData>& getInstances() const {return instances;}
+    const std::vector<DrawElementsIndirectCommand>& getDraws() const {return draws;}
+    const std::vector<TextureUse>& getTextureUses() const {return textureUses;}
+    const std::vector<DrawBounds>& getDrawBounds() const {return drawBounds;}
+    size_t getRunCount() const {return runCount;}
+
+private:
+    // Merged operation, draws index into the merged draw list
+    struct Op {
+        CommandType type;
+        unsigned int material;
+        Shader* shader;
+        Texture* texture;
+        size_t firstDraw;
+        size_t drawCount;
+    };
+
+    // Merged data
+    std::vector<Op> ops;
+    std::vector<InstanceData> instances;
+    std::vector<DrawElementsIndirectCommand> draws;
+    std::vector<TextureUse> textureUses;
+    std::vector<DrawBounds> drawBounds;
+    size_t runCount = 0;
+};
+
+// Backend that records nothing on the GPU, for checking streams without a context
+class NullBackend : public CommandBackend {
+public:
+    // Constructor
+    NullBackend(const CommandStream& stream) : stream(stream) {}
+
+    // Replay target
+    void bindProgram(Shader* shader) override;
+    void bindMaterial(unsigned int material, Texture* texture) override;
+    void draw(size_t firstCommand, size_t commandCount) override;
+
+    // Counters, draws outside the stream or before a program count as errors
+    size_t programBinds = 0;
+    size_t materialBinds = 0;
+    size_t drawCalls = 0;
+    size_t commands = 0;
+    size_t instances = 0;
+    size_t errors = 0;
+
+private:
+    const CommandStream& stream;
+    Shader* program = nullptr;
+};
@@ -0,0 +1,57 @@
+#pragma once
+
+#include <cstddef>
+
+// Forward declaration
+typedef struct __GLsync* GLsync;
+
+// Dynamic buffer definition
+// Ring of per-frame regions the CPU writes into directly. Each region is
+// guarded by a fence so it is only rewritten once the GPU is done with it.
+class DynamicBuffer {
+public:
+    // Frames in flight
+    static const int FRAME_COUNT = 3;
+
+    // Constructor
+    DynamicBuffer(size_t frameCapacity);
+
+    // Deconstructor
+    ~DynamicBuffer();
+
+    // Frame lifecycle
+    // reserve() must see the frame's total before allocate(), growing drops earlier allocations
+    void beginFrame();
+    void reserve(size_t bytes);
+    void* allocate(size_t bytes, size_t alignment, size_t& offset);
+    void flush();
+    void endFrame();
+
+    // Getters
+    unsigned int getID() const {return buffer;}
+    size_t getFrameCapacity() const {return frameCapacity;}
+    bool isPersistent() const {return persistent;}
+    size_t getStallCount() const {return stalls;}
+
+private:
+    // Buffer data
+    unsigned int buffer = 0;
+    size_t frameCapacity;
+    size_t frameOffset = 0;
+    int frame = 0;
+    bool persistent = false;
+
+    // Mapping
+    unsigned char* mapped = nullptr;
+    bool regionMapped = false;
+
+    // Synchronization
+    GLsync fences[FRAME_COUNT] = {};
+    size_t stalls = 0;
+
+    // Internal setup
+    void create();
+    void destroy();
+    void mapRegion();
+    void waitForFrame(int index);
+};
@@ -0,0 +1,68 @@
+#pragma once
+
+#include <atomic>
+#include <memory>
+#include <string>
+
+#include "shader.hpp"
+#include "profiler.hpp"
+#include "rendergraph.hpp"
+
+// Forward declaration
+class Renderer;
+
+// Dynamic resolution definition
+// Scales the 3D scene's render target so the frame's GPU time stays near a
+// target. GPU time is the sum of the frame's GPU-timed passes, smoothed.
+// The scale drops as soon as a frame runs over the target and only rises
+// after a run of frames well under it, and it moves at most MAX_STEP at a
+// time. After a change it waits for timings that reflect the new size. Below
+// full scale the scene is drawn off-screen and upscaled into the window
+// before the GUI, at full scale it draws straight into the window.
+class DynamicResolution {
+public:
+    // Scale bounds and step size, as a fraction of the window's width and height
+    static constexpr float MIN_SCALE = 0.5f;
+    static constexpr float MAX_SCALE = 1.0f;
+    static constexpr float MAX_STEP = 0.05f;
+
+    // Settings, written from any thread
+    void setEnabled(bool value) {enabled = value;}
+    bool isEnabled() const {return enabled;}
+    void setTargetMs(float value) {targetMs = value;}
+    float getTargetMs() const {return targetMs;}
+    void setSharpness(float value) {sharpness = value;}
+    float getSharpness() const {return sharpness;}
+
+    // State of the last frame, readable from any thread
+    float getScale() const {return scale;}
+    double getGpuMs() const {return gpuMs;}
+
+    // Control, once per frame on the drawing thread with its GPU-capable timeline
+    float update(const Profiler& profiler);
+
+    // Scene passes into target at the current scale, upscaled when below full scale
+    void addScenePasses(RenderGraph& graph, Renderer& renderer, const AttachmentDesc& native,
+        const std::string& target, const std::string& targetDepth);
+
+    // Frees the GL objects, on the drawing thread
+    void release();
+
+private:
+    // Settings
+    std::atomic<bool> enabled{false};
+    std::atomic<float> targetMs{16.6f};
+    std::atomic<float> sharpness{0.25f};
+
+    // Controller state
+    std::atomic<float> scale{MAX_SCALE};
+    std::atomic<double> gpuMs{0.0};
+    double smoothedMs = -1.0;
+    size_t lastResolved = 0;
+    int underBudgetFrames = 0;
+    int settleFrames = 0;
+
+    // Upscale pass
+    std::unique_ptr<Shader> upscaleShader;
+    unsigned int emptyVao = 0;
+};
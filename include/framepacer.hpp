@@ -0,0 +1,76 @@
+#pragma once
+
+#include <atomic>
+#include <mutex>
+#include <condition_variable>
+
+// Pacing modes
+enum class PacingMode {
+    VSync,      // Swap interval 1, frames queue behind the display
+    Capped,     // Swap interval 0, frames start on a fixed grid of capHz
+    LowLatency  // Swap interval 1, input is sampled as late as the predicted frame cost allows
+};
+
+// Frame pacer definition
+// Decides when the game thread samples input and which swap interval the
+// render thread uses. Every frame carries the time its input was sampled,
+// the render thread reports when its swap started and returned, so the
+// pacer knows the input-to-swap latency and the cost of a frame up to its
+// swap. Low latency waits for the previous frame's swap, then sleeps until
+// the next refresh minus the predicted cost, so no frame queues behind
+// another. Waits sleep coarsely and spin the last stretch, the spin covers
+// how late the OS has been waking this thread up.
+class FramePacer {
+public:
+    // Mode, set from any thread
+    void setMode(PacingMode value) {mode = value;}
+    PacingMode getMode() const {return mode;}
+    void setCapHz(float value) {capHz = value;}
+    float getCapHz() const {return capHz;}
+    void setRefreshHz(float value) {refreshHz = value;}
+    float getRefreshHz() const {return refreshHz;}
+
+    // Game thread, waits until input should be sampled and returns the sample time
+    double waitForInput();
+
+    // Render thread, swap interval for the current mode and timestamps of a finished swap
+    int getSwapInterval() const {return mode == PacingMode::Capped ? 0 : 1;}
+    void onSwap(double inputTime, double swapStart, double swapEnd);
+
+    // Stats, readable from any thread
+    double getLatencyMs() const {return latencyMs;}
+    double getAverageLatencyMs() const {return averageLatencyMs;}
+    double getPredictedCostMs() const {return predictedCostMs;}
+
+    // Seconds on the steady clock, shared by both threads
+    static double now();
+
+private:
+    // Settings
+    std::atomic<PacingMode> mode{PacingMode::VSync};
+    std::atomic<float> capHz{120.0f};
+    std::atomic<float> refreshHz{60.0f};
+
+    // Swap tracking, frames sampled on the game thread against frames swapped on the render thread
+    std::mutex mutex;
+    std::condition_variable swapped;
+    size_t sampledFrames = 0;
+    size_t swappedFrames = 0;
+    double lastSwapEnd = 0.0;
+    double costMean = -1.0;
+    double costDeviation = 0.0;
+
+    // Capped grid, game thread only
+    double nextDeadline = 0.0;
+
+    // Wake-up lateness of a short sleep, game thread only
+    double sleepEstimate = 0.002;
+
+    // Stats
+    std::atomic<double> latencyMs{0.0};
+    std::atomic<double> averageLatencyMs{0.0};
+    std::atomic<double> predictedCostMs{0.0};
+
+    // Internal helpers
+    void sleepUntil(double deadline);
+};
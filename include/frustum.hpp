@@ -0,0 +1,47 @@
+#pragma once
+
+#include <vector>
+#include <glm/glm.hpp>
+
+#include "object.hpp"
+
+// Frustum definition
+struct Frustum {
+    // Planes as (normal, distance), normals point inwards
+    glm::vec4 planes[6];
+
+    // Constructors
+    Frustum() = default;
+    static Frustum fromMatrix(const glm::mat4& viewProjection);
+
+    // Intersection
+    bool intersects(const OBB& obb) const;
+};
+
+// Structure-of-arrays OBB storage for batch culling
+struct OBBArray {
+    std::vector<float> centerX, centerY, centerZ;
+    std::vector<float> extentX, extentY, extentZ;
+    std::vector<float> axes[9]; // axis k component j at [k * 3 + j]
+
+    void clear();
+    void reserve(size_t count);
+    void push(const OBB& obb);
+    size_t size() const {return centerX.size();}
+};
+
+// Per-frame culling counters
+struct CullStats {
+    size_t visible = 0;
+    size_t culled = 0;
+    size_t occluded = 0;
+};
+
+// Batch culling kernels, Auto picks the widest one the CPU supports
+enum class CullKernel {Auto, Scalar, SSE, AVX2};
+
+// Batch culling, writes 1 for every box touching the frustum and returns how many did.
+// Every kernel gives the same answer, boxes or planes holding NaNs are kept.
+size_t cullOBBs(const Frustum& frustum, const OBBArray& boxes, std::vector<unsigned char>& visible, CullKernel kernel = CullKernel::Auto);
+bool hasCullKernel(CullKernel kernel);
+const char* getCullKernelName(CullKernel kernel = CullKernel::Auto);
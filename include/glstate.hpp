@@ -0,0 +1,124 @@
+#pragma once
+
+#include <mutex>
+#include <atomic>
+#include <cstddef>
+
+// Issued and filtered calls of one kind of state
+struct GLCallCounts {
+    size_t issued = 0;
+    size_t filtered = 0;
+};
+
+// Calls that went through the state cache in one frame
+struct GLStateStats {
+    GLCallCounts programs;
+    GLCallCounts vertexArrays;
+    GLCallCounts textures;
+    GLCallCounts buffers;
+    GLCallCounts framebuffers;
+    GLCallCounts fixedFunction; // Capabilities, depth, blend and write masks
+
+    GLCallCounts getTotal() const;
+};
+
+// GL state cache definition
+// Shadow copy of the context state the engine changes: program, vertex array,
+// textures per unit, buffer bindings, framebuffers, depth, blend and write
+// masks. Calls that would set what is already set are dropped. Everything in
+// the engine binds through here, so the copy stays true; code outside it that
+// does not restore what it changes must be followed by invalidate(). Deleting
+// through here clears bindings of the deleted name, as GL does, so a reused
+// name is bound again. Element array bindings belong to the bound vertex
+// array and are always issued.
+class GLState {
+public:
+    // Tracked texture units and indexed buffer bindings, higher ones are always issued
+    static const int MAX_TEXTURE_UNITS = 16;
+    static const int MAX_INDEXED_BINDINGS = 16;
+
+    // Singleton access
+    static GLState& get();
+
+    // Bindings
+    void useProgram(unsigned int program);
+    void bindVertexArray(unsigned int vertexArray);
+    void bindTexture(int unit, unsigned int target, unsigned int texture);
+    void bindBuffer(unsigned int target, unsigned int buffer);
+    void bindBufferBase(unsigned int target, unsigned int index, unsigned int buffer);
+    void bindBufferRange(unsigned int target, unsigned int index, unsigned int buffer, size_t offset, size_t size);
+    void bindFramebuffer(unsigned int target, unsigned int framebuffer);
+
+    // Fixed-function state
+    void setEnabled(unsigned int capability, bool enabled);
+    bool isEnabled(unsigned int capability) const;
+    void setDepthFunc(unsigned int func);
+    void setDepthMask(bool enabled);
+    void setColorMask(bool enabled);
+    void setBlendFunc(unsigned int source, unsigned int destination);
+
+    // Deletion, the names are zeroed
+    void deleteProgram(unsigned int& program);
+    void deleteVertexArray(unsigned int& vertexArray);
+    void deleteTexture(unsigned int& texture);
+    void deleteBuffer(unsigned int& buffer);
+    void deleteFramebuffer(unsigned int& framebuffer);
+
+    // Forget everything, the next call of each kind is issued
+    void invalidate();
+
+    // Filtering, off issues every call so both can be compared
+    void setFiltering(bool enabled) {filtering = enabled;}
+    bool getFiltering() const {return filtering;}
+
+    // Stats, endFrame() on the GL thread publishes the frame's counts
+    void endFrame();
+    GLStateStats getStats() const;
+
+private:
+    // Tracked binding targets
+    enum TextureTarget {TEXTURE_2D, TEXTURE_BUFFER, TEXTURE_TARGET_COUNT};
+    enum BufferTarget {ARRAY, DRAW_INDIRECT, PARAMETER, COPY_READ, COPY_WRITE, TEXTURE, SHADER_STORAGE, UNIFORM, BUFFER_TARGET_COUNT};
+    enum Capability {DEPTH_TEST, BLEND, CULL_FACE, SCISSOR_TEST, CAPABILITY_COUNT};
+
+    // Indexed buffer binding
+    struct IndexedBinding {
+        unsigned int buffer;
+        size_t offset;
+        size_t size;
+    };
+
+    // Constructor
+    GLState();
+
+    // Shadow state, UNKNOWN never matches a real value
+    unsigned int program;
+    unsigned int vertexArray;
+    int activeUnit;
+    unsigned int textures[MAX_TEXTURE_UNITS][TEXTURE_TARGET_COUNT];
+    unsigned int buffers[BUFFER_TARGET_COUNT];
+    IndexedBinding storageBindings[MAX_INDEXED_BINDINGS];
+    IndexedBinding uniformBindings[MAX_INDEXED_BINDINGS];
+    unsigned int drawFramebuffer;
+    unsigned int readFramebuffer;
+    int capabilities[CAPABILITY_COUNT];
+    unsigned int depthFunc;
+    int depthMask;
+    int colorMask;
+    unsigned int blendSource;
+    unsigned int blendDestination;
+    std::atomic<bool> filtering{true};
+
+    // Counters of the current frame, and the last published frame
+    GLStateStats frameStats;
+    mutable std::mutex statsMutex;
+    GLStateStats stats;
+
+    // Internal helpers
+    bool filter(bool unchanged, GLCallCounts& counts);
+    void setActiveUnit(int unit);
+    static int getTextureTarget(unsigned int target);
+    static int getBufferTarget(unsigned int target);
+    static int getCapability(unsigned int capability);
+    IndexedBinding* getIndexedBinding(unsigned int target, unsigned int index);
+};
@@ -0,0 +1,145 @@
+#pragma once
+
+#include <vector>
+#include <mutex>
+#include <atomic>
+#include <memory>
+#include <cstddef>
+#include <glm/glm.hpp>
+
+#include "shader.hpp"
+#include "commandbuffer.hpp"
+
+// Forward declaration
+typedef struct __GLsync* GLsync;
+
+// Instance counters of a culled frame, read back a few frames late
+struct GpuCullStats {
+    size_t instances = 0;
+    size_t visible = 0;
+    size_t frustumCulled = 0;
+    size_t occluded = 0;
+};
+
+// GPU culler definition
+// Culls a frame's instances in compute shaders and writes the indirect
+// commands that draw the survivors. Every instance is tested against the
+// frustum, then against a max-depth pyramid of the previous frame's depth
+// seen through the previous view. Survivors are packed in order at the start
+// of their draw's range of a culled instance buffer, which the draws then
+// read in place of the frame's instances. With GL 4.6 empty draws are also
+// compacted out of each run and the rest drawn with
+// glMultiDrawElementsIndirectCount, before that every command is kept and
+// empty ones draw no instances.
+class GpuCuller {
+public:
+    // Frames of stats in flight
+    static const int STATS_FRAMES = 4;
+
+    // Support, compute and storage buffers are core in 4.3
+    static bool isSupported();
+
+    // Constructor
+    GpuCuller();
+
+    // Deconstructor
+    ~GpuCuller();
+
+    // Frame, on the thread that owns the GL context.
+    // The stream's instances are read from instanceBuffer at instanceOffset.
+    void cull(const CommandStream& stream, unsigned int instanceBuffer, size_t instanceOffset, const glm::mat4& viewProjection);
+    size_t draw(size_t firstCommand, size_t commandCount) const;
+    void buildHiZ(unsigned int depthTexture, int width, int height, const glm::mat4& viewProjection);
+
+    // Occlusion against the depth pyramid, toggled from any thread
+    void setOcclusion(bool enabled) {occlusion = enabled;}
+    bool getOcclusion() const {return occlusion;}
+
+    // Getters
+    unsigned int getInstanceBuffer() const {return culledBuffer;}
+    unsigned int getCommandBuffer() const {return commandBuffer;}
+    bool usesDrawCount() const {return drawCount;}
+    GpuCullStats getStats() const;
+
+private:
+    // One draw's bounds and command, std430 layout matching the compute shaders
+    struct GpuDraw {
+        glm::vec4 boundsMin;
+        glm::vec4 boundsMax;
+        unsigned int count;
+        unsigned int firstIndex;
+        int baseVertex;
+        unsigned int baseInstance;
+        unsigned int instanceCount;
+        unsigned int visibleCount;
+        unsigned int pad[2];
+    };
+
+    // Consecutive draws the stream replays as one, drawCount is written on the GPU
+    struct GpuRun {
+        unsigned int first;
+        unsigned int count;
+        unsigned int drawCount;
+        unsigned int pad;
+    };
+
+    // Run as the stream replays it
+    struct Run {
+        size_t first;
+        size_t count;
+    };
+
+    // Replays a stream to find its runs
+    class RunCollector : public CommandBackend {
+    public:
+        std::vector<Run> runs;
+        void bindProgram(Shader*) override {}
+        void bindMaterial(unsigned int, Texture*) override {}
+        void draw(size_t firstCommand, size_t commandCount) override {runs.push_back({firstCommand, commandCount});}
+    };
+
+    // Stats readback slot
+    struct StatsSlot {
+        unsigned int buffer = 0;
+        GLsync fence = nullptr;
+        size_t instances = 0;
+    };
+
+    // Programs
+    std::unique_ptr<Shader> cullShader;
+    std::unique_ptr<Shader> commandShader;
+    std::unique_ptr<Shader> hizShader;
+    bool drawCount = false;
+    std::atomic<bool> occlusion{true};
+
+    // Frame tables, refilled every frame
+    RunCollector collector;
+    std::vector<GpuDraw> draws;
+    std::vector<GpuRun> runs;
+    unsigned int drawBuffer = 0;
+    unsigned int runBuffer = 0;
+
+    // Outputs, grown as needed and only touched by the GPU
+    unsigned int culledBuffer = 0;
+    unsigned int commandBuffer = 0;
+    size_t culledCapacity = 0;
+    size_t commandCapacity = 0;
+
+    // Previous frame's depth pyramid and the view it was seen through
+    unsigned int hizTexture = 0;
+    int hizWidth = 0;
+    int hizHeight = 0;
+    int hizLevels = 0;
+    bool hizValid = false;
+    glm::mat4 hizViewProjection = glm::mat4(1.0f);
+
+    // Stats readback
+    StatsSlot statsSlots[STATS_FRAMES];
+    int currentSlot = 0;
+    mutable std::mutex statsMutex;
+    GpuCullStats stats;
+
+    // Internal helpers
+    void resolveStats();
+    static void reserve(unsigned int buffer, size_t bytes, size_t& capacity);
+};
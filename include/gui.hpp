@@ -4,6 +4,9 @@
 #include "camera.hpp"
 #include "scene.hpp"
 #include "mode.hpp"
+#include "renderer.hpp"
+#include "renderthread.hpp"
+#include "profiler.hpp"
 
 class Gui {
 public:
@@ -15,19 +18,21 @@ public:
 
     // Frame lifecycle
     static void beginFrame();
-    static void endFrame();
+    static void endFrame(GuiSnapshot& snapshot);
 
     // Input syncing
     void syncMouseFromGLFW(GLFWwindow* window);
     void syncKeyboardFromGLFW(GLFWwindow* window);
 
     // Rendering
-    void drawMainMenu(Window& window, Scene& scene, std::unique_ptr<Scene>& playScene, Camera& camera, Camera& playCamera, Mode& mode);
+    void drawMainMenu(Window& window, Scene& scene, Renderer& renderer, std::unique_ptr<Scene>& playScene, Camera& camera, Camera& playCamera, Mode& mode);
     void drawSidebar(Scene& scene);
-    void drawObjectTree(Object& obj, Scene& scene);
     void drawObjectProperties(Scene& scene, Object* selected);
     void drawDeleteConfirmation(Scene& scene);
     void drawLoadScenePopup(Scene& scene);
     void drawSaveScenePopup(Scene& scene);
     void drawPlaytestUI();
+    void drawProfiler();
+    void drawProfilerTimeline(const char* id, const Profiler& profiler);
+    void drawRenderGraph();
 };
@@ -0,0 +1,100 @@
+#pragma once
+
+#include <string>
+#include <vector>
+#include <utility>
+#include <glm/glm.hpp>
+
+#include "profiler.hpp"
+#include "gpuculler.hpp"
+#include "glstate.hpp"
+
+// Options of a headless run, parsed from the command line
+struct HeadlessOptions {
+    bool enabled = false;
+    std::string scene = "default";
+    int frames = 300;
+    int warmup = 10;
+    int width = 1280;
+    int height = 720;
+    glm::vec3 cameraPosition = glm::vec3(0.0f, 0.0f, 3.0f);
+    float cameraYaw = -90.0f;
+    float cameraPitch = 0.0f;
+    bool depthPrepass = false;
+    bool occlusionCulling = true;
+    bool gpuCulling = false;
+    bool stateFiltering = true;
+
+    // GPU frame-time target of the dynamic resolution, off when 0
+    float resolutionTargetMs = 0.0f;
+
+    // Output, empty paths are skipped. Images are written every pngEvery frames, or only the last when 0.
+    std::string jsonPath;
+    std::string pngDir;
+    int pngEvery = 0;
+
+    // Golden images with the same file names, a pixel differs when a channel is off by more than tolerance
+    std::string goldenDir;
+    int tolerance = 2;
+    double maxDiffFraction = 0.001;
+
+    // Parsing, false on bad arguments
+    bool parse(int argc, char** argv);
+    static void printUsage(const char* program);
+};
+
+// Headless runner definition
+// Renders a scene for a fixed number of frames without a window, into a
+// framebuffer on a surfaceless EGL context, so it also runs on Mesa llvmpipe.
+// Frames are recorded and drawn on one thread through the same scene,
+// renderer and render graph as the editor. Frame times go to a JSON report,
+// frames can be written as PNG and compared against golden images.
+class HeadlessRunner {
+public:
+    // Constructor
+    HeadlessRunner(const HeadlessOptions& options);
+
+    // Run, returns the process exit code: 0 passed, 1 failed to run, 2 golden mismatch
+    int run();
+
+private:
+    // Golden comparison of one written frame
+    struct ImageResult {
+        std::string file;
+        int frame = 0;
+        bool compared = false;
+        bool passed = true;
+        int maxDiff = 0;
+        size_t diffPixels = 0;
+    };
+
+    // Run data
+    HeadlessOptions options;
+    std::vector<double> frameMs;
+    std::vector<double> cpuMs;
+    std::vector<double> scales;
+    std::vector<ImageResult> images;
+    GpuCullStats gpuCull;
+    GLStateStats glState;
+    std::vector<std::pair<std::string, size_t>> shaderVariants;
+    std::string glVersion;
+    std::string glRenderer;
+
+    // EGL objects, opaque here so the header needs no EGL
+    void* display = nullptr;
+    void* context = nullptr;
+
+    // Offscreen target
+    unsigned int framebuffer = 0;
+    unsigned int colorBuffer = 0;
+    unsigned int depthBuffer = 0;
+
+    // Internal helpers
+    bool createContext();
+    void destroyContext();
+    void createTarget();
+    void destroyTarget();
+    std::vector<unsigned char> readPixels() const;
+    void saveFrame(int frame, const std::vector<unsigned char>& pixels);
+    bool writeReport(const std::vector<ProfileResult>& passes) const;
+};
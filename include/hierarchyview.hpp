@@ -0,0 +1,57 @@
+#pragma once
+
+#include <string>
+#include <vector>
+#include <unordered_set>
+
+#include "scene.hpp"
+
+// One visible line of the hierarchy
+struct HierarchyRow {
+    Object* object;
+    int depth;
+};
+
+// Hierarchy view definition
+// Flattened order of a scene's hierarchy as the sidebar shows it: roots in
+// the order they were added, each followed by its children when expanded.
+// Only visible rows are stored, so a list clipper draws just the ones on
+// screen. Expanding or collapsing a row splices its subtree in or out, the
+// whole order is rebuilt only when the scene's hierarchy revision changes.
+// Also filters the parents an object can take for the parent picker.
+class HierarchyView {
+public:
+    // Rebuilds the rows if the scene or its hierarchy changed
+    void sync(const Scene& scene);
+
+    // Rows
+    const std::vector<HierarchyRow>& getRows() const {return rows;}
+    bool isExpanded(const Object* object) const {return expanded.count(object) > 0;}
+    void setExpanded(size_t row, bool open);
+
+    // Expands everything above an object, returns its row
+    size_t reveal(const Object* object);
+
+    // Objects that can parent object and contain filter in their name, case-insensitive
+    const std::vector<Object*>& getParentCandidates(const Object* object, const std::string& filter);
+
+private:
+    // Scene the rows belong to
+    const Scene* scene = nullptr;
+    size_t revision = 0;
+    size_t removalRevision = 0;
+
+    // Visible rows and expanded objects
+    std::vector<HierarchyRow> rows;
+    std::unordered_set<const Object*> expanded;
+
+    // Parent candidates and what they were filtered for
+    std::vector<Object*> candidates;
+    const Object* candidatesFor = nullptr;
+    std::string candidatesFilter;
+    size_t candidatesRevision = 0;
+
+    // Internal helpers
+    void rebuild();
+    void appendVisible(Object* object, int depth, std::vector<HierarchyRow>& out) const;
+};
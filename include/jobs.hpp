@@ -0,0 +1,61 @@
+#pragma once
+
+#include <vector>
+#include <thread>
+#include <mutex>
+#include <atomic>
+#include <functional>
+#include <condition_variable>
+#include <deque>
+
+// Job system definition
+// Persistent worker threads for data-parallel loops. The calling thread
+// helps out and parallelFor() only returns once every index has run.
+// Workers with no loop to help with pick up background tasks instead.
+class JobSystem {
+public:
+    // Singleton access
+    static JobSystem& get();
+
+    // Dispatch, jobs must not call parallelFor() themselves
+    void parallelFor(size_t count, const std::function<void(size_t)>& job);
+
+    // Background task, returns at once. Runs on the caller when there are no workers.
+    void submit(std::function<void()> task);
+
+    // Getters
+    size_t getThreadCount() const {return workers.size() + 1;}
+
+    // Shutdown
+    void shutdown();
+
+private:
+    // Constructor
+    JobSystem();
+
+    // Deconstructor
+    ~JobSystem();
+
+    // Workers
+    std::vector<std::thread> workers;
+    std::mutex submitMutex;
+    std::mutex mutex;
+    std::condition_variable wake;
+    std::condition_variable done;
+    bool running = true;
+
+    // Current dispatch
+    const std::function<void(size_t)>* job = nullptr;
+    size_t jobCount = 0;
+    std::atomic<size_t> next{0};
+    std::atomic<size_t> remaining{0};
+    size_t generation = 0;
+    size_t busyWorkers = 0;
+
+    // Background tasks, dropped on shutdown if not started
+    std::deque<std::function<void()>> tasks;
+
+    // Internal helpers
+    void workerLoop();
+    void runJobs(const std::function<void(size_t)>& current, size_t count);
+};
@@ -0,0 +1,107 @@
+#pragma once
+
+#include <vector>
+#include <cstdint>
+#include <glm/glm.hpp>
+
+#include "shader.hpp"
+
+// GPU layout of one light, four texels of the light buffer
+struct GpuLight {
+    glm::vec4 positionRange;  // xyz: world position, w: range
+    glm::vec4 colorType;      // rgb: color times intensity, a: 0 point, 1 spot
+    glm::vec4 directionSpot;  // xyz: world direction, w: cos of the outer angle
+    glm::vec4 spotParams;     // x: 1 / (cos inner - cos outer)
+};
+
+// Per-frame binning counters
+struct LightGridStats {
+    size_t lights = 0;
+    size_t visibleLights = 0;
+    size_t references = 0;
+    size_t maxPerCluster = 0;
+    size_t overflowed = 0;
+};
+
+// Light grid definition
+// Splits the view frustum into screen tiles and exponential depth slices,
+// then lists the lights touching each cluster. Lights are sorted into slices
+// first, after which every slice is filled on its own job. The lists reach
+// the shader through texture buffers, so GL 3.3 is enough.
+class LightGrid {
+public:
+    // Grid resolution and per-cluster capacity
+    static const int GRID_X = 16;
+    static const int GRID_Y = 9;
+    static const int GRID_Z = 24;
+    static const int CLUSTER_COUNT = GRID_X * GRID_Y * GRID_Z;
+    static const int MAX_LIGHTS_PER_CLUSTER = 512;
+
+    // Texture units the buffers are bound to
+    static const int LIGHT_UNIT = 1;
+    static const int CLUSTER_UNIT = 2;
+    static const int INDEX_UNIT = 3;
+
+    // Constructor
+    LightGrid();
+
+    // Deconstructor
+    ~LightGrid();
+
+    // Binning
+    void build(const std::vector<GpuLight>& lights, const glm::mat4& view, const glm::mat4& projection, float near, float far);
+    void upload();
+
+    // Binding
+    void bind() const;
+    void setUniforms(const Shader& shader, const glm::vec2& viewportSize) const;
+
+    // Getters
+    const LightGridStats& getStats() const {return stats;}
+    size_t getClusterIndex(int x, int y, int z) const {return (static_cast<size_t>(z) * GRID_Y + y) * GRID_X + x;}
+    unsigned int getClusterOffset(size_t cluster) const {return clusterData[cluster * 2];}
+    unsigned int getClusterCount(size_t cluster) const {return clusterData[cluster * 2 + 1];}
+    const std::vector<uint16_t>& getLightIndices() const {return lightIndices;}
+
+private:
+    // Light bounds in view space, with the clusters they may touch
+    struct BinnedLight {
+        glm::vec3 center;
+        float radius;
+        int minX, maxX, minY, maxY;
+    };
+
+    // Cluster bounds in view space, structure-of-arrays for SIMD
+    std::vector<float> minX, maxX, minY, maxY, minZ, maxZ;
+    glm::mat4 boundsProjection = glm::mat4(0.0f);
+    float boundsNear = 0.0f;
+    float boundsFar = 0.0f;
+
+    // Depth slicing, slice = log(depth) * scale - bias
+    float sliceScale = 0.0f;
+    float sliceBias = 0.0f;
+
+    // Binning data
+    std::vector<BinnedLight> binned;
+    std::vector<std::vector<int>> sliceLights;
+    std::vector<uint16_t> clusterCounts;
+    std::vector<uint16_t> clusterLights;
+    LightGridStats stats;
+
+    // Upload data
+    std::vector<GpuLight> gpuLights;
+    std::vector<unsigned int> clusterData;
+    std::vector<uint16_t> lightIndices;
+
+    // GL buffers and the texture views onto them
+    unsigned int lightBuffer = 0;
+    unsigned int clusterBuffer = 0;
+    unsigned int indexBuffer = 0;
+    unsigned int lightTexture = 0;
+    unsigned int clusterTexture = 0;
+    unsigned int indexTexture = 0;
+
+    // Internal helpers
+    void updateClusterBounds(const glm::mat4& projection, float near, float far);
+    void fillSlice(int slice);
+};
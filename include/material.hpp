@@ -0,0 +1,104 @@
+#pragma once
+
+#include <string>
+#include <vector>
+#include <mutex>
+#include <utility>
+#include <glm/glm.hpp>
+
+#include "shader.hpp"
+#include "texture.hpp"
+
+// Constants a material hands its shader, std140 layout of the Material block
+struct MaterialParams {
+    glm::vec4 color = glm::vec4(1.0f); // Multiplies the texture
+    float specularStrength = 0.5f;     // 0 compiles the specular terms out
+    float shininess = 32.0f;
+    glm::vec2 padding = glm::vec2(0.0f);
+};
+
+// Material definition
+// Shader, texture and constants shared by every object drawn with them.
+// Objects hold materials by shared pointer, so editing one changes all of
+// its objects and one dropped from the scene's library lives on while used.
+// The constants sit in a slot of the material buffer, whose index is also
+// the id draws are sorted and batched by.
+class Material {
+public:
+    // Constructors
+    Material(const std::string& name, Shader* shader, Texture* texture, const MaterialParams& params = MaterialParams());
+    Material(const Material& other, const std::string& name); // Copy with its own slot
+    Material(const Material&) = delete;
+    Material& operator=(const Material&) = delete;
+
+    // Deconstructor
+    ~Material();
+
+    // Getters
+    const std::string& getName() const {return name;}
+    Shader* getShader() const {return shader;}
+    Texture* getTexture() const {return texture;}
+    const MaterialParams& getParams() const {return params;}
+    unsigned int getID() const {return slot;}
+    unsigned int getFeatures() const; // Shader features the constants leave in
+
+    // Setters, constants reach the GPU with the next frame
+    void setShader(Shader* newShader) {shader = newShader;}
+    void setTexture(Texture* newTexture) {texture = newTexture;}
+    void setParams(const MaterialParams& newParams);
+
+private:
+    // Material data
+    std::string name;
+    Shader* shader = nullptr;
+    Texture* texture = nullptr;
+    MaterialParams params;
+    unsigned int slot = 0;
+};
+
+// Material buffer definition
+// One uniform buffer holding every material's constants, each block in a
+// slice aligned for binding on its own. Slots are handed out and written from
+// any thread; changed ones are copied over by upload() once a frame on the
+// thread owning the context, so a material costs one range bind per draw run
+// instead of a uniform call per constant. A released slot is only handed out
+// again once every frame that could still bind it has been drawn.
+class MaterialBuffer {
+public:
+    // Uniform buffer binding the Material block is read from
+    static const int BINDING = 0;
+
+    // Singleton access
+    static MaterialBuffer& get();
+
+    // Slots, safe from any thread
+    unsigned int allocate(const MaterialParams& params);
+    void release(unsigned int slot);
+    void write(unsigned int slot, const MaterialParams& params);
+
+    // GPU side, on the thread that owns the GL context
+    void upload();
+    void bind(unsigned int slot) const;
+    void shutdown();
+
+    // Getters
+    size_t getSlotCount() const;
+
+private:
+    // Slot data, guarded by the mutex
+    mutable std::mutex mutex;
+    std::vector<MaterialParams> blocks;
+    std::vector<unsigned int> freeSlots;
+    std::vector<std::pair<unsigned int, size_t>> retiredSlots; // Released slots and the frame they were released in
+    size_t frame = 0; // Uploads so far
+    size_t dirtyFirst = 0;
+    size_t dirtyEnd = 0;
+
+    // GPU copy, context thread only
+    unsigned int buffer = 0;
+    size_t capacity = 0; // Slots the buffer holds
+    size_t stride = 0;   // Bytes between slots, the block size rounded up to the offset alignment
+
+    // Internal setup
+    MaterialBuffer() = default;
+};
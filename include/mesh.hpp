@@ -1,9 +1,13 @@
 #pragma once
 
 #include <vector>
+#include <memory>
+#include <mutex>
 #include <glm/glm.hpp>
 #include <string>
 
+#include "meshbvh.hpp"
+
 // Forward declaration
 class Scene;
 
@@ -31,16 +35,20 @@ public:
     std::string getName() const {return name;}
     const std::vector<Vertex>& getVertices() const {return vertices;}
     const std::vector<unsigned int>& getIndices() const {return indices;}
+    int getArenaHandle() const {return arenaHandle;}
 
     // OBB handling
     void calculateBounds(const std::vector<Vertex>& vertices);
 
-    // Rendering
-    void draw() const;
+    // Picking, in mesh space. The triangle BVH is built in the background once
+    // requested, or on first use otherwise. Rays wait for a build in progress.
+    void requestBVH() const;
+    const MeshBVH& getBVH() const;
+    bool raycast(const glm::vec3& origin, const glm::vec3& dir, MeshHit& hit) const;
 
 private:
-    // OpenGL buffers
-    unsigned int VAO, VBO, EBO;
+    // Geometry arena allocation
+    int arenaHandle = -1;
     size_t indexCount;
 
     // Mesh data
@@ -52,6 +60,15 @@ private:
     std::vector<Vertex> vertices;
     std::vector<unsigned int> indices;
 
+    // Triangle BVH for picking, shared with the task building it. The mesh
+    // is cleared on destruction so a task that starts later does nothing.
+    struct BVHState {
+        std::mutex mutex;
+        const Mesh* mesh = nullptr;
+        std::unique_ptr<MeshBVH> bvh;
+    };
+    std::shared_ptr<BVHState> bvhState;
+
     // Internal setup
     void setupMesh(const std::vector<Vertex>& vertices, const std::vector<unsigned int>& indices);
 };
@@ -0,0 +1,61 @@
+#pragma once
+
+#include <vector>
+#include <cstdint>
+#include <glm/glm.hpp>
+
+// Forward declaration
+struct Vertex;
+
+// Closest triangle a ray hits, in the space the ray was given in
+struct MeshHit {
+    float t = 0.0f;
+    glm::vec3 point = glm::vec3(0.0f);
+    int triangle = -1;
+    glm::vec2 barycentrics = glm::vec2(0.0f); // Weights of the triangle's second and third vertex
+};
+
+// Mesh BVH definition
+// Triangle hierarchy of one mesh in its own space, built once and shared by
+// every object drawing the mesh. Nodes are 32 bytes and laid out depth
+// first, so a node's left child follows it and only the right child's index
+// is stored. Leaves reference a run of triangle numbers, the vertices are
+// read from the mesh itself.
+class MeshBVH {
+public:
+    // Building
+    void build(const std::vector<Vertex>& vertices, const std::vector<unsigned int>& indices);
+
+    // Queries, rays need not be normalized and t is in units of dir
+    bool intersect(const std::vector<Vertex>& vertices, const std::vector<unsigned int>& indices,
+                   const glm::vec3& origin, const glm::vec3& dir, MeshHit& hit) const;
+
+    // Getters
+    size_t getNodeCount() const {return nodes.size();}
+    size_t getTriangleCount() const {return triangles.size();}
+    size_t getMemoryBytes() const {return nodes.size() * sizeof(Node) + triangles.size() * sizeof(uint32_t);}
+
+private:
+    // Node definition, offset is the first triangle of a leaf or the right child of an inner node
+    struct Node {
+        glm::vec3 min;
+        uint32_t offset;
+        glm::vec3 max;
+        uint32_t count;
+        bool isLeaf() const {return count > 0;}
+    };
+
+    // Triangle bounds and centroid while building
+    struct BuildTriangle {
+        glm::vec3 min;
+        glm::vec3 max;
+        glm::vec3 centroid;
+    };
+
+    // Tree data
+    std::vector<Node> nodes;
+    std::vector<uint32_t> triangles;
+
+    // Internal building
+    void buildRecursive(std::vector<BuildTriangle>& build, uint32_t first, uint32_t count, int depth);
+};
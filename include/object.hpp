@@ -2,12 +2,17 @@
 
 #include <glm/glm.hpp>
 #include <memory>
+#include <optional>
 
 #include "mesh.hpp"
 #include "camera.hpp"
 #include "shader.hpp"
 #include "mesh.hpp"
 #include "texture.hpp"
+#include "material.hpp"
+
+// Forward declaration
+class CommandBuffer;
 
 // Transform definition
 struct Transform {
@@ -16,15 +21,21 @@ struct Transform {
     glm::vec3 rotation = glm::vec3(0.0f);
     glm::vec3 scale = glm::vec3(1.0f);
 
-    // Update handling
+    // Update handling, dirty stays set until the scene refits the bounds
+    // Objects call this through Object::markDirty so their children follow
     bool dirty = true;
-    void markDirty() {dirty = true;}
+    void markDirty() {dirty = true; matrixDirty = true;}
     void markClean() {dirty = false;}
     bool needsUpdate() const;
 
-    // Get transformed model
-    glm::mat4 getModelMatrix() const;
+    // Get transformed model, rebuilt on the first call after a change
+    const glm::mat4& getModelMatrix() const;
     void setFromModelMatrix(const glm::mat4& model);
+
+private:
+    // Cached model matrix
+    mutable glm::mat4 modelMatrix = glm::mat4(1.0f);
+    mutable bool matrixDirty = true;
 };
 
 // Oriented Bounding Box (OBB) definition
@@ -39,16 +50,30 @@ struct OBB {
     OBB(const glm::vec3& min, const glm::vec3& max);
 };
 
+// Light definition
+// Shines from the owning object's world position, spots along its -Z axis
+enum class LightType {Point, Spot};
+
+struct Light {
+    LightType type = LightType::Point;
+    glm::vec3 color = glm::vec3(1.0f);
+    float intensity = 1.0f;
+    float range = 10.0f;
+    float innerAngle = 20.0f; // Spot cone half-angles in degrees
+    float outerAngle = 30.0f;
+};
+
 // Object definition
 struct Object {
     // Object data
     std::string name;
     bool isPlayer = false;
+    bool isStatic = false; // Never moves during playtest, so it can be batched
 
     Mesh* mesh = nullptr;
-    Shader* shader = nullptr;
-    Texture* texture = nullptr;
-    glm::vec2 textureScale = glm::vec2(1.0f, 1.0f);
+    std::shared_ptr<Material> material;
+    glm::vec2 textureScale = glm::vec2(1.0f, 1.0f); // Per instance, so objects sharing a material can tile differently
+    std::optional<Light> light;
 
     Transform transform;
     OBB obb;
@@ -59,20 +84,35 @@ struct Object {
     // Constructors
     Object() = default;
     Object(const std::string& name, const std::string& modelName, const std::string& textureName, const std::string& shaderName);
+    Object(const std::string& name, Mesh* mesh, std::shared_ptr<Material> material);
     Object(const Object& other);
         
     // OBB handling
     void initializeOBB(const glm::vec3& meshMin, const glm::vec3& meshMax);
     void updateOBB();
 
-    // Inheritance handling
-    glm::mat4 getWorldMatrix() const;
+    // Inheritance handling, world matrices are cached and refreshed by the
+    // scene's bounds update before the parallel draw jobs read them
+    const glm::mat4& getWorldMatrix() const;
+    void markDirty(); // Call after changing the transform
     void setParent(Object* newParent);
     bool isDescendant(const Object* target) const;
+
+    // Picking, the closest triangle a world space ray hits, t and point in world units
+    bool raycast(const glm::vec3& origin, const glm::vec3& dir, MeshHit& hit) const;
     
     // Rendering
-    void draw(const Camera& camera, const Object* selectedObject, const bool inPlaytest) const;
+    void draw(CommandBuffer& buffer, const Object* selectedObject, const bool inPlaytest, unsigned int features = ~0u) const;
+
+private:
+    // Cached world matrix, a clean one always has clean ancestors
+    mutable glm::mat4 worldMatrix = glm::mat4(1.0f);
+    mutable bool worldDirty = true;
+
+    // Internal helpers
+    void invalidateWorld();
 };
 
 void getDescendants(Object* obj, std::vector<Object*>& out);
-std::unique_ptr<Mesh> combineMeshes(const std::string& name, const std::vector<Object*>& objects);
+glm::mat3 computeNormalMatrix(const glm::mat4& model);
+std::unique_ptr<Mesh> combineMeshes(const std::string& name, const std::vector<Object*>& objects, bool bakeTextureScale = false);
@@ -0,0 +1,75 @@
+#pragma once
+
+#include <vector>
+#include <glm/glm.hpp>
+
+#include "object.hpp"
+
+// Per-frame occlusion counters
+struct OcclusionStats {
+    size_t occluders = 0;
+    size_t triangles = 0;
+    size_t tested = 0;
+    size_t occluded = 0;
+};
+
+// Occlusion culler definition
+// Rasterizes a few occluders into a small CPU depth buffer, then tests boxes
+// against a max-depth pyramid built from it. Depth is NDC mapped to [0, 1].
+class OcclusionCuller {
+public:
+    // Tiles are rasterized in parallel, each owning its own pixels
+    static const int TILE_SIZE = 32;
+
+    // Constructor
+    OcclusionCuller(int width = 256, int height = 128);
+
+    // Frame lifecycle
+    void beginFrame(const glm::mat4& viewProjection);
+    void addOccluder(const Mesh& mesh, const glm::mat4& model);
+    void rasterize();
+
+    // Queries
+    bool isVisible(const OBB& obb) const;
+    size_t cullOBBs(const std::vector<const OBB*>& boxes, std::vector<unsigned char>& visible);
+
+    // Getters
+    int getWidth() const {return width;}
+    int getHeight() const {return height;}
+    float getDepth(int x, int y) const {return pyramid[0][y * stride + x];}
+    const OcclusionStats& getStats() const {return stats;}
+
+private:
+    // Screen-space triangle, xy in pixels and z in depth
+    struct Triangle {
+        glm::vec3 v[3];
+    };
+
+    // Occluder queued for this frame
+    struct Occluder {
+        const Mesh* mesh;
+        glm::mat4 clipFromModel;
+    };
+
+    // Buffer layout, padded to whole tiles
+    int width, height;
+    int tilesX, tilesY;
+    int stride;
+
+    // Max-depth pyramid, level 0 is the depth buffer itself
+    std::vector<std::vector<float>> pyramid;
+    std::vector<glm::ivec2> pyramidSizes;
+
+    // Frame data
+    glm::mat4 viewProjection = glm::mat4(1.0f);
+    std::vector<Occluder> occluders;
+    std::vector<std::vector<Triangle>> triangles;
+    std::vector<std::vector<std::vector<unsigned int>>> bins;
+    OcclusionStats stats;
+
+    // Internal helpers
+    void setupOccluder(size_t index);
+    void rasterizeTile(int tile);
+    void rasterizeTriangle(const Triangle& tri, int minX, int minY, int maxX, int maxY);
+    void buildPyramid();
+};
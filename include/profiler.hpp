@@ -0,0 +1,126 @@
+#pragma once
+
+#include <string>
+#include <vector>
+#include <chrono>
+#include <mutex>
+#include <optional>
+#include <unordered_map>
+
+// Timings of one named scope, summed over every time it ran in a frame
+struct ProfileResult {
+    std::string name;
+    int depth = 0;
+    double cpuMs = 0.0;
+    double gpuMs = -1.0; // Negative when the scope has no GPU timing
+    double cpuAverageMs = 0.0;
+    double gpuAverageMs = -1.0;
+};
+
+// Profiler definition
+// CPU scopes read a steady clock, GPU scopes bracket their commands with
+// timestamp queries. Query sets rotate through a ring of frames and are only
+// read back once available, so results lag a few frames but never stall.
+// The game and render threads each record their own timeline; results can be
+// read from either thread.
+class Profiler {
+public:
+    // Frames of queries in flight and length of the rolling history
+    static const int FRAME_COUNT = 4;
+    static const int HISTORY_SIZE = 240;
+
+    // Singleton access, game thread timeline is CPU-only
+    static Profiler& get();
+    static Profiler& getRender();
+
+    // Timeline ProfileScope records into on the calling thread, get() unless bound
+    static Profiler& forThread();
+    void bindToThread();
+
+    // Frame lifecycle
+    void beginFrame();
+    void endFrame();
+
+    // Scope handling, ProfileScope pairs these automatically
+    void beginScope(const char* name, bool gpu);
+    void endScope();
+
+    // Results of the newest fully resolved frame, copied out under the lock
+    std::vector<ProfileResult> getResults() const;
+    std::optional<ProfileResult> getResult(const std::string& name) const;
+    double getFrameCpuMs() const;
+    double getFrameGpuMs() const;
+    size_t getResolvedFrames() const;
+    size_t getDroppedFrames() const;
+    bool hasGpuTimers() const;
+
+    // Rolling frame history, oldest entry at getHistoryOffset()
+    std::vector<float> getCpuHistory() const;
+    std::vector<float> getGpuHistory() const;
+    int getHistoryOffset() const;
+
+    // Shutdown
+    void shutdown();
+
+private:
+    using Clock = std::chrono::steady_clock;
+
+    // Constructor
+    Profiler(bool gpuCapable);
+
+    // One recorded scope, queries index into the owning frame's pool
+    struct Scope {
+        const char* name;
+        int depth;
+        Clock::time_point start;
+        Clock::time_point end;
+        int queryBegin = -1;
+        int queryEnd = -1;
+    };
+
+    // Everything recorded during one frame
+    struct Frame {
+        std::vector<Scope> scopes;
+        std::vector<unsigned int> queries;
+        size_t queryCount = 0;
+        Clock::time_point start;
+        Clock::time_point end;
+        bool pending = false;
+    };
+
+    // Recording state
+    Frame frames[FRAME_COUNT];
+    int current = 0;
+    bool recording = false;
+    bool gpuCapable = false;
+    bool gpuTimers = false;
+    bool initialized = false;
+    std::vector<int> openScopes;
+
+    // Resolved data, written by the owning thread under resultsMutex
+    mutable std::mutex resultsMutex;
+    std::vector<ProfileResult> results;
+    std::unordered_map<std::string, ProfileResult> averages;
+    double frameCpuMs = 0.0;
+    double frameGpuMs = -1.0;
+    size_t resolvedFrames = 0;
+    size_t droppedFrames = 0;
+    std::vector<float> cpuHistory;
+    std::vector<float> gpuHistory;
+    int historyOffset = 0;
+
+    // Internal helpers
+    int timestamp(Frame& frame);
+    bool isAvailable(const Frame& frame) const;
+    void resolve(Frame& frame);
+    void resolveAvailable();
+};
+
+// Times the enclosing block on the CPU, and on the GPU when asked
+class ProfileScope {
+public:
+    ProfileScope(const char* name, bool gpu = false) {Profiler::forThread().beginScope(name, gpu);}
+    ~ProfileScope() {Profiler::forThread().endScope();}
+    ProfileScope(const ProfileScope&) = delete;
+    ProfileScope& operator=(const ProfileScope&) = delete;
+};
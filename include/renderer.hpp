@@ -0,0 +1,152 @@
+#pragma once
+
+#include <vector>
+#include <memory>
+#include <atomic>
+#include <glm/glm.hpp>
+
+#include "arena.hpp"
+#include "dynamicbuffer.hpp"
+#include "camera.hpp"
+#include "mesh.hpp"
+#include "shader.hpp"
+#include "texture.hpp"
+#include "object.hpp"
+#include "lightgrid.hpp"
+#include "commandbuffer.hpp"
+#include "rendergraph.hpp"
+#include "gpuculler.hpp"
+
+// One frame of command buffers and lights, recorded by the game thread.
+// The renderer only reads it, so it can be drawn while the next frame is recorded.
+struct RenderFrame {
+    glm::mat4 view = glm::mat4(1.0f);
+    glm::mat4 projection = glm::mat4(1.0f);
+    glm::vec3 viewPos = glm::vec3(0.0f);
+    float nearPlane = 0.1f;
+    float farPlane = 100.0f;
+    float fogStart = 50.0f; // Distance where fog starts
+    float fogEnd = 100.0f;  // Distance where fog fully saturates
+    bool gpuCulling = false; // Buffers hold every object, culling is left to the GPU
+
+    // One buffer per recording job, replayed in order
+    std::vector<CommandBuffer> buffers;
+    std::vector<GpuLight> lights;
+
+    // Recording, buffers are begun with this frame's view
+    void begin(const Camera& camera, size_t bufferCount = 1);
+    void submitLight(const Light& light, const glm::vec3& position, const glm::vec3& direction);
+};
+
+// Per-frame submission counters
+struct RenderStats {
+    size_t items = 0;
+    size_t batches = 0;
+    size_t commands = 0;
+    size_t drawCalls = 0;
+    size_t depthDrawCalls = 0;
+};
+
+// Renderer definition
+// GL backend for the merged command stream of a frame, drawn by the passes
+// it adds to the frame's render graph.
+class Renderer : private CommandBackend {
+public:
+    // Constructor
+    Renderer();
+
+    // Deconstructor
+    ~Renderer();
+
+    // Frame lifecycle, on the thread that owns the GL context.
+    // beginFrame() uploads the frame and returns false when there is nothing to draw,
+    // the passes added to the graph must run before endFrame().
+    bool beginFrame(const RenderFrame& frame);
+    void addPasses(RenderGraph& graph, const std::string& color, const std::string& depth);
+    void endFrame();
+
+    // Whether the passes added this frame sample the depth attachment, so it cannot be the window's
+    bool needsSampledDepth() const;
+
+    // Depth pre-pass, the main pass then only shades the nearest surface
+    void setDepthPrepass(bool enabled) {depthPrepass = enabled;}
+    bool getDepthPrepass() const {return depthPrepass;}
+
+    // GPU culling, only with compute shaders; frames ask for it through RenderFrame::gpuCulling
+    bool supportsGpuCulling() const {return culler != nullptr;}
+    bool usesGpuCulling() const {return cullingThisFrame;}
+    GpuCuller* getGpuCuller() const {return culler.get();}
+
+    // Getters, stats belong to the drawing thread
+    const RenderStats& getStats() const {return stats;}
+    bool usesMultiDrawIndirect() const {return multiDrawIndirect;}
+    const DynamicBuffer& getFrameData() const {return frameData;}
+    const LightGrid& getLightGrid() const {return lightGrid;}
+
+    // Fragments shaded by the main pass per viewport pixel, a few frames behind
+    double getOverdraw() const {return overdraw;}
+    unsigned long long getShadedFragments() const {return shadedFragments;}
+
+private:
+    // Frames of overdraw queries in flight
+    static const int QUERY_COUNT = 4;
+
+    // Samples-passed query around one frame's main pass
+    struct OverdrawQuery {
+        unsigned int id = 0;
+        size_t pixels = 0;
+        bool pending = false;
+    };
+
+    // Frame data, valid between beginFrame() and endFrame()
+    CommandStream stream;
+    RenderStats stats;
+    const RenderFrame* currentFrame = nullptr;
+    Shader* currentProgram = nullptr;
+    glm::vec2 viewportSize = glm::vec2(0.0f);
+    bool prepassThisFrame = false;
+    bool cullingThisFrame = false;
+
+    // Local lights, binned into clusters every frame
+    LightGrid lightGrid;
+
+    // Per-frame instance and command data
+    DynamicBuffer frameData;
+    size_t instanceOffset = 0;
+    size_t commandOffset = 0;
+    size_t instanceAlignment = sizeof(glm::vec4);
+    bool multiDrawIndirect = false;
+
+    // Instances the draws read, the frame's own or the culler's survivors
+    unsigned int instanceBuffer = 0;
+    size_t instanceBase = 0;
+
+    // Culling on the GPU, null without compute support
+    std::unique_ptr<GpuCuller> culler;
+    glm::mat4 viewProjection = glm::mat4(1.0f);
+
+    // Depth pre-pass, toggled from the game thread
+    std::unique_ptr<Shader> depthShader;
+    std::atomic<bool> depthPrepass{false};
+
+    // Overdraw measurement, read from the game thread
+    OverdrawQuery queries[QUERY_COUNT];
+    int currentQuery = 0;
+    std::atomic<double> overdraw{0.0};
+    std::atomic<unsigned long long> shadedFragments{0};
+
+    // Backend
+    void bindProgram(Shader* shader) override;
+    void bindMaterial(unsigned int material, Texture* texture) override;
+    void draw(size_t firstCommand, size_t commandCount) override;
+
+    // Internal helpers
+    bool upload();
+    void drawCommands(size_t firstCommand, size_t commandCount);
+    void drawDepthPrepass();
+    void drawOpaque();
+    void buildHiZ(const RenderGraph& graph, const std::string& depth);
+    void resolveOverdraw();
+    void bindInstanceAttributes(size_t baseInstance) const;
+    void setFrameUniforms(const Shader& shader, const RenderFrame& frame) const;
+};
@@ -0,0 +1,202 @@
+#pragma once
+
+#include <vector>
+#include <string>
+#include <mutex>
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <unordered_set>
+#include <glm/glm.hpp>
+
+// Texture formats an attachment can have
+enum class AttachmentFormat : uint8_t {
+    RGBA8,
+    RGBA16F,
+    Depth24
+};
+
+// Size and format of an attachment, with what its first writer clears it to
+struct AttachmentDesc {
+    int width = 0;
+    int height = 0;
+    AttachmentFormat format = AttachmentFormat::RGBA8;
+    bool clear = true;
+    glm::vec4 clearColor = glm::vec4(0.0f, 0.0f, 0.0f, 1.0f); // Depth clears to 1
+};
+
+// How a pass uses an attachment it reads
+enum class ReadAccess : uint8_t {
+    Sample,     // Bound as a texture
+    Attachment  // Bound to the pass's framebuffer without writing, e.g. depth testing
+};
+
+// Per-frame graph counters, bytes are estimated from size and format
+struct RenderGraphStats {
+    size_t passes = 0;
+    size_t culledPasses = 0;
+    size_t transients = 0;
+    size_t textures = 0;
+    size_t transitions = 0;
+    size_t requestedBytes = 0;
+    size_t allocatedBytes = 0;
+};
+
+// Render graph definition
+// Rebuilt every frame: attachments are declared by name, then passes say
+// which ones they read and write. compile() culls passes whose output nobody
+// uses, gives every transient attachment the lifetime between its first and
+// last surviving pass, and lets transients with equal size and format and
+// disjoint lifetimes share one pooled texture. Framebuffer binds, viewport,
+// write masks, clears and invalidation are worked out up front and only
+// emitted where they change between passes. Imported attachments live in an
+// existing framebuffer, usually the window's, and keep their writers alive.
+// Passes without attachments, such as compute work, bind no framebuffer.
+class RenderGraph {
+public:
+    // Color attachments one pass can write
+    static const int MAX_COLOR_ATTACHMENTS = 4;
+
+    // Pass callback, textures of sampled attachments come from getTexture()
+    using PassFunction = std::function<void(const RenderGraph&)>;
+
+    // Declares what a pass reads and writes, names must already be declared
+    class PassBuilder {
+    public:
+        PassBuilder& read(const std::string& name, ReadAccess access = ReadAccess::Sample);
+        PassBuilder& write(const std::string& name);
+
+        // Never culled, for passes whose results live outside the graph, e.g. buffers read next frame
+        PassBuilder& keepAlive();
+
+    private:
+        friend class RenderGraph;
+        PassBuilder(RenderGraph& graph, size_t pass) : graph(graph), pass(pass) {}
+        RenderGraph& graph;
+        size_t pass;
+    };
+
+    // Constructor
+    RenderGraph() = default;
+    RenderGraph(const RenderGraph&) = delete;
+    RenderGraph& operator=(const RenderGraph&) = delete;
+
+    // Deconstructor
+    ~RenderGraph();
+
+    // Building, pass names are kept by pointer for the profiler so use literals
+    void reset();
+    void createAttachment(const std::string& name, const AttachmentDesc& desc);
+    void importAttachment(const std::string& name, const AttachmentDesc& desc, unsigned int framebuffer);
+    PassBuilder addPass(const char* name, PassFunction execute);
+
+    // Compiling and running, on the thread that owns the GL context
+    void compile();
+    void execute();
+    void release();
+
+    // Texture of a transient attachment while executing, 0 when it has none
+    unsigned int getTexture(const std::string& name) const;
+
+    // Debug output, readable from any thread. The dump is rebuilt by the next compile() after a request.
+    RenderGraphStats getStats() const;
+    void requestDump() {dumpRequested = true;}
+    std::string getDump() const;
+
+private:
+    // Kinds of state change emitted before a pass
+    enum class TransitionType : uint8_t {
+        BindFramebuffer,
+        Viewport,
+        ColorMask,
+        DepthMask,
+        Clear
+    };
+
+    struct Transition {
+        TransitionType type;
+        unsigned int value;  // Framebuffer, mask or draw buffer
+        int resource;        // Cleared attachment
+    };
+
+    struct Resource {
+        std::string name;
+        AttachmentDesc desc;
+        bool imported = false;
+        unsigned int framebuffer = 0;
+
+        // Compiled
+        int first = -1;
+        int last = -1;
+        int slot = -1;
+    };
+
+    struct Pass {
+        const char* name;
+        PassFunction execute;
+        std::vector<int> reads;
+        std::vector<ReadAccess> readAccess;
+        std::vector<int> writes;
+        bool valid = true;
+        bool keepAlive = false;
+
+        // Compiled
+        bool alive = false;
+        std::vector<int> colorAttachments;
+        int depthAttachment = -1;
+        bool writesDepth = false;
+        unsigned int framebuffer = 0;
+        int width = 0;
+        int height = 0;
+        std::vector<Transition> transitions;
+        std::vector<unsigned int> invalidate;
+    };
+
+    // Texture kept across frames, handed to one aliasing slot per frame
+    struct PooledTexture {
+        AttachmentDesc desc;
+        unsigned int id = 0;
+        bool used = false;
+    };
+
+    // Framebuffer for a set of pooled textures, depth last
+    struct CachedFramebuffer {
+        std::vector<unsigned int> textures;
+        unsigned int id = 0;
+        bool used = false;
+    };
+
+    // Declared graph
+    std::vector<Resource> resources;
+    std::vector<Pass> passes;
+
+    // Compiled order and aliasing slots, each slot maps into the pool
+    std::vector<int> order;
+    std::vector<int> slots;
+    bool compiled = false;
+
+    // GL objects kept across frames, dropped once a compile leaves them unused
+    std::vector<PooledTexture> pool;
+    std::vector<CachedFramebuffer> framebuffers;
+
+    // Debug output
+    mutable std::mutex statsMutex;
+    RenderGraphStats stats;
+    std::string dump;
+    std::atomic<bool> dumpRequested{false};
+    std::unordered_set<std::string> reported;
+
+    // Internal helpers
+    int findResource(const std::string& name) const;
+    void report(const std::string& message);
+    void validate();
+    void cull();
+    void computeLifetimes();
+    void alias();
+    void assignFramebuffers();
+    void buildTransitions();
+    unsigned int getFramebuffer(const Pass& pass);
+    int acquireTexture(const AttachmentDesc& desc);
+    void releaseUnused();
+    std::string buildDump() const;
+};
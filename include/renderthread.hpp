@@ -0,0 +1,118 @@
+#pragma once
+
+#include <thread>
+#include <mutex>
+#include <functional>
+#include <condition_variable>
+#include <glm/glm.hpp>
+
+#include "imgui.h"
+#include "renderer.hpp"
+#include "rendergraph.hpp"
+#include "dynamicresolution.hpp"
+#include "framepacer.hpp"
+
+// Forward declaration
+class Window;
+
+// Copy of one frame's ImGui draw lists, ImGui rebuilds its own on the next NewFrame()
+struct GuiSnapshot {
+    ImDrawData drawData;
+
+    // Constructor
+    GuiSnapshot() = default;
+    GuiSnapshot(const GuiSnapshot&) = delete;
+    GuiSnapshot& operator=(const GuiSnapshot&) = delete;
+
+    // Deconstructor
+    ~GuiSnapshot();
+
+    // Capture, clones go through ImGui's allocator so only the game thread may call these
+    void capture(const ImDrawData* source);
+    void clear();
+};
+
+// Everything the render thread needs for one frame
+struct FrameSnapshot {
+    RenderFrame scene;
+    GuiSnapshot gui;
+    int width = 0;
+    int height = 0;
+    glm::vec4 clearColor = glm::vec4(0.5f, 0.7f, 1.0f, 1.0f);
+    double inputTime = 0.0;  // FramePacer::now() when this frame's input was sampled
+};
+
+// Render thread definition
+// Owns the GL context while running. The game thread fills a snapshot, hands
+// it over with submit() and simulates the next frame while this thread draws.
+// Snapshots alternate between two slots and beginFrame() waits for the last
+// one to be picked up, so the game thread is never more than a frame ahead.
+// GL resource work from the game thread goes through run(). Every frame is
+// drawn through a render graph: the renderer's passes at the dynamic
+// resolution's scale, then the GUI at the window's size.
+class RenderThread {
+public:
+    // Snapshot slots
+    static const int SNAPSHOT_COUNT = 2;
+
+    // Singleton access
+    static RenderThread& get();
+
+    // Thread lifecycle, the context moves over on start() and back on stop()
+    void start(Window& window, Renderer& renderer);
+    void stop();
+    bool isRunning() const {return running;}
+
+    // Graph of the last drawn frame, its stats and dump are safe to read here
+    RenderGraph& getGraph() {return graph;}
+
+    // Scene resolution control, its settings are safe to change here
+    DynamicResolution& getResolution() {return resolution;}
+
+    // Frame pacing, the game thread waits on it before sampling input
+    FramePacer& getPacer() {return pacer;}
+
+    // Frame handoff from the game thread while running
+    FrameSnapshot& beginFrame();
+    void submit();
+
+    // Runs the task with the context current and waits for it.
+    // Snapshots already handed over are drawn first, so freeing what they use is safe.
+    void run(const std::function<void()>& task);
+
+private:
+    // Constructor
+    RenderThread() = default;
+
+    // Deconstructor
+    ~RenderThread();
+
+    // Thread state
+    Window* window = nullptr;
+    Renderer* renderer = nullptr;
+    std::thread thread;
+    std::mutex mutex;
+    std::condition_variable wake;
+    std::condition_variable done;
+    bool running = false;
+    bool stopping = false;
+
+    // Snapshot slots, -1 when none
+    FrameSnapshot snapshots[SNAPSHOT_COUNT];
+    int recording = 0;
+    int pending = -1;
+    int drawing = -1;
+
+    // Rebuilt by the render thread every frame
+    RenderGraph graph;
+    DynamicResolution resolution;
+    FramePacer pacer;
+    int swapInterval = -1;
+
+    // Resource task waiting for the render thread
+    const std::function<void()>* task = nullptr;
+
+    // Internal helpers
+    void threadLoop();
+    void draw(FrameSnapshot& snapshot);
+};
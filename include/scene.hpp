@@ -1,6 +1,7 @@
 #pragma once
 
 #include <unordered_map>
+#include <unordered_set>
 #include <string>
 #include <vector>
 #include <memory>
@@ -9,6 +10,11 @@
 #include "camera.hpp"
 #include "shader.hpp"
 #include "texture.hpp"
+#include "material.hpp"
+#include "renderer.hpp"
+#include "frustum.hpp"
+#include "bvh.hpp"
+#include "occlusion.hpp"
 
 // Scene definition
 class Scene {
@@ -21,6 +27,7 @@ public:
     Mesh* getMesh(const std::string& name) const;
     std::vector<Mesh*> getMeshes() const;
     bool addMesh(std::unique_ptr<Mesh> mesh);
+    bool removeMesh(const std::string& name);
 
     // Shader access
     Shader* getShader(const std::string& name);
@@ -30,6 +37,13 @@ public:
     Texture* getTexture(const std::string& name);
     std::vector<Texture*> getTextures() const;
 
+    // Material access, the library's materials by name, sorted
+    std::shared_ptr<Material> getMaterial(const std::string& name) const;
+    std::shared_ptr<Material> findMaterial(const std::string& shaderName, const std::string& textureName); // Added when missing
+    std::vector<std::shared_ptr<Material>> getMaterials() const;
+    std::shared_ptr<Material> duplicateMaterial(const Material& original);
+    bool saveMaterial(const Material& material) const;
+
     // Scene handling
     bool loadScene(const std::string& name);
     bool saveScene(const std::string& name);
@@ -38,9 +52,11 @@ public:
     void setName(const std::string& newName);
 
     // Object handling
+    std::unique_ptr<Object> createObject(const std::string& name, const std::string& meshName, const std::string& textureName, const std::string& shaderName);
+    std::unique_ptr<Object> createObject(const std::string& name, const std::string& meshName, const std::string& materialName);
     void addObject(const std::string& name, std::unique_ptr<Object> obj);
     Object* getObject(const std::string& name);
-    std::vector<Object*> getObjects();
+    const std::vector<Object*>& getObjects() const {return objectList;}
     std::vector<std::string> getObjectNames() const;
     size_t getObjectCount() const;
     void deleteObject(const std::string& name);
@@ -48,27 +64,101 @@ public:
     std::string renameObject(const std::string& oldName, const std::string& newName);
     void clear();
 
+    // Hierarchy, revised whenever objects are added, removed, renamed or reparented, the removal revision only on removal
+    void setParent(Object* object, Object* parent);
+    size_t getHierarchyRevision() const {return hierarchyRevision;}
+    size_t getRemovalRevision() const {return removalRevision;}
+
+    // Static batching
+    size_t buildStaticBatches();
+    void clearStaticBatches();
+    size_t getStaticBatchCount() const {return staticBatches.size();}
+
     // Selection handling
     void selectObject(const std::string& name);
     Object* getSelectedObject() const;
     void clearSelection();
 
+    // Spatial queries
+    void updateBounds();
+    Object* raycast(const glm::vec3& origin, const glm::vec3& dir, const std::function<bool(const Object&, float&)>& hitTest, float& t);
+    Object* pick(const glm::vec3& origin, const glm::vec3& dir, MeshHit& hit);
+    std::vector<Object*> queryAABB(const AABB& box);
+    std::vector<Object*> querySphere(const glm::vec3& center, float radius);
+    const BVH& getBVH() const {return bvh;}
+
     // Rendering
-    void draw(const Camera& camera, bool inPlaytest);
+    void draw(RenderFrame& frame, const Camera& camera, bool inPlaytest);
+    const CullStats& getCullStats() const {return cullStats;}
+    void setOcclusionCulling(bool enabled) {occlusionCulling = enabled;}
+    bool getOcclusionCulling() const {return occlusionCulling;}
+    const OcclusionCuller& getOcclusionCuller() const {return occlusion;}
+    void setGpuCulling(bool enabled) {gpuCulling = enabled;}
+    bool getGpuCulling() const {return gpuCulling;}
 
 private:
     // Resource containers
     std::unordered_map<std::string, std::unique_ptr<Mesh>> meshes;
     std::unordered_map<std::string, std::unique_ptr<Shader>> shaders;
     std::unordered_map<std::string, std::unique_ptr<Texture>> textures;
+    std::unordered_map<std::string, std::shared_ptr<Material>> materials;
     std::unordered_map<std::string, std::unique_ptr<Object>> objects;
 
+    // Objects in the order they were added
+    std::vector<Object*> objectList;
+    size_t hierarchyRevision = 0;
+    size_t removalRevision = 0;
+
     Object* selectedObject = nullptr;
 
+    // Merged copies of static objects, drawn in place of their sources
+    std::vector<std::unique_ptr<Mesh>> staticMeshes;
+    std::vector<std::unique_ptr<Object>> staticBatches;
+    std::unordered_set<const Object*> batchedObjects;
+
+    // Spatial hierarchy over object world bounds
+    BVH bvh;
+    std::vector<Object*> bvhObjects;
+    std::unordered_map<const Object*, int> bvhItems;
+    std::vector<Object*> movedObjects;
+    bool bvhDirty = true;
+
+    // Culling data
+    std::vector<int> visibleItems;
+    std::vector<int> partialItems;
+    OBBArray cullBoxes;
+    std::vector<unsigned char> visibility;
+    CullStats cullStats;
+
+    // Items a local light reaches, for picking shader variants
+    std::vector<unsigned char> litItems;
+    std::vector<int> lightItems;
+
+    // Occlusion culling data
+    OcclusionCuller occlusion;
+    bool occlusionCulling = true;
+    std::vector<int> occluderItems;
+    std::unordered_map<const Mesh*, const Mesh*> occluderProxies; // Mesh to its "<mesh>_occluder" stand-in, copies keep the source's
+    std::vector<int> occludeeItems;
+    std::vector<const OBB*> occludeeBoxes;
+
+    // Every object is submitted and the renderer culls on the GPU
+    bool gpuCulling = false;
+
     std::string name;
 
+    // Internal helpers
+    void rebuildBVH();
+    void cullVisible(const Camera& camera, bool inPlaytest);
+    void cullOccluded(const Camera& camera, const glm::mat4& viewProjection, bool inPlaytest);
+    std::vector<Object*> toObjects(const std::vector<int>& items) const;
+    void findLitItems();
+    unsigned int getShaderFeatures(int item, const glm::vec3& viewPos, float fogStart) const;
+    void linkOccluderProxies();
+
     // Internal loaders
     void loadAllMeshes();
     void loadAllShaders();
     void loadAllTextures();
+    void loadAllMaterials();
 };
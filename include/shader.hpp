@@ -3,12 +3,33 @@
 #include <glm/glm.hpp>
 #include <glm/gtc/type_ptr.hpp>
 #include <string>
+#include <vector>
+#include <memory>
+#include <atomic>
+
+// Compile-time shader features, a source lists the ones it supports with
+// "#pragma feature NAME" and guards their code with #ifdef NAME
+enum ShaderFeature : unsigned int {
+    FEATURE_HIGHLIGHT    = 1 << 0, // Selection tint
+    FEATURE_FOG          = 1 << 1, // Distance fog
+    FEATURE_SPECULAR     = 1 << 2, // Blinn-Phong highlights of the sun
+    FEATURE_LOCAL_LIGHTS = 1 << 3  // Clustered point and spot lights
+};
+static const int SHADER_FEATURE_COUNT = 4;
 
 // Shader definition
+// A program built from files is the variant with every feature its sources
+// declare. Variants with fewer features are compiled with the matching
+// #defines when first asked for and cached by feature mask. Their links are
+// started and polled once a frame on the thread owning the context, in the
+// background when the driver has KHR_parallel_shader_compile. Until a
+// variant's link completes the full program stands in for it, so neither
+// asking nor compiling ever stalls a frame.
 class Shader {
 public:
     // Constructor
     Shader(const std::string& vertexSrc, const std::string& fragmentSrc, const std::string& name);
+    Shader(const std::string& computeSrc, const std::string& name); // Compute program, needs GL 4.3
 
     // Deconstructor
     ~Shader();
@@ -16,6 +37,20 @@ public:
     // Usage
     void use() const;
 
+    // Variants, getVariant() is safe from any thread.
+    // Missing ones are linked by updateVariants(), called once a frame with the context current.
+    Shader* getVariant(unsigned int features);
+    bool isFeatureEnabled(unsigned int feature) const {return !(declared & feature) || (enabled & feature);}
+    unsigned int getDeclaredFeatures() const {return declared;}
+    unsigned int getEnabledFeatures() const {return enabled;}
+    size_t getVariantCount() const;
+    static void updateVariants();
+    static size_t getCompilingCount(); // Variant links in flight, context thread only
+
+    // Parallel compilation, set up once after the GL functions are loaded
+    static void initParallelCompile(void* (*getProcAddress)(const char* name));
+    static bool hasParallelCompile();
+
     // Getters
     unsigned int getID() const;
     std::string getName() const;
@@ -27,17 +62,51 @@ public:
     void setMat4(const std::string& name, const glm::mat4& mat) const;
     void setVec3(const std::string& name, const glm::vec3& value) const;
     void setVec2(const std::string& name, const glm::vec2& value) const;
+    void setVec4(const std::string& name, const glm::vec4& value) const;
+    void setIVec2(const std::string& name, const glm::ivec2& value) const;
     void setFloat(const std::string& name, float value) const;
     void setInt(const std::string& name, int value) const;
     void setBool(const std::string &name, bool value) const;
+    void setUniformBlock(const std::string& name, unsigned int binding) const; // Blocks the program lacks are skipped
 
 private:
     // Shader data
-    unsigned int ID;
+    unsigned int ID = 0;
     std::string name;
 
+    // Features of the sources and of this program
+    unsigned int declared = 0;
+    unsigned int enabled = 0;
+
+    // Variants, built from the kept sources and looked up by feature mask
+    Shader* base = this;
+    std::string vertexSource;
+    std::string fragmentSource;
+    std::atomic<Shader*> variants[1 << SHADER_FEATURE_COUNT] = {};
+    std::vector<std::unique_ptr<Shader>> ownedVariants;
+    std::vector<std::unique_ptr<Shader>> compilingVariants; // Linking, context thread only
+    std::atomic<unsigned int> requested{0}; // Bit per missing variant's mask
+
+    // Stages of a link still in flight
+    unsigned int vertexStage = 0;
+    unsigned int fragmentStage = 0;
+
+    // Variant constructor
+    Shader(Shader& base, unsigned int features);
+
     // Internal compilation
+    void link(const std::string& vertexSrc, const std::string& fragmentSrc);
+    void beginLink(const std::string& vertexSrc, const std::string& fragmentSrc);
+    bool isLinkComplete() const;
+    bool finishLink();
+    void linkCompute(const std::string& computeSrc);
+    bool checkLink();
     unsigned int compile(unsigned int type, const char* src);
+    bool checkCompile(unsigned int shader);
+    int startVariants(int budget);
+    bool promoteVariants();
+    static unsigned int parseFeatures(const std::string& source);
+    static std::string addDefines(const std::string& source, unsigned int features);
 };
 
 // Loader
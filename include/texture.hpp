@@ -1,8 +1,14 @@
 #pragma once
 
 #include <string>
+#include <vector>
+#include <cstddef>
 
 // Texture definition
+// Decoded once into a full mip chain kept in memory, only the smallest mips
+// start resident on the GPU. The texture streamer raises or lowers the finest
+// resident mip from how large the texture is on screen, the GL texture's
+// level 0 is always the finest resident mip.
 class Texture {
 public:
     // Constructor
@@ -14,11 +20,34 @@ public:
     // Getters
     unsigned int getID() const { return id; }
     const std::string& getName() const { return name; }
+    int getWidth() const {return mips.empty() ? 0 : mips[0].width;}
+    int getHeight() const {return mips.empty() ? 0 : mips[0].height;}
+    int getMipCount() const {return static_cast<int>(mips.size());}
+    int getResidentMip() const {return residentMip;}
+
+    // Streaming, on the thread that owns the GL context.
+    // Bytes are GPU bytes of the chain from a mip down, upload bytes are the decoded source.
+    void makeResident(int mip);
+    size_t getResidentBytes(int mip) const;
+    size_t getUploadBytes(int mip) const;
 
     // Usage
     void bind(unsigned int slot = 0) const;
 private:
+    // One decoded level
+    struct MipLevel {
+        int width = 0;
+        int height = 0;
+        std::vector<unsigned char> data;
+    };
+
     // Texture data
     unsigned int id = 0;
     std::string name;
+    int channels = 0;
+    std::vector<MipLevel> mips;
+    int residentMip = -1; // None until the streamer adds the texture
+
+    // Internal helpers
+    void buildMips(const unsigned char* pixels, int width, int height);
 };
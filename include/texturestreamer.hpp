@@ -0,0 +1,83 @@
+#pragma once
+
+#include <mutex>
+#include <atomic>
+#include <cstddef>
+#include <unordered_map>
+
+#include "texture.hpp"
+
+// Counters of the last streaming update
+struct TextureStreamStats {
+    size_t textures = 0;
+    size_t residentBytes = 0;
+    size_t fullBytes = 0;      // Resident bytes with every mip of every texture
+    size_t uploadedBytes = 0;
+    size_t uploads = 0;
+    size_t drops = 0;
+    size_t pending = 0;        // Textures still coarser than wanted
+};
+
+// Texture streamer definition
+// Keeps every texture's finest resident mip close to what the screen needs.
+// Drawn textures report the largest screen height one repeat of them covers,
+// which gives the mip whose texels roughly match pixels. Textures coarser
+// than wanted are raised, largest shortfall first, while the frame's upload
+// budget lasts; one step is always allowed so big textures still progress.
+// Textures finer than wanted keep their mips until resident memory goes over
+// its budget, then the least recently drawn give them back first. Textures
+// not drawn for a while fall back to their starting mips.
+class TextureStreamer {
+public:
+    // Textures start with mips no larger than this resident
+    static const int START_SIZE = 64;
+
+    // Singleton access
+    static TextureStreamer& get();
+
+    // Registry, on the thread that owns the GL context
+    void add(Texture* texture);
+    void remove(Texture* texture);
+
+    // Frame, on the drawing thread: requests first, screen size is the NDC height of one repeat (2 is full height)
+    void request(Texture* texture, float screenSize);
+    void update(int viewportHeight);
+
+    // Budgets, set from any thread
+    void setUploadBudget(size_t bytes) {uploadBudget = bytes;}
+    size_t getUploadBudget() const {return uploadBudget;}
+    void setMemoryBudget(size_t bytes) {memoryBudget = bytes;}
+    size_t getMemoryBudget() const {return memoryBudget;}
+
+    // Stats of the last update, safe from any thread
+    TextureStreamStats getStats() const;
+
+private:
+    // Streaming state of one texture
+    struct Entry {
+        float screenSize = 0.0f;
+        int wantedMip = 0;
+        size_t lastUsed = 0;
+    };
+
+    // Constructor
+    TextureStreamer() = default;
+
+    // Registered textures
+    std::unordered_map<Texture*, Entry> entries;
+    size_t frame = 0;
+    size_t residentBytes = 0;
+
+    // Budgets
+    std::atomic<size_t> uploadBudget{4 * 1024 * 1024};
+    std::atomic<size_t> memoryBudget{256 * 1024 * 1024};
+
+    // Stats
+    mutable std::mutex statsMutex;
+    TextureStreamStats stats;
+
+    // Internal helpers
+    static int getStartMip(const Texture& texture);
+    void setResident(Texture* texture, int mip);
+    void freeMemory(size_t target, TextureStreamStats& frameStats);
+};
@@ -0,0 +1,288 @@
+#include <glad/glad.h>
+#include <algorithm>
+
+#include "arena.hpp"
+#include "glstate.hpp"
+
+// === Constants ===
+static const size_t INITIAL_VERTEX_CAPACITY = 1 << 16;
+static const size_t INITIAL_INDEX_CAPACITY = 3 << 16;
+static const float DEFRAGMENT_THRESHOLD = 0.25f;
+static const size_t DEFRAGMENT_MIN_WASTE = 1 << 14;
+
+// ### Pool functions ###
+// === Allocation handling ===
+bool GeometryArena::Pool::allocate(size_t count, ArenaRange& out) {
+    out.count = count;
+    if (count == 0) {
+        out.offset = 0;
+        return true;
+    }
+
+    // First fit from the free list
+    for (auto it = freeList.begin(); it != freeList.end(); ++it) {
+        if (it->count >= count) {
+            out.offset = it->offset;
+            it->offset += count;
+            it->count -= count;
+            if (it->count == 0) {
+                freeList.erase(it);
+            }
+            return true;
+        }
+    }
+
+    // Bump from the top of the buffer
+    if (top + count <= capacity) {
+        out.offset = top;
+        top += count;
+        return true;
+    }
+
+    return false;
+}
+
+void GeometryArena::Pool::release(const ArenaRange& range) {
+    if (range.count == 0) return;
+
+    // Insert sorted by offset
+    auto it = std::lower_bound(freeList.begin(), freeList.end(), range,
+        [](const ArenaRange& a, const ArenaRange& b) {return a.offset < b.offset;});
+    it = freeList.insert(it, range);
+
+    // Coalesce with the following block
+    auto next = it + 1;
+    if (next != freeList.end() && it->offset + it->count == next->offset) {
+        it->count += next->count;
+        freeList.erase(next);
+    }
+
+    // Coalesce with the preceding block
+    if (it != freeList.begin()) {
+        auto prev = it - 1;
+        if (prev->offset + prev->count == it->offset) {
+            prev->count += it->count;
+            it = freeList.erase(it) - 1;
+        }
+    }
+
+    // Give a trailing block back to the top
+    if (it->offset + it->count == top) {
+        top = it->offset;
+        freeList.erase(it);
+    }
+}
+
+void GeometryArena::Pool::grow(size_t minCapacity) {
+    size_t newCapacity = std::max(capacity * 2, minCapacity);
+
+    unsigned int newBuffer;
+    glGenBuffers(1, &newBuffer);
+    GLState::get().bindBuffer(GL_COPY_WRITE_BUFFER, newBuffer);
+    glBufferData(GL_COPY_WRITE_BUFFER, newCapacity * elementSize, nullptr, GL_STATIC_DRAW);
+
+    // Carry over existing contents
+    if (buffer) {
+        if (top > 0) {
+            GLState::get().bindBuffer(GL_COPY_READ_BUFFER, buffer);
+            glCopyBufferSubData(GL_COPY_READ_BUFFER, GL_COPY_WRITE_BUFFER, 0, 0, top * elementSize);
+        }
+        GLState::get().deleteBuffer(buffer);
+    }
+
+    buffer = newBuffer;
+    capacity = newCapacity;
+}
+
+size_t GeometryArena::Pool::freeInHoles() const {
+    size_t total = 0;
+    for (const ArenaRange& range : freeList) {
+        total += range.count;
+    }
+    return total;
+}
+
+// ### GeometryArena functions ###
+// === Singleton access ===
+GeometryArena& GeometryArena::get() {
+    static GeometryArena arena;
+    return arena;
+}
+
+// === Allocation handling ===
+int GeometryArena::allocate(const std::vector<Vertex>& vertices, const std::vector<unsigned int>& indices) {
+    if (!VAO) init();
+
+    Allocation alloc;
+    alloc.live = true;
+    bool grew = false;
+
+    if (!vertexPool.allocate(vertices.size(), alloc.vertices)) {
+        vertexPool.grow(std::max(vertexPool.top + vertices.size(), INITIAL_VERTEX_CAPACITY));
+        vertexPool.allocate(vertices.size(), alloc.vertices);
+        grew = true;
+    }
+    if (!indexPool.allocate(indices.size(), alloc.indices)) {
+        indexPool.grow(std::max(indexPool.top + indices.size(), INITIAL_INDEX_CAPACITY));
+        indexPool.allocate(indices.size(), alloc.indices);
+        grew = true;
+    }
+
+    // Upload into the reserved ranges
+    if (!vertices.empty()) {
+        GLState::get().bindBuffer(GL_COPY_WRITE_BUFFER, vertexPool.buffer);
+        glBufferSubData(GL_COPY_WRITE_BUFFER, alloc.vertices.offset * sizeof(Vertex), vertices.size() * sizeof(Vertex), vertices.data());
+    }
+    if (!indices.empty()) {
+        GLState::get().bindBuffer(GL_COPY_WRITE_BUFFER, indexPool.buffer);
+        glBufferSubData(GL_COPY_WRITE_BUFFER, alloc.indices.offset * sizeof(unsigned int), indices.size() * sizeof(unsigned int), indices.data());
+    }
+
+    if (grew) {
+        setupVertexAttributes();
+    }
+
+    // Reuse a dead slot if one exists
+    if (!freeHandles.empty()) {
+        int handle = freeHandles.back();
+        freeHandles.pop_back();
+        allocations[handle] = alloc;
+        return handle;
+    }
+
+    allocations.push_back(alloc);
+    return static_cast<int>(allocations.size() - 1);
+}
+
+void GeometryArena::release(int handle) {
+    if (!VAO || handle < 0 || handle >= static_cast<int>(allocations.size())) return;
+
+    Allocation& alloc = allocations[handle];
+    if (!alloc.live) return;
+
+    vertexPool.release(alloc.vertices);
+    indexPool.release(alloc.indices);
+    alloc.live = false;
+    freeHandles.push_back(handle);
+
+    // Close the holes once enough space is wasted
+    size_t waste = std::max(vertexPool.freeInHoles(), indexPool.freeInHoles());
+    if (waste >= DEFRAGMENT_MIN_WASTE && getFragmentation() > DEFRAGMENT_THRESHOLD) {
+        defragment();
+    }
+}
+
+void GeometryArena::defragment() {
+    if (!VAO) return;
+
+    compact(vertexPool, true);
+    compact(indexPool, false);
+    setupVertexAttributes();
+}
+
+// === Getters ===
+DrawElementsIndirectCommand GeometryArena::getCommand(int handle) const {
+    const Allocation& alloc = allocations[handle];
+
+    DrawElementsIndirectCommand cmd;
+    cmd.count = static_cast<unsigned int>(alloc.indices.count);
+    cmd.instanceCount = 1;
+    cmd.firstIndex = static_cast<unsigned int>(alloc.indices.offset);
+    cmd.baseVertex = static_cast<int>(alloc.vertices.offset);
+    cmd.baseInstance = 0;
+    return cmd;
+}
+
+float GeometryArena::getFragmentation() const {
+    float vertexWaste = vertexPool.top ? static_cast<float>(vertexPool.freeInHoles()) / vertexPool.top : 0.0f;
+    float indexWaste = indexPool.top ? static_cast<float>(indexPool.freeInHoles()) / indexPool.top : 0.0f;
+    return std::max(vertexWaste, indexWaste);
+}
+
+// === Usage ===
+void GeometryArena::bind() const {
+    GLState::get().bindVertexArray(VAO);
+}
+
+// === Shutdown ===
+void GeometryArena::shutdown() {
+    if (!VAO) return;
+
+    GLState::get().deleteBuffer(vertexPool.buffer);
+    GLState::get().deleteBuffer(indexPool.buffer);
+    GLState::get().deleteVertexArray(VAO);
+
+    VAO = 0;
+    vertexPool = Pool();
+    indexPool = Pool();
+    allocations.clear();
+    freeHandles.clear();
+}
+
+// === Internal setup ===
+void GeometryArena::init() {
+    glGenVertexArrays(1, &VAO);
+    vertexPool.elementSize = sizeof(Vertex);
+    indexPool.elementSize = sizeof(unsigned int);
+}
+
+void GeometryArena::setupVertexAttributes() const {
+    GLState::get().bindVertexArray(VAO);
+
+    // Vertex buffer
+    GLState::get().bindBuffer(GL_ARRAY_BUFFER, vertexPool.buffer);
+
+    // Position attribute
+    glEnableVertexAttribArray(0);
+    glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, sizeof(Vertex), (void*)offsetof(Vertex, position));
+
+    // Color attribute
+    glEnableVertexAttribArray(1);
+    glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, sizeof(Vertex), (void*)offsetof(Vertex, color));
+
+    // Normal attribute
+    glEnableVertexAttribArray(2);
+    glVertexAttribPointer(2, 3, GL_FLOAT, GL_FALSE, sizeof(Vertex), (void*)offsetof(Vertex, normal));
+
+    // Texture attribute
+    glEnableVertexAttribArray(3);
+    glVertexAttribPointer(3, 2, GL_FLOAT, GL_FALSE, sizeof(Vertex), (void*)offsetof(Vertex, texCoords));
+
+    // Element buffer
+    GLState::get().bindBuffer(GL_ELEMENT_ARRAY_BUFFER, indexPool.buffer);
+
+    GLState::get().bindVertexArray(0);
+}
+
+void GeometryArena::compact(Pool& pool, bool vertices) {
+    if (!pool.buffer || pool.freeList.empty()) return;
+
+    // Live ranges in buffer order
+    std::vector<ArenaRange*> live;
+    for (Allocation& alloc : allocations) {
+        if (!alloc.live) continue;
+        ArenaRange& range = vertices ? alloc.vertices : alloc.indices;
+        if (range.count > 0) live.push_back(&range);
+    }
+    std::sort(live.begin(), live.end(), [](const ArenaRange* a, const ArenaRange* b) {return a->offset < b->offset;});
+
+    unsigned int packed;
+    glGenBuffers(1, &packed);
+    GLState::get().bindBuffer(GL_COPY_WRITE_BUFFER, packed);
+    glBufferData(GL_COPY_WRITE_BUFFER, pool.capacity * pool.elementSize, nullptr, GL_STATIC_DRAW);
+    GLState::get().bindBuffer(GL_COPY_READ_BUFFER, pool.buffer);
+
+    // Slide every live range down to close the holes
+    size_t cursor = 0;
+    for (ArenaRange* range : live) {
+        glCopyBufferSubData(GL_COPY_READ_BUFFER, GL_COPY_WRITE_BUFFER,
+            range->offset * pool.elementSize, cursor * pool.elementSize, range->count * pool.elementSize);
+        range->offset = cursor;
+        cursor += range->count;
+    }
+
+    GLState::get().deleteBuffer(pool.buffer);
+    pool.buffer = packed;
+    pool.top = cursor;
+    pool.freeList.clear();
+}
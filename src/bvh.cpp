@@ -0,0 +1,388 @@
+#include <algorithm>
+#include <cmath>
+
+#include "bvh.hpp"
+
+// === Constants ===
+static const int BIN_COUNT = 12;
+static const int LEAF_SIZE = 2;
+static const int MAX_LEAF_SIZE = 8;
+static const float TRAVERSAL_COST = 1.0f;
+static const float REBUILD_RATIO = 1.5f;
+
+// ### AABB functions ###
+// === Constructors ===
+AABB AABB::fromOBB(const OBB& obb) {
+    // Project the oriented extents onto the world axes
+    glm::vec3 halfSize = glm::abs(obb.axes[0]) * obb.extents.x
+                       + glm::abs(obb.axes[1]) * obb.extents.y
+                       + glm::abs(obb.axes[2]) * obb.extents.z;
+    return AABB(obb.center - halfSize, obb.center + halfSize);
+}
+
+// === Helpers ===
+void AABB::expand(const AABB& other) {
+    min = glm::min(min, other.min);
+    max = glm::max(max, other.max);
+}
+
+void AABB::expand(const glm::vec3& point) {
+    min = glm::min(min, point);
+    max = glm::max(max, point);
+}
+
+float AABB::getSurfaceArea() const {
+    glm::vec3 size = glm::max(max - min, glm::vec3(0.0f));
+    return 2.0f * (size.x * size.y + size.y * size.z + size.z * size.x);
+}
+
+bool AABB::overlaps(const AABB& other) const {
+    return min.x <= other.max.x && max.x >= other.min.x
+        && min.y <= other.max.y && max.y >= other.min.y
+        && min.z <= other.max.z && max.z >= other.min.z;
+}
+
+// ### BVH functions ###
+// === Building ===
+void BVH::build(const std::vector<AABB>& itemBounds) {
+    clear();
+    bounds = itemBounds;
+    if (bounds.empty()) return;
+
+    items.resize(bounds.size());
+    itemLeaf.resize(bounds.size());
+    for (size_t i = 0; i < items.size(); i++) {
+        items[i] = static_cast<int>(i);
+    }
+
+    nodes.reserve(bounds.size() * 2);
+    buildRecursive(0, static_cast<int>(items.size()), -1);
+    builtCost = getCost();
+}
+
+void BVH::update(int item, const AABB& itemBounds) {
+    if (bounds[item] == itemBounds) return;
+    bounds[item] = itemBounds;
+    updatesSinceCheck++;
+
+    // Refit the leaf, then walk up until a node's bounds stop changing
+    int index = itemLeaf[item];
+    while (index != -1) {
+        Node& node = nodes[index];
+        AABB refit;
+        if (node.isLeaf()) {
+            for (int i = node.first; i < node.first + node.count; i++) {
+                refit.expand(bounds[items[i]]);
+            }
+        } else {
+            refit = nodes[node.left].bounds;
+            refit.expand(nodes[node.right].bounds);
+        }
+
+        if (refit == node.bounds) break;
+        node.bounds = refit;
+        index = node.parent;
+    }
+}
+
+bool BVH::needsRebuild() {
+    // Only pay for a cost evaluation each time a share of the items has moved
+    if (updatesSinceCheck < std::max<size_t>(64, bounds.size() / 64)) return false;
+    updatesSinceCheck = 0;
+    return getCost() > builtCost * REBUILD_RATIO;
+}
+
+void BVH::clear() {
+    nodes.clear();
+    items.clear();
+    bounds.clear();
+    itemLeaf.clear();
+    builtCost = 0.0f;
+    updatesSinceCheck = 0;
+}
+
+// === Queries ===
+void BVH::queryFrustum(const Frustum& frustum, std::vector<int>& inside, std::vector<int>& partial) const {
+    if (nodes.empty()) return;
+
+    // Stack of (node, planes still straddled) pairs
+    std::vector<std::pair<int, int>> stack;
+    stack.push_back({0, 0x3F});
+
+    while (!stack.empty()) {
+        auto [index, mask] = stack.back();
+        stack.pop_back();
+        const Node& node = nodes[index];
+
+        int childMask = 0;
+        bool outside = false;
+        for (int p = 0; p < 6; p++) {
+            if (!(mask & (1 << p))) continue;
+            const glm::vec4& plane = frustum.planes[p];
+
+            // Positive and negative vertices along the plane normal
+            glm::vec3 positive(plane.x >= 0 ? node.bounds.max.x : node.bounds.min.x,
+                               plane.y >= 0 ? node.bounds.max.y : node.bounds.min.y,
+                               plane.z >= 0 ? node.bounds.max.z : node.bounds.min.z);
+            glm::vec3 negative(plane.x >= 0 ? node.bounds.min.x : node.bounds.max.x,
+                               plane.y >= 0 ? node.bounds.min.y : node.bounds.max.y,
+                               plane.z >= 0 ? node.bounds.min.z : node.bounds.max.z);
+
+            if (glm::dot(glm::vec3(plane), positive) + plane.w < 0.0f) {
+                outside = true;
+                break;
+            }
+            if (glm::dot(glm::vec3(plane), negative) + plane.w < 0.0f) {
+                childMask |= 1 << p;
+            }
+        }
+        if (outside) continue;
+
+        // Fully inside, every item below is visible
+        if (childMask == 0) {
+            collectLeaves(index, inside);
+            continue;
+        }
+
+        if (node.isLeaf()) {
+            for (int i = node.first; i < node.first + node.count; i++) {
+                partial.push_back(items[i]);
+            }
+        } else {
+            stack.push_back({node.left, childMask});
+            stack.push_back({node.right, childMask});
+        }
+    }
+}
+
+void BVH::queryAABB(const AABB& box, std::vector<int>& out) const {
+    if (nodes.empty()) return;
+
+    std::vector<int> stack = {0};
+    while (!stack.empty()) {
+        const Node& node = nodes[stack.back()];
+        stack.pop_back();
+        if (!node.bounds.overlaps(box)) continue;
+
+        if (node.isLeaf()) {
+            for (int i = node.first; i < node.first + node.count; i++) {
+                if (bounds[items[i]].overlaps(box)) out.push_back(items[i]);
+            }
+        } else {
+            stack.push_back(node.left);
+            stack.push_back(node.right);
+        }
+    }
+}
+
+void BVH::querySphere(const glm::vec3& center, float radius, std::vector<int>& out) const {
+    if (nodes.empty()) return;
+
+    auto touches = [&](const AABB& box) {
+        glm::vec3 closest = glm::clamp(center, box.min, box.max);
+        glm::vec3 delta = closest - center;
+        return glm::dot(delta, delta) <= radius * radius;
+    };
+
+    std::vector<int> stack = {0};
+    while (!stack.empty()) {
+        const Node& node = nodes[stack.back()];
+        stack.pop_back();
+        if (!touches(node.bounds)) continue;
+
+        if (node.isLeaf()) {
+            for (int i = node.first; i < node.first + node.count; i++) {
+                if (touches(bounds[items[i]])) out.push_back(items[i]);
+            }
+        } else {
+            stack.push_back(node.left);
+            stack.push_back(node.right);
+        }
+    }
+}
+
+int BVH::queryRay(const glm::vec3& origin, const glm::vec3& dir, const std::function<bool(int, float&)>& hitTest, float& tOut) const {
+    if (nodes.empty()) return -1;
+
+    glm::vec3 invDir = 1.0f / dir;
+
+    // Slab test returning the entry distance, or FLT_MAX on a miss
+    auto entry = [&](const AABB& box) {
+        glm::vec3 t0 = (box.min - origin) * invDir;
+        glm::vec3 t1 = (box.max - origin) * invDir;
+        glm::vec3 tNear = glm::min(t0, t1);
+        glm::vec3 tFar = glm::max(t0, t1);
+        float enter = std::max(std::max(tNear.x, tNear.y), std::max(tNear.z, 0.0f));
+        float exit = std::min(std::min(tFar.x, tFar.y), tFar.z);
+        return enter <= exit ? enter : FLT_MAX;
+    };
+
+    int closest = -1;
+    float closestT = FLT_MAX;
+
+    std::vector<std::pair<int, float>> stack;
+    float rootT = entry(nodes[0].bounds);
+    if (rootT != FLT_MAX) stack.push_back({0, rootT});
+
+    while (!stack.empty()) {
+        auto [index, t] = stack.back();
+        stack.pop_back();
+        if (t >= closestT) continue;
+
+        const Node& node = nodes[index];
+        if (node.isLeaf()) {
+            for (int i = node.first; i < node.first + node.count; i++) {
+                float hitT;
+                if (entry(bounds[items[i]]) < closestT && hitTest(items[i], hitT) && hitT < closestT) {
+                    closestT = hitT;
+                    closest = items[i];
+                }
+            }
+            continue;
+        }
+
+        // Visit the nearer child first
+        float tLeft = entry(nodes[node.left].bounds);
+        float tRight = entry(nodes[node.right].bounds);
+        if (tLeft > tRight) {
+            if (tLeft < closestT) stack.push_back({node.left, tLeft});
+            if (tRight < closestT) stack.push_back({node.right, tRight});
+        } else {
+            if (tRight < closestT) stack.push_back({node.right, tRight});
+            if (tLeft < closestT) stack.push_back({node.left, tLeft});
+        }
+    }
+
+    if (closest != -1) tOut = closestT;
+    return closest;
+}
+
+// === Getters ===
+float BVH::getCost() const {
+    if (nodes.empty()) return 0.0f;
+
+    // Surface area heuristic cost relative to the root
+    float rootArea = std::max(nodes[0].bounds.getSurfaceArea(), FLT_MIN);
+    float cost = 0.0f;
+    for (const Node& node : nodes) {
+        float area = node.bounds.getSurfaceArea() / rootArea;
+        cost += node.isLeaf() ? area * node.count : area * TRAVERSAL_COST;
+    }
+    return cost;
+}
+
+// === Internal building ===
+int BVH::buildRecursive(int first, int count, int parent) {
+    int index = static_cast<int>(nodes.size());
+    nodes.emplace_back();
+    nodes[index].parent = parent;
+
+    AABB nodeBounds, centroidBounds;
+    for (int i = first; i < first + count; i++) {
+        nodeBounds.expand(bounds[items[i]]);
+        centroidBounds.expand(bounds[items[i]].getCenter());
+    }
+    nodes[index].bounds = nodeBounds;
+
+    auto makeLeaf = [&]() {
+        nodes[index].first = first;
+        nodes[index].count = count;
+        for (int i = first; i < first + count; i++) {
+            itemLeaf[items[i]] = index;
+        }
+        return index;
+    };
+
+    if (count <= LEAF_SIZE) return makeLeaf();
+
+    // Split along the widest centroid axis
+    glm::vec3 extent = centroidBounds.max - centroidBounds.min;
+    int axis = extent.x > extent.y ? (extent.x > extent.z ? 0 : 2) : (extent.y > extent.z ? 1 : 2);
+    if (extent[axis] <= 0.0f) {
+        if (count <= MAX_LEAF_SIZE) return makeLeaf();
+    }
+
+    int split = first + count / 2;
+    if (extent[axis] > 0.0f) {
+        // Binned surface area heuristic
+        int binCounts[BIN_COUNT] = {};
+        AABB binBounds[BIN_COUNT];
+        float scale = BIN_COUNT / extent[axis];
+        auto binOf = [&](int item) {
+            int bin = static_cast<int>((bounds[item].getCenter()[axis] - centroidBounds.min[axis]) * scale);
+            return std::min(bin, BIN_COUNT - 1);
+        };
+        for (int i = first; i < first + count; i++) {
+            int bin = binOf(items[i]);
+            binCounts[bin]++;
+            binBounds[bin].expand(bounds[items[i]]);
+        }
+
+        // Sweep from the right to get suffix areas, then from the left to find the cheapest plane
+        float rightArea[BIN_COUNT];
+        int rightCount[BIN_COUNT];
+        AABB accum;
+        int accumCount = 0;
+        for (int b = BIN_COUNT - 1; b > 0; b--) {
+            accum.expand(binBounds[b]);
+            accumCount += binCounts[b];
+            rightArea[b] = accumCount ? accum.getSurfaceArea() : 0.0f;
+            rightCount[b] = accumCount;
+        }
+
+        float bestCost = FLT_MAX;
+        int bestBin = -1;
+        accum = AABB();
+        accumCount = 0;
+        for (int b = 0; b < BIN_COUNT - 1; b++) {
+            accum.expand(binBounds[b]);
+            accumCount += binCounts[b];
+            if (accumCount == 0 || rightCount[b + 1] == 0) continue;
+            float cost = accum.getSurfaceArea() * accumCount + rightArea[b + 1] * rightCount[b + 1];
+            if (cost < bestCost) {
+                bestCost = cost;
+                bestBin = b;
+            }
+        }
+
+        float leafCost = nodeBounds.getSurfaceArea() * count;
+        float splitCost = nodeBounds.getSurfaceArea() * TRAVERSAL_COST + bestCost;
+        if (bestBin != -1 && splitCost >= leafCost && count <= MAX_LEAF_SIZE) return makeLeaf();
+
+        if (bestBin != -1) {
+            auto middle = std::partition(items.begin() + first, items.begin() + first + count,
+                [&](int item) {return binOf(item) <= bestBin;});
+            split = static_cast<int>(middle - items.begin());
+        }
+    }
+
+    // Fall back to a median split when binning could not separate the items
+    if (split == first || split == first + count) {
+        split = first + count / 2;
+        std::nth_element(items.begin() + first, items.begin() + split, items.begin() + first + count,
+            [&](int a, int b) {return bounds[a].getCenter()[axis] < bounds[b].getCenter()[axis];});
+    }
+
+    int left = buildRecursive(first, split - first, index);
+    int right = buildRecursive(split, first + count - split, index);
+    nodes[index].left = left;
+    nodes[index].right = right;
+    return index;
+}
+
+void BVH::collectLeaves(int node, std::vector<int>& out) const {
+    std::vector<int> stack = {node};
+    while (!stack.empty()) {
+        const Node& current = nodes[stack.back()];
+        stack.pop_back();
+
+        if (current.isLeaf()) {
+            for (int i = current.first; i < current.first + current.count; i++) {
+                out.push_back(items[i]);
+            }
+        } else {
+            stack.push_back(current.left);
+            stack.push_back(current.right);
+        }
+    }
+}
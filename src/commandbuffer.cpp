@@ -0,0 +1,260 @@
+#include <algorithm>
+#include <cmath>
+
+#include "commandbuffer.hpp"
+
+// === Constants ===
+static const float MIN_TEXTURE_DEPTH = 0.1f; // Closer bounds count as this far, the finest mip is wanted by then anyway
+
+// === Helpers ===
+static void addTextureUse(std::vector<TextureUse>& uses, Texture* texture, float size) {
+    for (TextureUse& use : uses) {
+        if (use.texture == texture) {
+            use.size = std::max(use.size, size);
+            return;
+        }
+    }
+    uses.push_back({texture, size});
+}
+
+static unsigned int getProgramID(const Shader* shader) {
+    return shader ? shader->getID() : 0;
+}
+
+// ### CommandBuffer functions ###
+// === Recording ===
+void CommandBuffer::begin(const glm::mat4& viewMatrix) {
+    view = viewMatrix;
+    items.clear();
+    commands.clear();
+    instances.clear();
+    textureUses.clear();
+    drawBounds.clear();
+}
+
+void CommandBuffer::submit(const Mesh* mesh, Shader* shader, const Material& material, const InstanceData& instance) {
+    Texture* texture = material.getTexture();
+
+    // Only the view-space z of the world center is needed
+    glm::vec3 localCenter = (mesh->getMinBounds() + mesh->getMaxBounds()) * 0.5f;
+    glm::vec4 worldCenter = instance.model * glm::vec4(localCenter, 1.0f);
+    float depth = -(view[0][2] * worldCenter.x + view[1][2] * worldCenter.y + view[2][2] * worldCenter.z + view[3][2]);
+
+    // Bounding sphere seen from its nearest point, so large meshes around the camera ask for full detail
+    float textureSize = 0.0f;
+    if (texture) {
+        float scale = std::sqrt(std::max({glm::dot(glm::vec3(instance.model[0]), glm::vec3(instance.model[0])),
+            glm::dot(glm::vec3(instance.model[1]), glm::vec3(instance.model[1])),
+            glm::dot(glm::vec3(instance.model[2]), glm::vec3(instance.model[2]))}));
+        float radius = glm::length(mesh->getMaxBounds() - mesh->getMinBounds()) * 0.5f * scale;
+        float repeats = std::max({instance.params.x, instance.params.y, 1e-3f});
+        textureSize = 2.0f * radius / std::max(depth - radius, MIN_TEXTURE_DEPTH) / repeats;
+    }
+    items.push_back({mesh, shader, material.getID(), texture, instance, depth, textureSize});
+}
+
+void CommandBuffer::end() {
+    order.clear();
+    for (const DrawItem& item : items) {
+        order.push_back(&item);
+    }
+
+    // Group by program, then material, then mesh so equal meshes become one instanced draw,
+    // nearest instance first. Programs go by GL name everywhere: variants are allocated in
+    // no fixed address order, and a variant still linking shares its family's program.
+    std::sort(order.begin(), order.end(), [](const DrawItem* a, const DrawItem* b) {
+        unsigned int programA = getProgramID(a->shader);
+        unsigned int programB = getProgramID(b->shader);
+        if (programA != programB) return programA < programB;
+        if (a->material != b->material) return a->material < b->material;
+        if (a->mesh->getArenaHandle() != b->mesh->getArenaHandle()) return a->mesh->getArenaHandle() < b->mesh->getArenaHandle();
+        return a->depth < b->depth;
+    });
+
+    // Items sharing a mesh form a group, groups sharing state form a run
+    groups.clear();
+    runs.clear();
+    for (size_t i = 0; i < order.size(); i++) {
+        const DrawItem* item = order[i];
+        const DrawItem* previous = i ? order[i - 1] : nullptr;
+        bool newRun = !previous || getProgramID(previous->shader) != getProgramID(item->shader) || previous->material != item->material;
+        if (newRun) {
+            runs.push_back({groups.size(), 0, item->depth});
+        }
+        if (newRun || previous->mesh != item->mesh) {
+            groups.push_back({i, 0, item->depth});
+            runs.back().count++;
+        }
+        groups.back().count++;
+    }
+
+    // Nearest run first, and nearest group first inside a run
+    std::sort(runs.begin(), runs.end(), [](const Range& a, const Range& b) {return a.depth < b.depth;});
+    for (const Range& run : runs) {
+        std::sort(groups.begin() + run.first, groups.begin() + run.first + run.count,
+            [](const Range& a, const Range& b) {return a.depth < b.depth;});
+    }
+
+    GeometryArena& arena = GeometryArena::get();
+    Shader* program = nullptr;
+    const DrawItem* material = nullptr;
+    for (const Range& run : runs) {
+        const DrawItem* first = order[groups[run.first].first];
+        if (getProgramID(first->shader) != getProgramID(program)) {
+            bindProgram(first->shader);
+            program = first->shader;
+            material = nullptr;
+        }
+        if (!material || first->material != material->material) {
+            bindMaterial(first->material, first->texture);
+            material = first;
+        }
+
+        for (size_t g = run.first; g < run.first + run.count; g++) {
+            const Range& group = groups[g];
+            if (first->texture) {
+                for (size_t i = group.first; i < group.first + group.count; i++) {
+                    addTextureUse(textureUses, first->texture, order[i]->textureSize);
+                }
+            }
+            Command command;
+            command.type = CommandType::Draw;
+            command.draw = arena.getCommand(order[group.first]->mesh->getArenaHandle());
+            command.draw.baseInstance = static_cast<unsigned int>(instances.size());
+            command.draw.instanceCount = static_cast<unsigned int>(group.count);
+            commands.push_back(command);
+            const Mesh* mesh = order[group.first]->mesh;
+            drawBounds.push_back({glm::vec4(mesh->getMinBounds(), 0.0f), glm::vec4(mesh->getMaxBounds(), 0.0f)});
+
+            for (size_t i = group.first; i < group.first + group.count; i++) {
+                instances.push_back(order[i]->instance);
+            }
+        }
+    }
+}
+
+// === Direct recording ===
+void CommandBuffer::bindProgram(Shader* shader) {
+    Command command;
+    command.type = CommandType::BindProgram;
+    command.shader = shader;
+    commands.push_back(command);
+}
+
+void CommandBuffer::bindMaterial(unsigned int material, Texture* texture) {
+    Command command;
+    command.type = CommandType::BindMaterial;
+    command.material = material;
+    command.texture = texture;
+    commands.push_back(command);
+}
+
+void CommandBuffer::draw(const DrawElementsIndirectCommand& geometry, const InstanceData* data, size_t count) {
+    Command command;
+    command.type = CommandType::Draw;
+    command.draw = geometry;
+    command.draw.baseInstance = static_cast<unsigned int>(instances.size());
+    command.draw.instanceCount = static_cast<unsigned int>(count);
+    commands.push_back(command);
+    instances.insert(instances.end(), data, data + count);
+    drawBounds.push_back({glm::vec4(1.0f), glm::vec4(-1.0f)});
+}
+
+// ### CommandStream functions ###
+// === Merging ===
+void CommandStream::merge(const std::vector<CommandBuffer>& buffers) {
+    ops.clear();
+    instances.clear();
+    draws.clear();
+    textureUses.clear();
+    drawBounds.clear();
+    runCount = 0;
+
+    Shader* program = nullptr;
+    const Command* material = nullptr;
+
+    for (const CommandBuffer& buffer : buffers) {
+        unsigned int base = static_cast<unsigned int>(instances.size());
+        instances.insert(instances.end(), buffer.getInstances().begin(), buffer.getInstances().end());
+        for (const TextureUse& use : buffer.getTextureUses()) {
+            addTextureUse(textureUses, use.texture, use.size);
+        }
+
+        size_t drawIndex = 0;
+        for (const Command& command : buffer.getCommands()) {
+            switch (command.type) {
+            case CommandType::BindProgram:
+                if (command.shader == program) break;
+                ops.push_back({CommandType::BindProgram, 0, command.shader, nullptr, 0, 0});
+                program = command.shader;
+                material = nullptr;
+                break;
+
+            case CommandType::BindMaterial:
+                if (material && command.material == material->material && command.texture == material->texture) break;
+                ops.push_back({CommandType::BindMaterial, command.material, nullptr, command.texture, 0, 0});
+                material = &command;
+                break;
+
+            case CommandType::Draw: {
+                DrawElementsIndirectCommand rebased = command.draw;
+                rebased.baseInstance += base;
+
+                // Draws with nothing bound in between extend the current run
+                if (ops.empty() || ops.back().type != CommandType::Draw) {
+                    ops.push_back({CommandType::Draw, 0, nullptr, nullptr, draws.size(), 0});
+                    runCount++;
+                }
+                ops.back().drawCount++;
+                draws.push_back(rebased);
+                drawBounds.push_back(buffer.getDrawBounds()[drawIndex++]);
+                break;
+            }
+            }
+        }
+    }
+}
+
+// === Replay ===
+void CommandStream::replay(CommandBackend& backend) const {
+    for (const Op& op : ops) {
+        switch (op.type) {
+        case CommandType::BindProgram:
+            backend.bindProgram(op.shader);
+            break;
+        case CommandType::BindMaterial:
+            backend.bindMaterial(op.material, op.texture);
+            break;
+        case CommandType::Draw:
+            backend.draw(op.firstDraw, op.drawCount);
+            break;
+        }
+    }
+}
+
+// ### NullBackend functions ###
+// === Replay target ===
+void NullBackend::bindProgram(Shader* shader) {
+    program = shader;
+    programBinds++;
+}
+
+void NullBackend::bindMaterial(unsigned int, Texture*) {
+    materialBinds++;
+}
+
+void NullBackend::draw(size_t firstCommand, size_t commandCount) {
+    drawCalls++;
+    const std::vector<DrawElementsIndirectCommand>& draws = stream.getDraws();
+    if (!program || firstCommand + commandCount > draws.size()) {
+        errors++;
+        return;
+    }
+
+    for (size_t i = firstCommand; i < firstCommand + commandCount; i++) {
+        const DrawElementsIndirectCommand& command = draws[i];
+        if (command.baseInstance + command.instanceCount > stream.getInstances().size()) errors++;
+        commands++;
+        instances += command.instanceCount;
+    }
+}
@@ -0,0 +1,142 @@
+#include <glad/glad.h>
+#include <algorithm>
+#include <iostream>
+
+#include "dynamicbuffer.hpp"
+#include "glstate.hpp"
+
+// === Constants ===
+static const GLuint64 FENCE_TIMEOUT = 1000000; // 1ms per wait attempt
+
+// === Constructor ===
+DynamicBuffer::DynamicBuffer(size_t frameCapacity)
+    : frameCapacity(frameCapacity) {
+    // Persistent coherent mapping needs glBufferStorage (4.4)
+    persistent = GLAD_GL_VERSION_4_4;
+    create();
+}
+
+// === Deconstructor ===
+DynamicBuffer::~DynamicBuffer() {
+    destroy();
+}
+
+// === Frame lifecycle ===
+void DynamicBuffer::beginFrame() {
+    // The region about to be written was last used FRAME_COUNT frames ago
+    waitForFrame(frame);
+    frameOffset = 0;
+
+    if (!persistent) {
+        mapRegion();
+    }
+}
+
+void DynamicBuffer::reserve(size_t bytes) {
+    if (frameOffset + bytes <= frameCapacity) return;
+
+    // Regrow the ring; the old buffer stays alive in the driver until the GPU releases it
+    size_t newCapacity = std::max(frameCapacity * 2, frameOffset + bytes);
+    std::cout << "Dynamic buffer grown to " << newCapacity << " bytes per frame" << std::endl;
+
+    destroy();
+    frameCapacity = newCapacity;
+    frameOffset = 0;
+    create();
+
+    if (!persistent) {
+        mapRegion();
+    }
+}
+
+void* DynamicBuffer::allocate(size_t bytes, size_t alignment, size_t& offset) {
+    size_t aligned = (frameOffset + alignment - 1) / alignment * alignment;
+    if (aligned + bytes > frameCapacity || !mapped) {
+        std::cerr << "Dynamic buffer out of space, reserve the frame's size first" << std::endl;
+        return nullptr;
+    }
+
+    frameOffset = aligned + bytes;
+    offset = frame * frameCapacity + aligned;
+
+    // Persistent mappings cover the whole ring, fallback mappings only this frame's region
+    return mapped + (persistent ? offset : aligned);
+}
+
+void DynamicBuffer::flush() {
+    // Coherent persistent mappings are visible without any call
+    if (persistent || !regionMapped) return;
+
+    GLState::get().bindBuffer(GL_COPY_WRITE_BUFFER, buffer);
+    glUnmapBuffer(GL_COPY_WRITE_BUFFER);
+    regionMapped = false;
+    mapped = nullptr;
+}
+
+void DynamicBuffer::endFrame() {
+    flush();
+
+    fences[frame] = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+    frame = (frame + 1) % FRAME_COUNT;
+}
+
+// === Internal setup ===
+void DynamicBuffer::create() {
+    glGenBuffers(1, &buffer);
+    GLState::get().bindBuffer(GL_COPY_WRITE_BUFFER, buffer);
+
+    size_t totalSize = frameCapacity * FRAME_COUNT;
+    if (persistent) {
+        GLbitfield flags = GL_MAP_WRITE_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT;
+        glBufferStorage(GL_COPY_WRITE_BUFFER, totalSize, nullptr, flags);
+        mapped = static_cast<unsigned char*>(glMapBufferRange(GL_COPY_WRITE_BUFFER, 0, totalSize, flags));
+    } else {
+        glBufferData(GL_COPY_WRITE_BUFFER, totalSize, nullptr, GL_STREAM_DRAW);
+    }
+}
+
+void DynamicBuffer::destroy() {
+    for (GLsync& fence : fences) {
+        if (fence) {
+            glDeleteSync(fence);
+            fence = nullptr;
+        }
+    }
+
+    if (buffer) {
+        if (persistent || regionMapped) {
+            GLState::get().bindBuffer(GL_COPY_WRITE_BUFFER, buffer);
+            glUnmapBuffer(GL_COPY_WRITE_BUFFER);
+        }
+        GLState::get().deleteBuffer(buffer);
+    }
+
+    buffer = 0;
+    mapped = nullptr;
+    regionMapped = false;
+}
+
+void DynamicBuffer::mapRegion() {
+    // Fences already guarantee the GPU is done with this region, so skip driver synchronization
+    GLbitfield flags = GL_MAP_WRITE_BIT | GL_MAP_UNSYNCHRONIZED_BIT | GL_MAP_INVALIDATE_RANGE_BIT;
+
+    GLState::get().bindBuffer(GL_COPY_WRITE_BUFFER, buffer);
+    mapped = static_cast<unsigned char*>(glMapBufferRange(GL_COPY_WRITE_BUFFER, frame * frameCapacity, frameCapacity, flags));
+    regionMapped = mapped != nullptr;
+}
+
+void DynamicBuffer::waitForFrame(int index) {
+    GLsync& fence = fences[index];
+    if (!fence) return;
+
+    GLenum result = glClientWaitSync(fence, 0, 0);
+    if (result == GL_TIMEOUT_EXPIRED) {
+        stalls++;
+        do {
+            result = glClientWaitSync(fence, GL_SYNC_FLUSH_COMMANDS_BIT, FENCE_TIMEOUT);
+        } while (result == GL_TIMEOUT_EXPIRED);
+    }
+
+    glDeleteSync(fence);
+    fence = nullptr;
+}
@@ -0,0 +1,123 @@
+#include <glad/glad.h>
+#include <algorithm>
+#include <cmath>
+
+#include "dynamicresolution.hpp"
+#include "renderer.hpp"
+#include "glstate.hpp"
+
+// === Constants ===
+static const double SMOOTHING = 0.2;
+static const double OVER_BUDGET = 1.0;    // Drop when smoothed time is above target * this
+static const double UNDER_BUDGET = 0.85;  // Rise only below target * this
+static const int RAISE_FRAMES = 30;
+static const int SETTLE_FRAMES = Profiler::FRAME_COUNT + 2;
+
+// === Control ===
+float DynamicResolution::update(const Profiler& profiler) {
+    if (!enabled) {
+        scale = MAX_SCALE;
+        smoothedMs = -1.0;
+        underBudgetFrames = 0;
+        return scale;
+    }
+
+    // Only new resolved frames count, timings arrive a few frames late
+    size_t resolved = profiler.getResolvedFrames();
+    if (resolved == lastResolved) return scale;
+    lastResolved = resolved;
+
+    double frameMs = 0.0;
+    bool timed = false;
+    for (const ProfileResult& result : profiler.getResults()) {
+        if (result.gpuMs < 0.0) continue;
+        frameMs += result.gpuMs;
+        timed = true;
+    }
+    if (!timed) return scale;
+
+    if (settleFrames > 0) {
+        // Timings still from before the last change
+        settleFrames--;
+        return scale;
+    }
+    smoothedMs = smoothedMs < 0.0 ? frameMs : smoothedMs + (frameMs - smoothedMs) * SMOOTHING;
+    gpuMs = smoothedMs;
+
+    // Pixel cost follows the area, so the ideal scale moves with the square root of the ratio
+    float current = scale;
+    float ideal = current * static_cast<float>(std::sqrt(targetMs / std::max(smoothedMs, 0.01)));
+    float next = current;
+    if (smoothedMs > targetMs * OVER_BUDGET) {
+        underBudgetFrames = 0;
+        next = std::max(ideal, current - MAX_STEP);
+    } else if (smoothedMs < targetMs * UNDER_BUDGET) {
+        if (++underBudgetFrames >= RAISE_FRAMES) {
+            underBudgetFrames = 0;
+            next = std::min(ideal, current + MAX_STEP);
+        }
+    } else {
+        underBudgetFrames = 0;
+    }
+
+    next = std::clamp(next, MIN_SCALE, MAX_SCALE);
+    if (std::fabs(next - current) > 1e-3f) {
+        scale = next;
+        settleFrames = SETTLE_FRAMES;
+        smoothedMs = -1.0;
+    }
+    return scale;
+}
+
+// === Passes ===
+void DynamicResolution::addScenePasses(RenderGraph& graph, Renderer& renderer, const AttachmentDesc& native,
+    const std::string& target, const std::string& targetDepth) {
+    // The window's depth cannot be sampled, so passes reading depth render offscreen even at full size
+    float current = scale;
+    if (current >= MAX_SCALE && !renderer.needsSampledDepth()) {
+        renderer.addPasses(graph, target, targetDepth);
+        return;
+    }
+
+    AttachmentDesc color = native;
+    color.format = AttachmentFormat::RGBA8;
+    color.width = std::max(1, static_cast<int>(std::lround(native.width * current)));
+    color.height = std::max(1, static_cast<int>(std::lround(native.height * current)));
+    AttachmentDesc depth = color;
+    depth.format = AttachmentFormat::Depth24;
+    graph.createAttachment("SceneColor", color);
+    graph.createAttachment("SceneDepth", depth);
+    renderer.addPasses(graph, "SceneColor", "SceneDepth");
+
+    if (!upscaleShader) {
+        upscaleShader = std::make_unique<Shader>("assets/shaders/upscale/vertex.glsl", "assets/shaders/upscale/fragment.glsl", "upscale");
+        glGenVertexArrays(1, &emptyVao);
+    }
+
+    // Covers the whole target, so the window needs no clear first
+    float amount = current < MAX_SCALE ? sharpness.load() : 0.0f;
+    graph.addPass("Upscale", [this, amount](const RenderGraph& compiled) {
+        GLState& state = GLState::get();
+        bool depthTest = state.isEnabled(GL_DEPTH_TEST);
+        state.setEnabled(GL_DEPTH_TEST, false);
+
+        upscaleShader->use();
+        upscaleShader->setInt("source", 0);
+        upscaleShader->setFloat("sharpness", amount);
+        state.bindTexture(0, GL_TEXTURE_2D, compiled.getTexture("SceneColor"));
+
+        GLState::get().bindVertexArray(emptyVao);
+        glDrawArrays(GL_TRIANGLES, 0, 3);
+        GLState::get().bindVertexArray(0);
+
+        state.setEnabled(GL_DEPTH_TEST, depthTest);
+    }).read("SceneColor").write(target);
+}
+
+void DynamicResolution::release() {
+    upscaleShader.reset();
+    if (emptyVao) {
+        GLState::get().deleteVertexArray(emptyVao);
+        emptyVao = 0;
+    }
+}
@@ -0,0 +1,98 @@
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <thread>
+
+#include "framepacer.hpp"
+
+// === Constants ===
+static const double SMOOTHING = 0.1;
+static const double COST_DEVIATIONS = 2.0;     // Predicted cost is the mean plus this many deviations
+static const double COST_MARGIN = 0.001;       // Seconds kept spare ahead of the refresh
+static const double MIN_SLEEP_ESTIMATE = 0.001;
+static const double MAX_SLEEP_ESTIMATE = 0.02;
+static const std::chrono::milliseconds SWAP_TIMEOUT(100);
+
+// === Timing ===
+double FramePacer::now() {
+    static const std::chrono::steady_clock::time_point epoch = std::chrono::steady_clock::now();
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - epoch).count();
+}
+
+// === Game thread ===
+double FramePacer::waitForInput() {
+    PacingMode current = mode;
+    if (current == PacingMode::Capped) {
+        // Fixed grid, restarted when a frame ran a whole period late so slow frames don't cause a burst
+        double period = 1.0 / std::max(1.0f, capHz.load());
+        double start = now();
+        if (nextDeadline <= 0.0 || start - nextDeadline > period) nextDeadline = start;
+        sleepUntil(nextDeadline);
+        nextDeadline += period;
+    } else {
+        nextDeadline = 0.0;
+    }
+
+    std::unique_lock<std::mutex> lock(mutex);
+    if (current == PacingMode::LowLatency) {
+        // One frame at a time, the next refresh after the previous swap is this frame's target
+        swapped.wait_for(lock, SWAP_TIMEOUT, [this]() {return swappedFrames >= sampledFrames;});
+        double period = 1.0 / std::max(1.0f, refreshHz.load());
+        double cost = costMean < 0.0 ? 0.0 : costMean + costDeviation * COST_DEVIATIONS + COST_MARGIN;
+        double sampleAt = lastSwapEnd + period - cost;
+        predictedCostMs = cost * 1000.0;
+        lock.unlock();
+
+        sleepUntil(sampleAt);
+        lock.lock();
+    }
+    sampledFrames++;
+    return now();
+}
+
+// === Render thread ===
+void FramePacer::onSwap(double inputTime, double swapStart, double swapEnd) {
+    if (inputTime > 0.0) {
+        double latency = (swapEnd - inputTime) * 1000.0;
+        double average = averageLatencyMs;
+        latencyMs = latency;
+        averageLatencyMs = average <= 0.0 ? latency : average + (latency - average) * SMOOTHING;
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        if (inputTime > 0.0) {
+            // Work up to the swap, the wait for the display inside it is not part of the cost
+            double cost = swapStart - inputTime;
+            if (costMean < 0.0) {
+                costMean = cost;
+                costDeviation = 0.0;
+            } else {
+                costDeviation += (std::fabs(cost - costMean) - costDeviation) * SMOOTHING;
+                costMean += (cost - costMean) * SMOOTHING;
+            }
+        }
+        lastSwapEnd = swapEnd;
+        swappedFrames++;
+    }
+    swapped.notify_all();
+}
+
+// === Internal helpers ===
+void FramePacer::sleepUntil(double deadline) {
+    while (true) {
+        double remaining = deadline - now();
+        if (remaining <= 0.0) return;
+
+        if (remaining > sleepEstimate) {
+            // Short sleeps, the estimate jumps to late wake-ups and decays slowly
+            double start = now();
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+            double slept = now() - start;
+            sleepEstimate = slept > sleepEstimate ? slept : sleepEstimate + (slept - sleepEstimate) * SMOOTHING;
+            sleepEstimate = std::clamp(sleepEstimate, MIN_SLEEP_ESTIMATE, MAX_SLEEP_ESTIMATE);
+        } else {
+            std::this_thread::yield();
+        }
+    }
+}
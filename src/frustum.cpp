@@ -0,0 +1,245 @@
+#include <cmath>
+
+#if defined(__SSE2__)
+#include <immintrin.h>
+#define FRUSTUM_SSE 1
+#endif
+
+#if FRUSTUM_SSE && defined(__GNUC__)
+#define FRUSTUM_AVX2 1
+#endif
+
+#include "frustum.hpp"
+
+// ### Frustum functions ###
+// === Constructors ===
+Frustum Frustum::fromMatrix(const glm::mat4& m) {
+    // Gribb/Hartmann plane extraction from the rows of the view-projection
+    glm::vec4 row0(m[0][0], m[1][0], m[2][0], m[3][0]);
+    glm::vec4 row1(m[0][1], m[1][1], m[2][1], m[3][1]);
+    glm::vec4 row2(m[0][2], m[1][2], m[2][2], m[3][2]);
+    glm::vec4 row3(m[0][3], m[1][3], m[2][3], m[3][3]);
+
+    Frustum frustum;
+    frustum.planes[0] = row3 + row0; // Left
+    frustum.planes[1] = row3 - row0; // Right
+    frustum.planes[2] = row3 + row1; // Bottom
+    frustum.planes[3] = row3 - row1; // Top
+    frustum.planes[4] = row3 + row2; // Near
+    frustum.planes[5] = row3 - row2; // Far
+
+    for (glm::vec4& plane : frustum.planes) {
+        plane /= glm::length(glm::vec3(plane));
+    }
+    return frustum;
+}
+
+// === Intersection ===
+bool Frustum::intersects(const OBB& obb) const {
+    for (const glm::vec4& plane : planes) {
+        glm::vec3 normal(plane);
+        float distance = glm::dot(normal, obb.center) + plane.w;
+        float radius = obb.extents.x * std::fabs(glm::dot(normal, obb.axes[0]))
+                     + obb.extents.y * std::fabs(glm::dot(normal, obb.axes[1]))
+                     + obb.extents.z * std::fabs(glm::dot(normal, obb.axes[2]));
+        if (distance + radius < 0.0f) return false;
+    }
+    return true;
+}
+
+// ### OBBArray functions ###
+void OBBArray::clear() {
+    centerX.clear(); centerY.clear(); centerZ.clear();
+    extentX.clear(); extentY.clear(); extentZ.clear();
+    for (auto& axis : axes) axis.clear();
+}
+
+void OBBArray::reserve(size_t count) {
+    centerX.reserve(count); centerY.reserve(count); centerZ.reserve(count);
+    extentX.reserve(count); extentY.reserve(count); extentZ.reserve(count);
+    for (auto& axis : axes) axis.reserve(count);
+}
+
+void OBBArray::push(const OBB& obb) {
+    centerX.push_back(obb.center.x);
+    centerY.push_back(obb.center.y);
+    centerZ.push_back(obb.center.z);
+    extentX.push_back(obb.extents.x);
+    extentY.push_back(obb.extents.y);
+    extentZ.push_back(obb.extents.z);
+    for (int k = 0; k < 3; k++) {
+        for (int j = 0; j < 3; j++) {
+            axes[k * 3 + j].push_back(obb.axes[k][j]);
+        }
+    }
+}
+
+// ### Culling kernels ###
+// Each kernel sums in the scalar kernel's order and only culls a box whose
+// signed distance is below zero, so NaNs keep the box in all of them
+// === Scalar ===
+static size_t cullScalar(const Frustum& frustum, const OBBArray& boxes, unsigned char* visible, size_t begin, size_t end) {
+    size_t count = 0;
+    for (size_t i = begin; i < end; i++) {
+        bool inside = true;
+        for (const glm::vec4& p : frustum.planes) {
+            float distance = p.x * boxes.centerX[i] + p.y * boxes.centerY[i] + p.z * boxes.centerZ[i] + p.w;
+            float r0 = std::fabs(p.x * boxes.axes[0][i] + p.y * boxes.axes[1][i] + p.z * boxes.axes[2][i]);
+            float r1 = std::fabs(p.x * boxes.axes[3][i] + p.y * boxes.axes[4][i] + p.z * boxes.axes[5][i]);
+            float r2 = std::fabs(p.x * boxes.axes[6][i] + p.y * boxes.axes[7][i] + p.z * boxes.axes[8][i]);
+            float radius = boxes.extentX[i] * r0 + boxes.extentY[i] * r1 + boxes.extentZ[i] * r2;
+            if (distance + radius < 0.0f) {
+                inside = false;
+                break;
+            }
+        }
+        visible[i] = inside;
+        count += inside;
+    }
+    return count;
+}
+
+#if FRUSTUM_SSE
+// === SSE (4 boxes per iteration) ===
+static size_t cullSSE(const Frustum& frustum, const OBBArray& boxes, unsigned char* visible) {
+    const size_t n = boxes.size();
+    const __m128 signMask = _mm_set1_ps(-0.0f);
+    size_t count = 0;
+    size_t i = 0;
+
+    for (; i + 4 <= n; i += 4) {
+        __m128 cx = _mm_loadu_ps(&boxes.centerX[i]);
+        __m128 cy = _mm_loadu_ps(&boxes.centerY[i]);
+        __m128 cz = _mm_loadu_ps(&boxes.centerZ[i]);
+        __m128 ex = _mm_loadu_ps(&boxes.extentX[i]);
+        __m128 ey = _mm_loadu_ps(&boxes.extentY[i]);
+        __m128 ez = _mm_loadu_ps(&boxes.extentZ[i]);
+        __m128 a[9];
+        for (int k = 0; k < 9; k++) a[k] = _mm_loadu_ps(&boxes.axes[k][i]);
+
+        __m128 inside = _mm_castsi128_ps(_mm_set1_epi32(-1));
+        for (const glm::vec4& p : frustum.planes) {
+            __m128 nx = _mm_set1_ps(p.x), ny = _mm_set1_ps(p.y), nz = _mm_set1_ps(p.z);
+            __m128 distance = _mm_add_ps(_mm_add_ps(_mm_add_ps(_mm_mul_ps(nx, cx), _mm_mul_ps(ny, cy)), _mm_mul_ps(nz, cz)), _mm_set1_ps(p.w));
+            __m128 r0 = _mm_andnot_ps(signMask, _mm_add_ps(_mm_add_ps(_mm_mul_ps(nx, a[0]), _mm_mul_ps(ny, a[1])), _mm_mul_ps(nz, a[2])));
+            __m128 r1 = _mm_andnot_ps(signMask, _mm_add_ps(_mm_add_ps(_mm_mul_ps(nx, a[3]), _mm_mul_ps(ny, a[4])), _mm_mul_ps(nz, a[5])));
+            __m128 r2 = _mm_andnot_ps(signMask, _mm_add_ps(_mm_add_ps(_mm_mul_ps(nx, a[6]), _mm_mul_ps(ny, a[7])), _mm_mul_ps(nz, a[8])));
+            __m128 radius = _mm_add_ps(_mm_add_ps(_mm_mul_ps(ex, r0), _mm_mul_ps(ey, r1)), _mm_mul_ps(ez, r2));
+            inside = _mm_and_ps(inside, _mm_cmpnlt_ps(_mm_add_ps(distance, radius), _mm_setzero_ps()));
+        }
+
+        int bits = _mm_movemask_ps(inside);
+        for (int lane = 0; lane < 4; lane++) {
+            visible[i + lane] = (bits >> lane) & 1;
+        }
+        count += __builtin_popcount(bits);
+    }
+
+    return count + cullScalar(frustum, boxes, visible, i, n);
+}
+#endif
+
+#if FRUSTUM_AVX2
+// === AVX2 (8 boxes per iteration) ===
+__attribute__((target("avx2")))
+static size_t cullAVX2(const Frustum& frustum, const OBBArray& boxes, unsigned char* visible) {
+    const size_t n = boxes.size();
+    const __m256 signMask = _mm256_set1_ps(-0.0f);
+    size_t count = 0;
+    size_t i = 0;
+
+    for (; i + 8 <= n; i += 8) {
+        __m256 cx = _mm256_loadu_ps(&boxes.centerX[i]);
+        __m256 cy = _mm256_loadu_ps(&boxes.centerY[i]);
+        __m256 cz = _mm256_loadu_ps(&boxes.centerZ[i]);
+        __m256 ex = _mm256_loadu_ps(&boxes.extentX[i]);
+        __m256 ey = _mm256_loadu_ps(&boxes.extentY[i]);
+        __m256 ez = _mm256_loadu_ps(&boxes.extentZ[i]);
+        __m256 a[9];
+        for (int k = 0; k < 9; k++) a[k] = _mm256_loadu_ps(&boxes.axes[k][i]);
+
+        __m256 inside = _mm256_castsi256_ps(_mm256_set1_epi32(-1));
+        for (const glm::vec4& p : frustum.planes) {
+            __m256 nx = _mm256_set1_ps(p.x), ny = _mm256_set1_ps(p.y), nz = _mm256_set1_ps(p.z);
+            __m256 distance = _mm256_add_ps(_mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(nx, cx), _mm256_mul_ps(ny, cy)), _mm256_mul_ps(nz, cz)), _mm256_set1_ps(p.w));
+            __m256 r0 = _mm256_andnot_ps(signMask, _mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(nx, a[0]), _mm256_mul_ps(ny, a[1])), _mm256_mul_ps(nz, a[2])));
+            __m256 r1 = _mm256_andnot_ps(signMask, _mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(nx, a[3]), _mm256_mul_ps(ny, a[4])), _mm256_mul_ps(nz, a[5])));
+            __m256 r2 = _mm256_andnot_ps(signMask, _mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(nx, a[6]), _mm256_mul_ps(ny, a[7])), _mm256_mul_ps(nz, a[8])));
+            __m256 radius = _mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(ex, r0), _mm256_mul_ps(ey, r1)), _mm256_mul_ps(ez, r2));
+            inside = _mm256_and_ps(inside, _mm256_cmp_ps(_mm256_add_ps(distance, radius), _mm256_setzero_ps(), _CMP_NLT_UQ));
+        }
+
+        int bits = _mm256_movemask_ps(inside);
+        for (int lane = 0; lane < 8; lane++) {
+            visible[i + lane] = (bits >> lane) & 1;
+        }
+        count += __builtin_popcount(bits);
+    }
+
+    return count + cullScalar(frustum, boxes, visible, i, n);
+}
+
+static bool hasAVX2() {
+    static const bool supported = __builtin_cpu_supports("avx2");
+    return supported;
+}
+#endif
+
+// === Dispatch ===
+static CullKernel resolveKernel(CullKernel kernel) {
+    if (kernel != CullKernel::Auto) return kernel;
+    if (hasCullKernel(CullKernel::AVX2)) return CullKernel::AVX2;
+    if (hasCullKernel(CullKernel::SSE)) return CullKernel::SSE;
+    return CullKernel::Scalar;
+}
+
+size_t cullOBBs(const Frustum& frustum, const OBBArray& boxes, std::vector<unsigned char>& visible, CullKernel kernel) {
+    visible.resize(boxes.size());
+    if (boxes.size() == 0) return 0;
+
+    // A kernel the CPU lacks falls back to the scalar one
+    switch (hasCullKernel(kernel) ? resolveKernel(kernel) : CullKernel::Scalar) {
+#if FRUSTUM_AVX2
+    case CullKernel::AVX2:
+        return cullAVX2(frustum, boxes, visible.data());
+#endif
+#if FRUSTUM_SSE
+    case CullKernel::SSE:
+        return cullSSE(frustum, boxes, visible.data());
+#endif
+    default:
+        return cullScalar(frustum, boxes, visible.data(), 0, boxes.size());
+    }
+}
+
+bool hasCullKernel(CullKernel kernel) {
+    switch (kernel) {
+    case CullKernel::Auto:
+    case CullKernel::Scalar:
+        return true;
+    case CullKernel::SSE:
+#if FRUSTUM_SSE
+        return true;
+#else
+        return false;
+#endif
+    case CullKernel::AVX2:
+#if FRUSTUM_AVX2
+        return hasAVX2();
+#else
+        return false;
+#endif
+    }
+    return false;
+}
+
+const char* getCullKernelName(CullKernel kernel) {
+    switch (hasCullKernel(kernel) ? resolveKernel(kernel) : CullKernel::Scalar) {
+    case CullKernel::AVX2:
+        return "AVX2";
+    case CullKernel::SSE:
+        return "SSE";
+    default:
+        return "scalar";
+    }
+}
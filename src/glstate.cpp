@@ -0,0 +1,276 @@
+#include <glad/glad.h>
+
+#include "glstate.hpp"
+
+// === Constants ===
+static const unsigned int UNKNOWN = 0xFFFFFFFFu; // Not a name or enum GL hands out
+static const GLenum TEXTURE_TARGETS[] = {GL_TEXTURE_2D, GL_TEXTURE_BUFFER};
+static const GLenum BUFFER_TARGETS[] = {GL_ARRAY_BUFFER, GL_DRAW_INDIRECT_BUFFER, GL_PARAMETER_BUFFER, GL_COPY_READ_BUFFER,
+                                        GL_COPY_WRITE_BUFFER, GL_TEXTURE_BUFFER, GL_SHADER_STORAGE_BUFFER, GL_UNIFORM_BUFFER};
+static const GLenum CAPABILITIES[] = {GL_DEPTH_TEST, GL_BLEND, GL_CULL_FACE, GL_SCISSOR_TEST};
+
+// ### GLStateStats functions ###
+GLCallCounts GLStateStats::getTotal() const {
+    GLCallCounts total;
+    for (const GLCallCounts* counts : {&programs, &vertexArrays, &textures, &buffers, &framebuffers, &fixedFunction}) {
+        total.issued += counts->issued;
+        total.filtered += counts->filtered;
+    }
+    return total;
+}
+
+// ### GLState functions ###
+// === Singleton access ===
+GLState& GLState::get() {
+    static GLState instance;
+    return instance;
+}
+
+// === Constructor ===
+GLState::GLState() {
+    // Whatever the context holds is unknown until set through here
+    invalidate();
+}
+
+// === Bindings ===
+void GLState::useProgram(unsigned int id) {
+    if (filter(program == id, frameStats.programs)) return;
+    program = id;
+    glUseProgram(id);
+}
+
+void GLState::bindVertexArray(unsigned int id) {
+    if (filter(vertexArray == id, frameStats.vertexArrays)) return;
+    vertexArray = id;
+    glBindVertexArray(id);
+}
+
+void GLState::bindTexture(int unit, unsigned int target, unsigned int texture) {
+    int index = getTextureTarget(target);
+    bool tracked = index >= 0 && unit >= 0 && unit < MAX_TEXTURE_UNITS;
+    if (filter(tracked && textures[unit][index] == texture, frameStats.textures)) return;
+
+    setActiveUnit(unit);
+    if (tracked) textures[unit][index] = texture;
+    glBindTexture(target, texture);
+}
+
+void GLState::bindBuffer(unsigned int target, unsigned int buffer) {
+    int index = getBufferTarget(target);
+    if (filter(index >= 0 && buffers[index] == buffer, frameStats.buffers)) return;
+    if (index >= 0) buffers[index] = buffer;
+    glBindBuffer(target, buffer);
+}
+
+void GLState::bindBufferBase(unsigned int target, unsigned int index, unsigned int buffer) {
+    // The whole buffer, whatever its size, so it never matches a range binding
+    IndexedBinding* binding = getIndexedBinding(target, index);
+    bool unchanged = binding && binding->buffer == buffer && binding->offset == 0 && binding->size == 0;
+    if (filter(unchanged, frameStats.buffers)) return;
+
+    // Indexed binds also set the generic binding
+    if (binding) *binding = {buffer, 0, 0};
+    int generic = getBufferTarget(target);
+    if (generic >= 0) buffers[generic] = buffer;
+    glBindBufferBase(target, index, buffer);
+}
+
+void GLState::bindBufferRange(unsigned int target, unsigned int index, unsigned int buffer, size_t offset, size_t size) {
+    IndexedBinding* binding = getIndexedBinding(target, index);
+    bool unchanged = binding && binding->buffer == buffer && binding->offset == offset && binding->size == size;
+    if (filter(unchanged, frameStats.buffers)) return;
+
+    if (binding) *binding = {buffer, offset, size};
+    int generic = getBufferTarget(target);
+    if (generic >= 0) buffers[generic] = buffer;
+    glBindBufferRange(target, index, buffer, static_cast<GLintptr>(offset), static_cast<GLsizeiptr>(size));
+}
+
+void GLState::bindFramebuffer(unsigned int target, unsigned int framebuffer) {
+    bool draw = target == GL_FRAMEBUFFER || target == GL_DRAW_FRAMEBUFFER;
+    bool read = target == GL_FRAMEBUFFER || target == GL_READ_FRAMEBUFFER;
+    bool unchanged = (!draw || drawFramebuffer == framebuffer) && (!read || readFramebuffer == framebuffer);
+    if (filter(unchanged, frameStats.framebuffers)) return;
+
+    if (draw) drawFramebuffer = framebuffer;
+    if (read) readFramebuffer = framebuffer;
+    glBindFramebuffer(target, framebuffer);
+}
+
+// === Fixed-function state ===
+void GLState::setEnabled(unsigned int capability, bool enabled) {
+    int index = getCapability(capability);
+    if (filter(index >= 0 && capabilities[index] == static_cast<int>(enabled), frameStats.fixedFunction)) return;
+    if (index >= 0) capabilities[index] = enabled;
+    if (enabled) {
+        glEnable(capability);
+    } else {
+        glDisable(capability);
+    }
+}
+
+bool GLState::isEnabled(unsigned int capability) const {
+    int index = getCapability(capability);
+    if (index >= 0 && capabilities[index] >= 0) return capabilities[index] != 0;
+    return glIsEnabled(capability);
+}
+
+void GLState::setDepthFunc(unsigned int func) {
+    if (filter(depthFunc == func, frameStats.fixedFunction)) return;
+    depthFunc = func;
+    glDepthFunc(func);
+}
+
+void GLState::setDepthMask(bool enabled) {
+    if (filter(depthMask == static_cast<int>(enabled), frameStats.fixedFunction)) return;
+    depthMask = enabled;
+    glDepthMask(enabled ? GL_TRUE : GL_FALSE);
+}
+
+void GLState::setColorMask(bool enabled) {
+    if (filter(colorMask == static_cast<int>(enabled), frameStats.fixedFunction)) return;
+    colorMask = enabled;
+    GLboolean mask = enabled ? GL_TRUE : GL_FALSE;
+    glColorMask(mask, mask, mask, mask);
+}
+
+void GLState::setBlendFunc(unsigned int source, unsigned int destination) {
+    if (filter(blendSource == source && blendDestination == destination, frameStats.fixedFunction)) return;
+    blendSource = source;
+    blendDestination = destination;
+    glBlendFunc(source, destination);
+}
+
+// === Deletion ===
+void GLState::deleteProgram(unsigned int& id) {
+    if (!id) return;
+    // A deleted program stays in use until another replaces it, so it is forgotten instead
+    if (program == id) program = UNKNOWN;
+    glDeleteProgram(id);
+    id = 0;
+}
+
+void GLState::deleteVertexArray(unsigned int& id) {
+    if (!id) return;
+    if (vertexArray == id) vertexArray = 0;
+    glDeleteVertexArrays(1, &id);
+    id = 0;
+}
+
+void GLState::deleteTexture(unsigned int& id) {
+    if (!id) return;
+    for (auto& unit : textures) {
+        for (unsigned int& texture : unit) {
+            if (texture == id) texture = 0;
+        }
+    }
+    glDeleteTextures(1, &id);
+    id = 0;
+}
+
+void GLState::deleteBuffer(unsigned int& id) {
+    if (!id) return;
+    for (unsigned int& buffer : buffers) {
+        if (buffer == id) buffer = 0;
+    }
+    for (IndexedBinding* bindings : {storageBindings, uniformBindings}) {
+        for (int i = 0; i < MAX_INDEXED_BINDINGS; i++) {
+            if (bindings[i].buffer == id) bindings[i] = {0, 0, 0};
+        }
+    }
+    glDeleteBuffers(1, &id);
+    id = 0;
+}
+
+void GLState::deleteFramebuffer(unsigned int& id) {
+    if (!id) return;
+    if (drawFramebuffer == id) drawFramebuffer = 0;
+    if (readFramebuffer == id) readFramebuffer = 0;
+    glDeleteFramebuffers(1, &id);
+    id = 0;
+}
+
+// === Invalidation ===
+void GLState::invalidate() {
+    program = UNKNOWN;
+    vertexArray = UNKNOWN;
+    activeUnit = -1;
+    for (auto& unit : textures) {
+        for (unsigned int& texture : unit) {
+            texture = UNKNOWN;
+        }
+    }
+    for (unsigned int& buffer : buffers) {
+        buffer = UNKNOWN;
+    }
+    for (int i = 0; i < MAX_INDEXED_BINDINGS; i++) {
+        storageBindings[i] = {UNKNOWN, 0, 0};
+        uniformBindings[i] = {UNKNOWN, 0, 0};
+    }
+    drawFramebuffer = UNKNOWN;
+    readFramebuffer = UNKNOWN;
+    for (int& capability : capabilities) {
+        capability = -1;
+    }
+    depthFunc = UNKNOWN;
+    depthMask = -1;
+    colorMask = -1;
+    blendSource = UNKNOWN;
+    blendDestination = UNKNOWN;
+}
+
+// === Stats ===
+void GLState::endFrame() {
+    std::lock_guard<std::mutex> lock(statsMutex);
+    stats = frameStats;
+    frameStats = GLStateStats();
+}
+
+GLStateStats GLState::getStats() const {
+    std::lock_guard<std::mutex> lock(statsMutex);
+    return stats;
+}
+
+// === Internal helpers ===
+bool GLState::filter(bool unchanged, GLCallCounts& counts) {
+    if (unchanged && filtering) {
+        counts.filtered++;
+        return true;
+    }
+    counts.issued++;
+    return false;
+}
+
+void GLState::setActiveUnit(int unit) {
+    if (activeUnit == unit) return;
+    activeUnit = unit;
+    glActiveTexture(GL_TEXTURE0 + unit);
+}
+
+int GLState::getTextureTarget(unsigned int target) {
+    for (int i = 0; i < TEXTURE_TARGET_COUNT; i++) {
+        if (TEXTURE_TARGETS[i] == target) return i;
+    }
+    return -1;
+}
+
+int GLState::getBufferTarget(unsigned int target) {
+    for (int i = 0; i < BUFFER_TARGET_COUNT; i++) {
+        if (BUFFER_TARGETS[i] == target) return i;
+    }
+    return -1;
+}
+
+int GLState::getCapability(unsigned int capability) {
+    for (int i = 0; i < CAPABILITY_COUNT; i++) {
+        if (CAPABILITIES[i] == capability) return i;
+    }
+    return -1;
+}
+
+GLState::IndexedBinding* GLState::getIndexedBinding(unsigned int target, unsigned int index) {
+    if (index >= static_cast<unsigned int>(MAX_INDEXED_BINDINGS)) return nullptr;
+    if (target == GL_SHADER_STORAGE_BUFFER) return &storageBindings[index];
+    if (target == GL_UNIFORM_BUFFER) return &uniformBindings[index];
+    return nullptr;
+}
@@ -0,0 +1,259 @@
+#include <glad/glad.h>
+#include <algorithm>
+#include <cmath>
+
+#include "gpuculler.hpp"
+#include "frustum.hpp"
+#include "glstate.hpp"
+
+// === Constants ===
+static const unsigned int RUN_GROUP_SIZE = 64;    // Matches the local size of commands.glsl
+static const unsigned int HIZ_GROUP_SIZE = 8;     // Matches the local size of hiz.glsl
+static const int HIZ_UNIT = 4;                    // Past the light grid's texture units
+static const size_t COMMAND_BYTES = sizeof(DrawElementsIndirectCommand);
+
+// Storage buffer bindings shared with the compute shaders
+enum CullBinding : unsigned int {
+    INSTANCES = 0,
+    DRAWS = 1,
+    CULLED = 2,
+    STATS = 3,
+    COMMANDS = 4,
+    RUNS = 5
+};
+
+// === Support ===
+bool GpuCuller::isSupported() {
+    return GLAD_GL_VERSION_4_3;
+}
+
+// === Constructor ===
+GpuCuller::GpuCuller() {
+    // Without 4.6 empty draws stay in the command list with no instances
+    drawCount = GLAD_GL_VERSION_4_6;
+
+    cullShader = std::make_unique<Shader>("assets/shaders/compute/cull.glsl", "cull");
+    commandShader = std::make_unique<Shader>("assets/shaders/compute/commands.glsl", "commands");
+    hizShader = std::make_unique<Shader>("assets/shaders/compute/hiz.glsl", "hiz");
+
+    glGenBuffers(1, &drawBuffer);
+    glGenBuffers(1, &runBuffer);
+    glGenBuffers(1, &culledBuffer);
+    glGenBuffers(1, &commandBuffer);
+
+    for (StatsSlot& slot : statsSlots) {
+        glGenBuffers(1, &slot.buffer);
+        GLState::get().bindBuffer(GL_SHADER_STORAGE_BUFFER, slot.buffer);
+        glBufferData(GL_SHADER_STORAGE_BUFFER, 3 * sizeof(unsigned int), nullptr, GL_DYNAMIC_READ);
+    }
+    GLState::get().bindBuffer(GL_SHADER_STORAGE_BUFFER, 0);
+}
+
+// === Deconstructor ===
+GpuCuller::~GpuCuller() {
+    for (StatsSlot& slot : statsSlots) {
+        if (slot.fence) glDeleteSync(slot.fence);
+        GLState::get().deleteBuffer(slot.buffer);
+    }
+    GLState::get().deleteBuffer(drawBuffer);
+    GLState::get().deleteBuffer(runBuffer);
+    GLState::get().deleteBuffer(culledBuffer);
+    GLState::get().deleteBuffer(commandBuffer);
+    if (hizTexture) GLState::get().deleteTexture(hizTexture);
+}
+
+// === Frame ===
+void GpuCuller::cull(const CommandStream& stream, unsigned int instanceBuffer, size_t instanceOffset, const glm::mat4& viewProjection) {
+    resolveStats();
+
+    const std::vector<InstanceData>& instances = stream.getInstances();
+    const std::vector<DrawElementsIndirectCommand>& commands = stream.getDraws();
+    const std::vector<DrawBounds>& bounds = stream.getDrawBounds();
+    if (instances.empty() || commands.empty()) return;
+
+    // Draws only compact within the run they are replayed in
+    collector.runs.clear();
+    stream.replay(collector);
+
+    draws.resize(commands.size());
+    for (size_t d = 0; d < commands.size(); d++) {
+        const DrawElementsIndirectCommand& command = commands[d];
+        GpuDraw& draw = draws[d];
+        draw.boundsMin = bounds[d].min;
+        draw.boundsMax = bounds[d].max;
+        draw.count = command.count;
+        draw.firstIndex = command.firstIndex;
+        draw.baseVertex = command.baseVertex;
+        draw.baseInstance = command.baseInstance;
+        draw.instanceCount = command.instanceCount;
+        draw.visibleCount = 0;
+    }
+    runs.clear();
+    for (const Run& run : collector.runs) {
+        runs.push_back({static_cast<unsigned int>(run.first), static_cast<unsigned int>(run.count), 0, 0});
+    }
+
+    // Orphan and refill the tables, grow the outputs
+    GLState::get().bindBuffer(GL_SHADER_STORAGE_BUFFER, drawBuffer);
+    glBufferData(GL_SHADER_STORAGE_BUFFER, draws.size() * sizeof(GpuDraw), draws.data(), GL_STREAM_DRAW);
+    GLState::get().bindBuffer(GL_SHADER_STORAGE_BUFFER, runBuffer);
+    glBufferData(GL_SHADER_STORAGE_BUFFER, runs.size() * sizeof(GpuRun), runs.data(), GL_STREAM_DRAW);
+    reserve(culledBuffer, instances.size() * sizeof(InstanceData), culledCapacity);
+    reserve(commandBuffer, draws.size() * COMMAND_BYTES, commandCapacity);
+
+    // Stats start at zero
+    StatsSlot& slot = statsSlots[currentSlot];
+    GLState::get().bindBuffer(GL_SHADER_STORAGE_BUFFER, slot.buffer);
+    glClearBufferData(GL_SHADER_STORAGE_BUFFER, GL_R32UI, GL_RED_INTEGER, GL_UNSIGNED_INT, nullptr);
+    GLState::get().bindBuffer(GL_SHADER_STORAGE_BUFFER, 0);
+
+    GLState::get().bindBufferRange(GL_SHADER_STORAGE_BUFFER, INSTANCES, instanceBuffer, instanceOffset, instances.size() * sizeof(InstanceData));
+    GLState::get().bindBufferBase(GL_SHADER_STORAGE_BUFFER, DRAWS, drawBuffer);
+    GLState::get().bindBufferBase(GL_SHADER_STORAGE_BUFFER, CULLED, culledBuffer);
+    GLState::get().bindBufferBase(GL_SHADER_STORAGE_BUFFER, STATS, slot.buffer);
+    GLState::get().bindBufferBase(GL_SHADER_STORAGE_BUFFER, COMMANDS, commandBuffer);
+    GLState::get().bindBufferBase(GL_SHADER_STORAGE_BUFFER, RUNS, runBuffer);
+
+    // Instances, frustum then the previous frame's depth, one group per draw
+    Frustum frustum = Frustum::fromMatrix(viewProjection);
+    bool occlusionThisFrame = occlusion && hizValid;
+    cullShader->use();
+    for (int i = 0; i < 6; i++) {
+        cullShader->setVec4("planes[" + std::to_string(i) + "]", frustum.planes[i]);
+    }
+    cullShader->setInt("occlusion", occlusionThisFrame ? 1 : 0);
+    if (occlusionThisFrame) {
+        GLState::get().bindTexture(HIZ_UNIT, GL_TEXTURE_2D, hizTexture);
+        cullShader->setInt("hiz", HIZ_UNIT);
+        cullShader->setIVec2("hizSize", glm::ivec2(hizWidth, hizHeight));
+        cullShader->setInt("hizLevels", hizLevels);
+        cullShader->setMat4("previousViewProjection", hizViewProjection);
+    }
+    glDispatchCompute(static_cast<unsigned int>(draws.size()), 1, 1);
+    glMemoryBarrier(GL_SHADER_STORAGE_BARRIER_BIT);
+
+    // Commands, one invocation per run keeps the draws in order
+    commandShader->use();
+    commandShader->setInt("runCount", static_cast<int>(runs.size()));
+    commandShader->setInt("compact", drawCount ? 1 : 0);
+    glDispatchCompute((static_cast<unsigned int>(runs.size()) + RUN_GROUP_SIZE - 1) / RUN_GROUP_SIZE, 1, 1);
+
+    // Commands, run counts and instances are read by the draws, stats by the readback
+    glMemoryBarrier(GL_COMMAND_BARRIER_BIT | GL_VERTEX_ATTRIB_ARRAY_BARRIER_BIT | GL_BUFFER_UPDATE_BARRIER_BIT);
+    GLState::get().useProgram(0);
+
+    slot.instances = instances.size();
+    slot.fence = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+    currentSlot = (currentSlot + 1) % STATS_FRAMES;
+}
+
+size_t GpuCuller::draw(size_t firstCommand, size_t commandCount) const {
+    GLState::get().bindBuffer(GL_DRAW_INDIRECT_BUFFER, commandBuffer);
+    if (!drawCount) {
+        glMultiDrawElementsIndirect(GL_TRIANGLES, GL_UNSIGNED_INT, (const void*)(firstCommand * COMMAND_BYTES), (GLsizei)commandCount, 0);
+        return 1;
+    }
+
+    // Compacted commands only make sense per run, callers pass whole runs
+    GLState::get().bindBuffer(GL_PARAMETER_BUFFER, runBuffer);
+    auto it = std::lower_bound(collector.runs.begin(), collector.runs.end(), firstCommand,
+        [](const Run& run, size_t first) {return run.first < first;});
+    size_t drawCalls = 0;
+    for (; it != collector.runs.end() && it->first < firstCommand + commandCount; ++it) {
+        size_t runIndex = it - collector.runs.begin();
+        glMultiDrawElementsIndirectCount(GL_TRIANGLES, GL_UNSIGNED_INT, (const void*)(it->first * COMMAND_BYTES),
+            (GLintptr)(runIndex * sizeof(GpuRun) + offsetof(GpuRun, drawCount)), (GLsizei)it->count, 0);
+        drawCalls++;
+    }
+    GLState::get().bindBuffer(GL_PARAMETER_BUFFER, 0);
+    return drawCalls;
+}
+
+void GpuCuller::buildHiZ(unsigned int depthTexture, int width, int height, const glm::mat4& viewProjection) {
+    // Power-of-two levels, so every texel of a level covers exactly four of the one above
+    int pyramidWidth = 1 << static_cast<int>(std::floor(std::log2(std::max(width, 1))));
+    int pyramidHeight = 1 << static_cast<int>(std::floor(std::log2(std::max(height, 1))));
+    if (!hizTexture || pyramidWidth != hizWidth || pyramidHeight != hizHeight) {
+        if (hizTexture) GLState::get().deleteTexture(hizTexture);
+        hizWidth = pyramidWidth;
+        hizHeight = pyramidHeight;
+        hizLevels = static_cast<int>(std::log2(std::max(hizWidth, hizHeight))) + 1;
+
+        glGenTextures(1, &hizTexture);
+        GLState::get().bindTexture(HIZ_UNIT, GL_TEXTURE_2D, hizTexture);
+        glTexStorage2D(GL_TEXTURE_2D, hizLevels, GL_R32F, hizWidth, hizHeight);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST_MIPMAP_NEAREST);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+    }
+
+    hizShader->use();
+    hizShader->setInt("source", HIZ_UNIT);
+
+    // Level 0 reduces the depth buffer, the rest halve the level above
+    glm::ivec2 sourceSize(width, height);
+    for (int level = 0; level < hizLevels; level++) {
+        glm::ivec2 size(std::max(hizWidth >> level, 1), std::max(hizHeight >> level, 1));
+        GLState::get().bindTexture(HIZ_UNIT, GL_TEXTURE_2D, level == 0 ? depthTexture : hizTexture);
+        glBindImageTexture(0, hizTexture, level, GL_FALSE, 0, GL_WRITE_ONLY, GL_R32F);
+        hizShader->setInt("sourceLevel", level == 0 ? 0 : level - 1);
+        hizShader->setIVec2("sourceSize", sourceSize);
+        hizShader->setIVec2("destinationSize", size);
+        glDispatchCompute((size.x + HIZ_GROUP_SIZE - 1) / HIZ_GROUP_SIZE, (size.y + HIZ_GROUP_SIZE - 1) / HIZ_GROUP_SIZE, 1);
+        glMemoryBarrier(GL_TEXTURE_FETCH_BARRIER_BIT | GL_SHADER_IMAGE_ACCESS_BARRIER_BIT);
+        sourceSize = size;
+    }
+
+    glBindImageTexture(0, 0, 0, GL_FALSE, 0, GL_WRITE_ONLY, GL_R32F);
+    GLState::get().useProgram(0);
+
+    hizValid = true;
+    hizViewProjection = viewProjection;
+}
+
+// === Stats ===
+GpuCullStats GpuCuller::getStats() const {
+    std::lock_guard<std::mutex> lock(statsMutex);
+    return stats;
+}
+
+// === Internal helpers ===
+void GpuCuller::resolveStats() {
+    // Oldest pending slot first, stop at the first one still in flight
+    for (int i = 0; i < STATS_FRAMES; i++) {
+        StatsSlot& slot = statsSlots[(currentSlot + i) % STATS_FRAMES];
+        if (!slot.fence) continue;
+
+        GLenum status = glClientWaitSync(slot.fence, 0, 0);
+        if (status == GL_TIMEOUT_EXPIRED) break;
+        glDeleteSync(slot.fence);
+        slot.fence = nullptr;
+
+        unsigned int counters[3] = {};
+        GLState::get().bindBuffer(GL_COPY_READ_BUFFER, slot.buffer);
+        glGetBufferSubData(GL_COPY_READ_BUFFER, 0, sizeof(counters), counters);
+        GLState::get().bindBuffer(GL_COPY_READ_BUFFER, 0);
+
+        std::lock_guard<std::mutex> lock(statsMutex);
+        stats.instances = slot.instances;
+        stats.visible = counters[0];
+        stats.frustumCulled = counters[1];
+        stats.occluded = counters[2];
+    }
+
+    // A slot the GPU still owns is dropped rather than waited on
+    StatsSlot& slot = statsSlots[currentSlot];
+    if (slot.fence) {
+        glDeleteSync(slot.fence);
+        slot.fence = nullptr;
+    }
+}
+
+void GpuCuller::reserve(unsigned int buffer, size_t bytes, size_t& capacity) {
+    if (bytes <= capacity) return;
+    capacity = std::max(bytes, capacity * 2);
+    GLState::get().bindBuffer(GL_SHADER_STORAGE_BUFFER, buffer);
+    glBufferData(GL_SHADER_STORAGE_BUFFER, capacity, nullptr, GL_DYNAMIC_COPY);
+    GLState::get().bindBuffer(GL_SHADER_STORAGE_BUFFER, 0);
+}
@@ -7,6 +7,19 @@
 #include "mode.hpp"
 #include "object.hpp"
 #include "mesh.hpp"
+#include "profiler.hpp"
+#include "texturestreamer.hpp"
+#include "glstate.hpp"
+#include "hierarchyview.hpp"
+
+// === Window state ===
+static bool showProfiler = false;
+static bool showRenderGraph = false;
+
+// === Hierarchy state ===
+static HierarchyView hierarchy;
+static const Object* listedSelection = nullptr;
+static char parentFilter[128] = "";
 
 // === Constructor ===
 Gui::Gui(Window& window) {
@@ -20,6 +33,9 @@ Gui::Gui(Window& window) {
     ImGui_ImplGlfw_InitForOpenGL(window.getGLFWwindow(), false);
     ImGui_ImplOpenGL3_Init("#version 330");
     ImGui::StyleColorsDark();
+
+    // Font texture and programs up front, frames are drawn on the render thread
+    ImGui_ImplOpenGL3_CreateDeviceObjects();
 }
 
 // === Shutdown ===
@@ -31,14 +47,13 @@ void Gui::shutdown() {
 
 // === Frame lifecycle ===
 void Gui::beginFrame() {
-    ImGui_ImplOpenGL3_NewFrame();
     ImGui_ImplGlfw_NewFrame();
     ImGui::NewFrame();
 }
 
-void Gui::endFrame() {
+void Gui::endFrame(GuiSnapshot& snapshot) {
     ImGui::Render();
-    ImGui_ImplOpenGL3_RenderDrawData(ImGui::GetDrawData());
+    snapshot.capture(ImGui::GetDrawData());
 }
 
 // === Input syncing ===
@@ -71,7 +86,7 @@ void Gui::syncKeyboardFromGLFW(GLFWwindow* window) {
 }
 
 // === Rendering ===
-void Gui::drawMainMenu(Window& window, Scene& scene, std::unique_ptr<Scene>& playScene, Camera& camera, Camera& playCamera, Mode& mode) {
+void Gui::drawMainMenu(Window& window, Scene& scene, Renderer& renderer, std::unique_ptr<Scene>& playScene, Camera& camera, Camera& playCamera, Mode& mode) {
     static bool openLoadScenePopup = false;
     static bool openSaveScenePopup = false;
 
@@ -105,7 +120,7 @@ void Gui::drawMainMenu(Window& window, Scene& scene, std::unique_ptr<Scene>& pla
         if (ImGui::BeginMenu("Edit")) {
             if (ImGui::MenuItem("New Object", "C")) {
                 std::string objName = "NewObj" + std::to_string(scene.getObjectCount());
-                scene.addObject(objName, std::make_unique<Object>(objName, "cube", "default.jpg", "default"));
+                scene.addObject(objName, scene.createObject(objName, "cube", "default.jpg", "default"));
                 scene.selectObject(objName);
             }
             if (ImGui::MenuItem("Undo")) {
@@ -150,6 +165,7 @@ void Gui::drawMainMenu(Window& window, Scene& scene, std::unique_ptr<Scene>& pla
                     mode = Mode::Playtest;
                     playScene = std::make_unique<Scene>(scene);
                     playScene->clearSelection();
+                    playScene->buildStaticBatches();
                     for (auto& obj : playScene->getObjects()) {
                         if (obj->isPlayer) {
                             playCamera.position = obj->transform.position;
@@ -163,6 +179,107 @@ void Gui::drawMainMenu(Window& window, Scene& scene, std::unique_ptr<Scene>& pla
             ImGui::EndMenu();
         }
 
+        // View Menu
+        if (ImGui::BeginMenu("View")) {
+            bool occlusionCulling = scene.getOcclusionCulling();
+            if (ImGui::MenuItem("Occlusion Culling", nullptr, &occlusionCulling)) {
+                scene.setOcclusionCulling(occlusionCulling);
+                if (GpuCuller* culler = renderer.getGpuCuller()) culler->setOcclusion(occlusionCulling);
+            }
+            if (renderer.supportsGpuCulling()) {
+                bool gpuCulling = scene.getGpuCulling();
+                if (ImGui::MenuItem("GPU Culling", nullptr, &gpuCulling)) {
+                    scene.setGpuCulling(gpuCulling);
+                }
+            }
+            bool depthPrepass = renderer.getDepthPrepass();
+            if (ImGui::MenuItem("Depth Pre-pass", nullptr, &depthPrepass)) {
+                renderer.setDepthPrepass(depthPrepass);
+            }
+            ImGui::MenuItem("Profiler", nullptr, &showProfiler);
+            ImGui::MenuItem("Render Graph", nullptr, &showRenderGraph);
+
+            // Scene resolution, applied by the render thread from its next frame
+            if (ImGui::BeginMenu("Dynamic Resolution")) {
+                DynamicResolution& resolution = RenderThread::get().getResolution();
+                bool enabled = resolution.isEnabled();
+                if (ImGui::MenuItem("Enabled", nullptr, &enabled)) {
+                    resolution.setEnabled(enabled);
+                }
+                float targetMs = resolution.getTargetMs();
+                if (ImGui::SliderFloat("Target GPU ms", &targetMs, 4.0f, 33.3f, "%.1f")) {
+                    resolution.setTargetMs(targetMs);
+                }
+                float sharpness = resolution.getSharpness();
+                if (ImGui::SliderFloat("Sharpness", &sharpness, 0.0f, 1.0f, "%.2f")) {
+                    resolution.setSharpness(sharpness);
+                }
+                ImGui::Text("Scale: %.0f%% at %.2f ms", resolution.getScale() * 100.0f, resolution.getGpuMs());
+                ImGui::EndMenu();
+            }
+
+            // Texture streaming, budgets apply from the render thread's next update
+            if (ImGui::BeginMenu("Texture Streaming")) {
+                TextureStreamer& streamer = TextureStreamer::get();
+                int uploadKb = static_cast<int>(streamer.getUploadBudget() / 1024);
+                if (ImGui::SliderInt("Upload KB/frame", &uploadKb, 64, 16384)) {
+                    streamer.setUploadBudget(static_cast<size_t>(uploadKb) * 1024);
+                }
+                int memoryMb = static_cast<int>(streamer.getMemoryBudget() / 1048576);
+                if (ImGui::SliderInt("Memory MB", &memoryMb, 1, 1024)) {
+                    streamer.setMemoryBudget(static_cast<size_t>(memoryMb) * 1048576);
+                }
+                TextureStreamStats stats = streamer.getStats();
+                ImGui::Text("Resident: %.2f / %.2f MB in %zu textures", stats.residentBytes / 1048576.0, stats.fullBytes / 1048576.0, stats.textures);
+                ImGui::Text("Last frame: %zu uploads (%.1f KB), %zu drops, %zu pending", stats.uploads, stats.uploadedBytes / 1024.0, stats.drops, stats.pending);
+                ImGui::EndMenu();
+            }
+
+            // Frame pacing, the game thread follows it from its next frame
+            if (ImGui::BeginMenu("Frame Pacing")) {
+                FramePacer& pacer = RenderThread::get().getPacer();
+                PacingMode pacing = pacer.getMode();
+                if (ImGui::MenuItem("VSync", nullptr, pacing == PacingMode::VSync)) {
+                    pacer.setMode(PacingMode::VSync);
+                }
+                if (ImGui::MenuItem("Capped", nullptr, pacing == PacingMode::Capped)) {
+                    pacer.setMode(PacingMode::Capped);
+                }
+                if (ImGui::MenuItem("Low Latency", nullptr, pacing == PacingMode::LowLatency)) {
+                    pacer.setMode(PacingMode::LowLatency);
+                }
+                float capHz = pacer.getCapHz();
+                if (ImGui::SliderFloat("Cap Hz", &capHz, 30.0f, 360.0f, "%.0f")) {
+                    pacer.setCapHz(capHz);
+                }
+                ImGui::Text("Refresh: %.0f Hz", pacer.getRefreshHz());
+                if (pacing == PacingMode::LowLatency) {
+                    ImGui::Text("Predicted cost: %.2f ms", pacer.getPredictedCostMs());
+                }
+                ImGui::EndMenu();
+            }
+            ImGui::EndMenu();
+        }
+
+        // Culling counter
+        ImGui::SetCursorPosX(ImGui::GetWindowWidth() - 660.0f);
+        if (scene.getGpuCulling() && renderer.supportsGpuCulling()) {
+            // Instances rather than objects, read back from the GPU a few frames late
+            GpuCullStats gpuStats = renderer.getGpuCuller()->getStats();
+            ImGui::Text("Drawn: %zu / %zu (%zu occluded, GPU)", gpuStats.visible, gpuStats.instances, gpuStats.occluded);
+        } else {
+            const CullStats& cullStats = scene.getCullStats();
+            ImGui::Text("Drawn: %zu / %zu (%zu occluded)", cullStats.visible, cullStats.visible + cullStats.culled + cullStats.occluded, cullStats.occluded);
+        }
+
+        // Input-to-swap latency, averaged over recent frames
+        ImGui::SetCursorPosX(ImGui::GetWindowWidth() - 390.0f);
+        ImGui::Text("Latency: %.1f ms", RenderThread::get().getPacer().getAverageLatencyMs());
+
+        // Overdraw counter
+        ImGui::SetCursorPosX(ImGui::GetWindowWidth() - 220.0f);
+        ImGui::Text("Overdraw: %.2fx", renderer.getOverdraw());
+
         // FPS counter
         ImGui::SetCursorPosX(ImGui::GetWindowWidth() - 100.0f);
         ImGui::Text("FPS: %.1f", ImGui::GetIO().Framerate);
@@ -192,40 +309,58 @@ void Gui::drawSidebar(Scene& scene) {
     ImGui::SetNextWindowPos(ImVec2(0, 20));
     ImGui::SetNextWindowSize(ImVec2(200, ImGui::GetIO().DisplaySize.y - 20));
     ImGui::Begin("Objects", nullptr, ImGuiWindowFlags_NoResize | ImGuiWindowFlags_NoMove);
-
-    for (auto& obj : scene.getObjects()) {
-        if (obj->parent == nullptr) {  // Only draw root objects
-            drawObjectTree(*obj, scene);
+    hierarchy.sync(scene);
+
+    // Objects selected elsewhere, like in the viewport, are expanded to and scrolled into view
+    Object* selected = scene.getSelectedObject();
+    if (selected != listedSelection) {
+        listedSelection = selected;
+        if (selected) {
+            float rowHeight = ImGui::GetTextLineHeightWithSpacing();
+            float y = hierarchy.reveal(selected) * rowHeight;
+            if (y < ImGui::GetScrollY() || y + rowHeight > ImGui::GetScrollY() + ImGui::GetContentRegionAvail().y) {
+                ImGui::SetScrollY(y - ImGui::GetContentRegionAvail().y * 0.5f);
+            }
         }
     }
 
-    ImGui::End();
-}
-
-void Gui::drawObjectTree(Object& obj, Scene& scene) {
-    ImGuiTreeNodeFlags flags = ImGuiTreeNodeFlags_OpenOnArrow | ImGuiTreeNodeFlags_SpanAvailWidth;
-    if (scene.getSelectedObject() == &obj) {
-        flags |= ImGuiTreeNodeFlags_Selected;
-    }
-
-    bool nodeOpen = false;
-    if (!obj.children.empty()) {
-        nodeOpen = ImGui::TreeNodeEx(obj.name.c_str(), flags);
-    } else {
-        flags |= ImGuiTreeNodeFlags_Leaf | ImGuiTreeNodeFlags_NoTreePushOnOpen;
-        ImGui::TreeNodeEx(obj.name.c_str(), flags);
-    }
+    // Only the rows on screen are drawn, opening or closing one is applied after the loop
+    const std::vector<HierarchyRow>& rows = hierarchy.getRows();
+    size_t toggledRow = rows.size();
+    bool toggledOpen = false;
+    ImGuiListClipper clipper;
+    clipper.Begin(static_cast<int>(rows.size()));
+    while (clipper.Step()) {
+        for (int i = clipper.DisplayStart; i < clipper.DisplayEnd; i++) {
+            Object& obj = *rows[i].object;
+            ImGuiTreeNodeFlags flags = ImGuiTreeNodeFlags_OpenOnArrow | ImGuiTreeNodeFlags_SpanAvailWidth | ImGuiTreeNodeFlags_NoTreePushOnOpen;
+            if (selected == &obj) {
+                flags |= ImGuiTreeNodeFlags_Selected;
+            }
 
-    if (ImGui::IsItemClicked()) {
-        scene.selectObject(obj.name);
-    }
+            float indent = rows[i].depth * ImGui::GetStyle().IndentSpacing;
+            if (indent > 0.0f) ImGui::Indent(indent);
+            if (!obj.children.empty()) {
+                bool expanded = hierarchy.isExpanded(&obj);
+                ImGui::SetNextItemOpen(expanded);
+                if (ImGui::TreeNodeEx(&obj, flags, "%s", obj.name.c_str()) != expanded) {
+                    toggledRow = i;
+                    toggledOpen = !expanded;
+                }
+            } else {
+                ImGui::TreeNodeEx(&obj, flags | ImGuiTreeNodeFlags_Leaf, "%s", obj.name.c_str());
+            }
+            if (indent > 0.0f) ImGui::Unindent(indent);
 
-    if (nodeOpen) {
-        for (Object* child : obj.children) {
-            drawObjectTree(*child, scene);  // Recursive call
+            if (ImGui::IsItemClicked()) {
+                scene.selectObject(obj.name);
+                listedSelection = &obj;
+            }
         }
-        ImGui::TreePop();
     }
+    hierarchy.setExpanded(toggledRow, toggledOpen);
+
+    ImGui::End();
 }
 
 void Gui::drawObjectProperties(Scene& scene, Object* selected) {
@@ -245,33 +380,39 @@ void Gui::drawObjectProperties(Scene& scene, Object* selected) {
         }
 
         // Transform controls
-        ImGui::DragFloat3("Position", glm::value_ptr(selected->transform.position), 0.1f);
-        ImGui::DragFloat3("Rotation", glm::value_ptr(selected->transform.rotation), 0.1f);
-        ImGui::DragFloat3("Scale",    glm::value_ptr(selected->transform.scale),    0.1f);
-        selected->transform.markDirty();
+        bool moved = ImGui::DragFloat3("Position", glm::value_ptr(selected->transform.position), 0.1f);
+        moved |= ImGui::DragFloat3("Rotation", glm::value_ptr(selected->transform.rotation), 0.1f);
+        moved |= ImGui::DragFloat3("Scale",    glm::value_ptr(selected->transform.scale),    0.1f);
+        if (moved) selected->markDirty();
 
         // Parent selector
         std::string currentParentName = selected->parent ? selected->parent->name : "None";
-        if (ImGui::BeginCombo("Parent", currentParentName.c_str())) {
+        if (ImGui::BeginCombo("Parent", currentParentName.c_str(), ImGuiComboFlags_HeightLarge)) {
+            // Search box, cleared and focused every time the list opens
+            if (ImGui::IsWindowAppearing()) {
+                parentFilter[0] = '\0';
+                ImGui::SetKeyboardFocusHere();
+            }
+            ImGui::InputTextWithHint("##ParentFilter", "Search", parentFilter, sizeof(parentFilter));
+
             // Option to clear the parent
             if (ImGui::Selectable("None", selected->parent == nullptr)) {
-                // Detach from current parent
-                if (selected->parent) {
-                    auto& siblings = selected->parent->children;
-                    siblings.erase(std::remove(siblings.begin(), siblings.end(), selected), siblings.end());
-                    selected->parent = nullptr;
-                }
+                scene.setParent(selected, nullptr);
             }
 
-            // List all other objects as potential parents
-            for (Object* potentialParent : scene.getObjects()) {
-                if (potentialParent == selected) continue;
-
-                if (selected->isDescendant(potentialParent)) continue;
-
-                bool isSelected = (selected->parent == potentialParent);
-                if (ImGui::Selectable(potentialParent->name.c_str(), isSelected)) {
-                    selected->setParent(potentialParent);
+            // Objects that can take it, filtered once per change and clipped to the visible ones
+            hierarchy.sync(scene);
+            const std::vector<Object*>& candidates = hierarchy.getParentCandidates(selected, parentFilter);
+            ImGuiListClipper clipper;
+            clipper.Begin(static_cast<int>(candidates.size()));
+            while (clipper.Step()) {
+                for (int i = clipper.DisplayStart; i < clipper.DisplayEnd; i++) {
+                    Object* potentialParent = candidates[i];
+                    ImGui::PushID(potentialParent);
+                    if (ImGui::Selectable(potentialParent->name.c_str(), selected->parent == potentialParent)) {
+                        scene.setParent(selected, potentialParent);
+                    }
+                    ImGui::PopID();
                 }
             }
 
@@ -289,6 +430,7 @@ void Gui::drawObjectProperties(Scene& scene, Object* selected) {
                 if (ImGui::Selectable(meshName.c_str(), isSelected)) {
                     selected->mesh = mesh;
                     selected->initializeOBB(mesh->getMinBounds(), mesh->getMaxBounds());
+                    selected->markDirty(); // Refit the bounds around the new mesh
                 }
                 if (isSelected) {
                     ImGui::SetItemDefaultFocus();
@@ -297,15 +439,14 @@ void Gui::drawObjectProperties(Scene& scene, Object* selected) {
             ImGui::EndCombo();
         }
 
-        // Shader selector
-        std::string currentShader = selected->shader ? selected->shader->getName() : "None";
+        // Material selector, every object with the same material changes with it
+        std::string currentMaterial = selected->material ? selected->material->getName() : "None";
 
-        if (ImGui::BeginCombo("Shader", currentShader.c_str())) {
-            auto shaderNames = scene.getShaderNames();
-            for (const auto& shaderName : shaderNames) {
-                bool isSelected = (shaderName == currentShader);
-                if (ImGui::Selectable(shaderName.c_str(), isSelected)) {
-                    selected->shader = scene.getShader(shaderName);
+        if (ImGui::BeginCombo("Material", currentMaterial.c_str())) {
+            for (const std::shared_ptr<Material>& material : scene.getMaterials()) {
+                bool isSelected = (selected->material == material);
+                if (ImGui::Selectable(material->getName().c_str(), isSelected)) {
+                    selected->material = material;
                 }
                 if (isSelected) {
                     ImGui::SetItemDefaultFocus();
@@ -314,26 +455,71 @@ void Gui::drawObjectProperties(Scene& scene, Object* selected) {
             ImGui::EndCombo();
         }
 
-        // Texture selector
-        std::string currentTextureName = selected->texture ? selected->texture->getName() : "None";
+        if (selected->material) {
+            Material& material = *selected->material;
 
-        if (ImGui::BeginCombo("Texture", currentTextureName.c_str())) {
-            auto textures = scene.getTextures();
-            for (Texture* tex : textures) {
-                const std::string& texName = tex->getName();
-                bool isSelected = (selected->texture == tex);
-                ImGui::PushID(texName.c_str());
-                ImGui::Image(tex->getID(), ImVec2(16, 16));
+            // Only objects and the library hold materials, and no play scene exists while editing
+            bool inLibrary = scene.getMaterial(material.getName()) == selected->material;
+            size_t users = static_cast<size_t>(selected->material.use_count()) - (inLibrary ? 1 : 0);
+            ImGui::TextDisabled("Shared by %zu object%s", users, users == 1 ? "" : "s");
+            if (users > 1) {
                 ImGui::SameLine();
-                if (ImGui::Selectable(texName.c_str(), isSelected)) {
-                    selected->texture = tex;
+                if (ImGui::SmallButton("Make Unique")) {
+                    selected->material = scene.duplicateMaterial(material);
                 }
-                if (isSelected) {
-                    ImGui::SetItemDefaultFocus();
+            }
+        }
+
+        if (selected->material) {
+            Material& material = *selected->material;
+
+            // Shader selector
+            std::string currentShader = material.getShader() ? material.getShader()->getName() : "None";
+
+            if (ImGui::BeginCombo("Shader", currentShader.c_str())) {
+                auto shaderNames = scene.getShaderNames();
+                for (const auto& shaderName : shaderNames) {
+                    bool isSelected = (shaderName == currentShader);
+                    if (ImGui::Selectable(shaderName.c_str(), isSelected)) {
+                        material.setShader(scene.getShader(shaderName));
+                    }
+                    if (isSelected) {
+                        ImGui::SetItemDefaultFocus();
+                    }
                 }
-                ImGui::PopID();
+                ImGui::EndCombo();
+            }
+
+            // Texture selector
+            std::string currentTextureName = material.getTexture() ? material.getTexture()->getName() : "None";
+
+            if (ImGui::BeginCombo("Texture", currentTextureName.c_str())) {
+                auto textures = scene.getTextures();
+                for (Texture* tex : textures) {
+                    const std::string& texName = tex->getName();
+                    bool isSelected = (material.getTexture() == tex);
+                    ImGui::PushID(texName.c_str());
+                    ImGui::Image(tex->getID(), ImVec2(16, 16));
+                    ImGui::SameLine();
+                    if (ImGui::Selectable(texName.c_str(), isSelected)) {
+                        material.setTexture(tex);
+                    }
+                    if (isSelected) {
+                        ImGui::SetItemDefaultFocus();
+                    }
+                    ImGui::PopID();
+                }
+                ImGui::EndCombo();
+            }
+
+            // Constants, uploaded to the material's slot with the next frame
+            MaterialParams params = material.getParams();
+            bool changed = ImGui::ColorEdit4("Color", &params.color.r);
+            changed |= ImGui::DragFloat("Specular", &params.specularStrength, 0.01f, 0.0f, 4.0f);
+            changed |= ImGui::DragFloat("Shininess", &params.shininess, 0.5f, 1.0f, 256.0f);
+            if (changed) {
+                material.setParams(params);
             }
-            ImGui::EndCombo();
         }
 
         ImGui::Text("Texture Scale");
@@ -355,6 +541,31 @@ void Gui::drawObjectProperties(Scene& scene, Object* selected) {
             }
         }
     }
+    ImGui::Checkbox("Static", &selected->isStatic);
+
+    // Light component
+    bool hasLight = selected->light.has_value();
+    if (ImGui::Checkbox("Light", &hasLight)) {
+        if (hasLight) {
+            selected->light = Light();
+        } else {
+            selected->light.reset();
+        }
+    }
+    if (selected->light) {
+        Light& light = *selected->light;
+        int type = static_cast<int>(light.type);
+        if (ImGui::Combo("Type", &type, "Point\0Spot\0")) {
+            light.type = static_cast<LightType>(type);
+        }
+        ImGui::ColorEdit3("Color", glm::value_ptr(light.color));
+        ImGui::DragFloat("Intensity", &light.intensity, 0.05f, 0.0f, 100.0f);
+        ImGui::DragFloat("Range", &light.range, 0.1f, 0.1f, 500.0f);
+        if (light.type == LightType::Spot) {
+            ImGui::DragFloat("Inner Angle", &light.innerAngle, 0.5f, 0.0f, light.outerAngle);
+            ImGui::DragFloat("Outer Angle", &light.outerAngle, 0.5f, light.innerAngle, 89.0f);
+        }
+    }
 
     ImGui::Spacing();
     ImGui::Separator();
@@ -487,3 +698,114 @@ void Gui::drawPlaytestUI() {
     ImGui::End();
 }
 
+void Gui::drawProfiler() {
+    if (!showProfiler) return;
+
+    const ImVec2 displaySize = ImGui::GetIO().DisplaySize;
+    ImGui::SetNextWindowPos(ImVec2(displaySize.x - 370, 30), ImGuiCond_FirstUseEver);
+    ImGui::SetNextWindowSize(ImVec2(360, 560), ImGuiCond_FirstUseEver);
+    if (!ImGui::Begin("Profiler", &showProfiler)) {
+        ImGui::End();
+        return;
+    }
+
+    // Game thread records and submits, the render thread draws a frame behind
+    if (ImGui::CollapsingHeader("Game thread", ImGuiTreeNodeFlags_DefaultOpen)) {
+        drawProfilerTimeline("game", Profiler::get());
+    }
+    if (ImGui::CollapsingHeader("Render thread", ImGuiTreeNodeFlags_DefaultOpen)) {
+        drawProfilerTimeline("render", Profiler::getRender());
+    }
+    ImGui::End();
+}
+
+void Gui::drawRenderGraph() {
+    if (!showRenderGraph) return;
+
+    ImGui::SetNextWindowSize(ImVec2(460, 420), ImGuiCond_FirstUseEver);
+    if (!ImGui::Begin("Render Graph", &showRenderGraph)) {
+        ImGui::End();
+        return;
+    }
+
+    // Counters of the frame the render thread drew last
+    RenderGraph& graph = RenderThread::get().getGraph();
+    RenderGraphStats stats = graph.getStats();
+    ImGui::Text("Passes: %zu (%zu culled)", stats.passes, stats.culledPasses);
+    ImGui::Text("Transients: %zu in %zu textures", stats.transients, stats.textures);
+    ImGui::Text("State transitions: %zu", stats.transitions);
+    ImGui::Text("Memory: %.2f MB requested, %.2f MB allocated", stats.requestedBytes / 1048576.0, stats.allocatedBytes / 1048576.0);
+    ImGui::Text("Saved by aliasing: %.2f MB", (stats.requestedBytes - stats.allocatedBytes) / 1048576.0);
+
+    // State calls of the last frame, filtering is switched from here for comparison
+    GLState& state = GLState::get();
+    GLCallCounts calls = state.getStats().getTotal();
+    ImGui::Text("GL state calls: %zu issued, %zu filtered", calls.issued, calls.filtered);
+    bool filtering = state.getFiltering();
+    if (ImGui::Checkbox("Filter redundant state", &filtering)) {
+        state.setFiltering(filtering);
+    }
+
+    // The dump is built by the render thread on its next compile
+    if (ImGui::Button("Dump")) {
+        graph.requestDump();
+    }
+    std::string dump = graph.getDump();
+    if (!dump.empty()) {
+        ImGui::SameLine();
+        if (ImGui::Button("Copy")) {
+            ImGui::SetClipboardText(dump.c_str());
+        }
+        ImGui::BeginChild("Dump", ImVec2(0, 0), ImGuiChildFlags_Borders, ImGuiWindowFlags_HorizontalScrollbar);
+        ImGui::TextUnformatted(dump.c_str());
+        ImGui::EndChild();
+    }
+    ImGui::End();
+}
+
+void Gui::drawProfilerTimeline(const char* id, const Profiler& profiler) {
+    ImGui::PushID(id);
+    char overlay[64];
+
+    // Rolling frame graphs
+    std::vector<float> cpuHistory = profiler.getCpuHistory();
+    snprintf(overlay, sizeof(overlay), "CPU %.2f ms", profiler.getFrameCpuMs());
+    ImGui::PlotLines("##cpu", cpuHistory.data(), Profiler::HISTORY_SIZE, profiler.getHistoryOffset(),
+        overlay, 0.0f, 33.3f, ImVec2(-1, 60));
+    if (profiler.hasGpuTimers()) {
+        std::vector<float> gpuHistory = profiler.getGpuHistory();
+        snprintf(overlay, sizeof(overlay), "GPU %.2f ms", profiler.getFrameGpuMs());
+        ImGui::PlotLines("##gpu", gpuHistory.data(), Profiler::HISTORY_SIZE, profiler.getHistoryOffset(),
+            overlay, 0.0f, 33.3f, ImVec2(-1, 60));
+    } else {
+        ImGui::TextDisabled("No GPU timer queries on this thread");
+    }
+
+    // Per-pass table, smoothed with the latest value alongside
+    if (ImGui::BeginTable("Passes", 3, ImGuiTableFlags_RowBg | ImGuiTableFlags_BordersInnerV)) {
+        ImGui::TableSetupColumn("Pass");
+        ImGui::TableSetupColumn("CPU ms");
+        ImGui::TableSetupColumn("GPU ms");
+        ImGui::TableHeadersRow();
+
+        for (const ProfileResult& result : profiler.getResults()) {
+            ImGui::TableNextRow();
+            ImGui::TableSetColumnIndex(0);
+            ImGui::Text("%*s%s", result.depth * 2, "", result.name.c_str());
+            ImGui::TableSetColumnIndex(1);
+            ImGui::Text("%.3f (%.3f)", result.cpuAverageMs, result.cpuMs);
+            ImGui::TableSetColumnIndex(2);
+            if (result.gpuMs >= 0.0) {
+                ImGui::Text("%.3f (%.3f)", result.gpuAverageMs, result.gpuMs);
+            } else {
+                ImGui::TextDisabled("-");
+            }
+        }
+        ImGui::EndTable();
+    }
+
+    if (profiler.hasGpuTimers()) {
+        ImGui::Text("Dropped query frames: %zu", profiler.getDroppedFrames());
+    }
+    ImGui::PopID();
+}
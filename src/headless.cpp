@@ -0,0 +1,647 @@
+#include <glad/glad.h>
+#include <iostream>
+#include <fstream>
+#include <chrono>
+#include <cstdio>
+#include <cstdint>
+#include <cstdlib>
+#include <algorithm>
+#include <filesystem>
+#include <utility>
+
+#if defined(__linux__)
+#include <EGL/egl.h>
+#include <EGL/eglext.h>
+#endif
+
+#include "stb_image.h"
+
+#include "headless.hpp"
+#include "scene.hpp"
+#include "camera.hpp"
+#include "renderer.hpp"
+#include "rendergraph.hpp"
+#include "dynamicresolution.hpp"
+#include "texturestreamer.hpp"
+#include "arena.hpp"
+#include "jobs.hpp"
+#include "glstate.hpp"
+
+// === Constants ===
+static const int GL_VERSIONS[][2] = {{4, 6}, {4, 3}, {3, 3}};
+static const glm::vec4 CLEAR_COLOR = glm::vec4(0.5f, 0.7f, 1.0f, 1.0f);
+static const size_t MAX_STORED_BLOCK = 65535;
+
+using Clock = std::chrono::steady_clock;
+
+// === PNG helpers ===
+// Uncompressed deflate is enough for golden images and needs no zlib
+static uint32_t updateCrc(uint32_t crc, const unsigned char* data, size_t size) {
+    static uint32_t table[256];
+    static bool tableReady = false;
+    if (!tableReady) {
+        for (uint32_t n = 0; n < 256; n++) {
+            uint32_t c = n;
+            for (int k = 0; k < 8; k++) {
+                c = (c & 1) ? 0xEDB88320u ^ (c >> 1) : c >> 1;
+            }
+            table[n] = c;
+        }
+        tableReady = true;
+    }
+
+    crc = ~crc;
+    for (size_t i = 0; i < size; i++) {
+        crc = table[(crc ^ data[i]) & 0xFF] ^ (crc >> 8);
+    }
+    return ~crc;
+}
+
+static void appendBigEndian(std::vector<unsigned char>& out, uint32_t value) {
+    out.push_back(static_cast<unsigned char>(value >> 24));
+    out.push_back(static_cast<unsigned char>(value >> 16));
+    out.push_back(static_cast<unsigned char>(value >> 8));
+    out.push_back(static_cast<unsigned char>(value));
+}
+
+static void appendChunk(std::vector<unsigned char>& out, const char* type, const std::vector<unsigned char>& data) {
+    appendBigEndian(out, static_cast<uint32_t>(data.size()));
+    size_t start = out.size();
+    out.insert(out.end(), type, type + 4);
+    out.insert(out.end(), data.begin(), data.end());
+    appendBigEndian(out, updateCrc(0, out.data() + start, out.size() - start));
+}
+
+static bool writePng(const std::string& path, const std::vector<unsigned char>& rgb, int width, int height) {
+    // Rows with filter type 0 in front
+    size_t stride = static_cast<size_t>(width) * 3;
+    std::vector<unsigned char> raw;
+    raw.reserve((stride + 1) * height);
+    for (int y = 0; y < height; y++) {
+        raw.push_back(0);
+        raw.insert(raw.end(), rgb.begin() + y * stride, rgb.begin() + (y + 1) * stride);
+    }
+
+    // zlib stream of stored blocks
+    std::vector<unsigned char> compressed = {0x78, 0x01};
+    uint32_t a = 1, b = 0;
+    for (size_t offset = 0; offset < raw.size() || offset == 0; offset += MAX_STORED_BLOCK) {
+        size_t size = std::min(MAX_STORED_BLOCK, raw.size() - offset);
+        bool last = offset + size >= raw.size();
+        compressed.push_back(last ? 1 : 0);
+        compressed.push_back(static_cast<unsigned char>(size));
+        compressed.push_back(static_cast<unsigned char>(size >> 8));
+        compressed.push_back(static_cast<unsigned char>(~size));
+        compressed.push_back(static_cast<unsigned char>(~size >> 8));
+        compressed.insert(compressed.end(), raw.begin() + offset, raw.begin() + offset + size);
+        if (last) break;
+    }
+    for (unsigned char byte : raw) {
+        a = (a + byte) % 65521;
+        b = (b + a) % 65521;
+    }
+    appendBigEndian(compressed, (b << 16) | a);
+
+    std::vector<unsigned char> header;
+    appendBigEndian(header, static_cast<uint32_t>(width));
+    appendBigEndian(header, static_cast<uint32_t>(height));
+    header.insert(header.end(), {8, 2, 0, 0, 0}); // 8-bit RGB
+
+    std::vector<unsigned char> png = {0x89, 'P', 'N', 'G', '\r', '\n', 0x1A, '\n'};
+    appendChunk(png, "IHDR", header);
+    appendChunk(png, "IDAT", compressed);
+    appendChunk(png, "IEND", {});
+
+    std::ofstream file(path, std::ios::binary);
+    if (!file) return false;
+    file.write(reinterpret_cast<const char*>(png.data()), png.size());
+    return static_cast<bool>(file);
+}
+
+// === Report helpers ===
+static std::string escapeJson(const std::string& text) {
+    std::string out;
+    for (char c : text) {
+        if (c == '"' || c == '\\') out.push_back('\\');
+        if (static_cast<unsigned char>(c) >= 0x20) out.push_back(c);
+    }
+    return out;
+}
+
+static double getPercentile(std::vector<double> values, double percentile) {
+    if (values.empty()) return 0.0;
+    std::sort(values.begin(), values.end());
+    size_t index = static_cast<size_t>(percentile * (values.size() - 1) + 0.5);
+    return values[std::min(index, values.size() - 1)];
+}
+
+static double getMean(const std::vector<double>& values) {
+    if (values.empty()) return 0.0;
+    double sum = 0.0;
+    for (double value : values) sum += value;
+    return sum / values.size();
+}
+
+static void writeArray(std::ostream& out, const std::vector<double>& values) {
+    out << "[";
+    for (size_t i = 0; i < values.size(); i++) {
+        out << (i ? ", " : "") << values[i];
+    }
+    out << "]";
+}
+
+// ### HeadlessOptions functions ###
+// === Parsing ===
+bool HeadlessOptions::parse(int argc, char** argv) {
+    for (int i = 1; i < argc; i++) {
+        std::string arg = argv[i];
+        const char* value = i + 1 < argc ? argv[i + 1] : nullptr;
+        bool takesValue = true;
+
+        if (arg == "--headless") {
+            enabled = true;
+            takesValue = false;
+        } else if (arg == "--prepass") {
+            depthPrepass = true;
+            takesValue = false;
+        } else if (arg == "--no-occlusion") {
+            occlusionCulling = false;
+            takesValue = false;
+        } else if (arg == "--gpu-culling") {
+            gpuCulling = true;
+            takesValue = false;
+        } else if (arg == "--no-state-filter") {
+            stateFiltering = false;
+            takesValue = false;
+        } else if (arg == "--help") {
+            printUsage(argv[0]);
+            std::exit(0);
+        } else if (!value) {
+            std::cerr << "Missing value for " << arg << std::endl;
+            printUsage(argv[0]);
+            return false;
+        } else if (arg == "--scene") {
+            scene = value;
+        } else if (arg == "--frames") {
+            frames = std::atoi(value);
+        } else if (arg == "--warmup") {
+            warmup = std::atoi(value);
+        } else if (arg == "--size") {
+            if (std::sscanf(value, "%dx%d", &width, &height) != 2) width = 0;
+        } else if (arg == "--camera") {
+            // x,y,z with an optional yaw,pitch
+            std::sscanf(value, "%f,%f,%f,%f,%f", &cameraPosition.x, &cameraPosition.y, &cameraPosition.z, &cameraYaw, &cameraPitch);
+        } else if (arg == "--dynamic-resolution") {
+            resolutionTargetMs = static_cast<float>(std::atof(value));
+        } else if (arg == "--json") {
+            jsonPath = value;
+        } else if (arg == "--png-dir") {
+            pngDir = value;
+        } else if (arg == "--png-every") {
+            pngEvery = std::atoi(value);
+        } else if (arg == "--golden") {
+            goldenDir = value;
+        } else if (arg == "--tolerance") {
+            tolerance = std::atoi(value);
+        } else if (arg == "--max-diff") {
+            maxDiffFraction = std::atof(value);
+        } else {
+            std::cerr << "Unknown argument " << arg << std::endl;
+            printUsage(argv[0]);
+            return false;
+        }
+        if (takesValue) i++;
+    }
+
+    if (resolutionTargetMs < 0.0f) {
+        std::cerr << "--dynamic-resolution needs a positive target" << std::endl;
+        return false;
+    }
+    if (frames <= 0 || warmup < 0 || width <= 0 || height <= 0) {
+        std::cerr << "Frames and size must be positive" << std::endl;
+        return false;
+    }
+    if (!goldenDir.empty() && pngDir.empty()) {
+        std::cerr << "--golden compares written frames, so it needs --png-dir" << std::endl;
+        return false;
+    }
+    return true;
+}
+
+void HeadlessOptions::printUsage(const char* program) {
+    std::cout << "Usage: " << program << " [--headless [options]]\n"
+              << "  --scene NAME        scene from assets/scenes (default)\n"
+              << "  --frames N          measured frames (300)\n"
+              << "  --warmup N          frames drawn before measuring (10)\n"
+              << "  --size WxH          framebuffer size (1280x720)\n"
+              << "  --camera X,Y,Z[,YAW,PITCH]\n"
+              << "  --prepass           enable the depth pre-pass\n"
+              << "  --no-occlusion      disable occlusion culling\n"
+              << "  --gpu-culling       cull on the GPU with compute shaders (GL 4.3)\n"
+              << "  --no-state-filter   issue every GL state call, even redundant ones\n"
+              << "  --dynamic-resolution MS  scale the scene to hold MS of GPU time\n"
+              << "  --json FILE         write frame timings as JSON\n"
+              << "  --png-dir DIR       write frames as PNG, the last one unless --png-every\n"
+              << "  --png-every N       write every Nth measured frame\n"
+              << "  --golden DIR        compare written frames with DIR, exit code 2 on mismatch\n"
+              << "  --tolerance N       per-channel difference ignored (2)\n"
+              << "  --max-diff F        fraction of differing pixels allowed (0.001)\n";
+}
+
+// ### HeadlessRunner functions ###
+// === Constructor ===
+HeadlessRunner::HeadlessRunner(const HeadlessOptions& options)
+    : options(options) {}
+
+// === Run ===
+int HeadlessRunner::run() {
+    if (!createContext()) return 1;
+    createTarget();
+    std::cout << "Headless: " << glRenderer << ", " << options.width << "x" << options.height << std::endl;
+
+    // Recording and drawing share this thread, so GPU scopes land in the render timeline
+    Profiler& profiler = Profiler::getRender();
+    profiler.bindToThread();
+
+    std::vector<ProfileResult> passes;
+    bool loaded = false;
+    {
+        Renderer renderer;
+        renderer.setDepthPrepass(options.depthPrepass);
+        RenderGraph graph;
+        DynamicResolution resolution;
+        resolution.setEnabled(options.resolutionTargetMs > 0.0f);
+        resolution.setTargetMs(options.resolutionTargetMs);
+        Scene scene;
+        loaded = scene.loadScene(options.scene);
+        scene.setOcclusionCulling(options.occlusionCulling);
+        if (options.gpuCulling && !renderer.supportsGpuCulling()) {
+            std::cerr << "Headless: GPU culling needs GL 4.3, culling on the CPU" << std::endl;
+            options.gpuCulling = false;
+        }
+        scene.setGpuCulling(options.gpuCulling);
+        if (GpuCuller* culler = renderer.getGpuCuller()) culler->setOcclusion(options.occlusionCulling);
+        GLState::get().setFiltering(options.stateFiltering);
+
+        Camera camera(static_cast<float>(options.width) / options.height);
+        camera.position = options.cameraPosition;
+        camera.yaw = options.cameraYaw;
+        camera.pitch = options.cameraPitch;
+        camera.updateCameraVectors();
+
+        AttachmentDesc color;
+        color.width = options.width;
+        color.height = options.height;
+        color.clearColor = CLEAR_COLOR;
+        AttachmentDesc depth = color;
+        depth.format = AttachmentFormat::Depth24;
+
+        RenderFrame frame;
+        int totalFrames = options.warmup + options.frames;
+        for (int i = 0; loaded && i < totalFrames; i++) {
+            Clock::time_point start = Clock::now();
+            profiler.beginFrame();
+
+            {
+                ProfileScope scope("Scene record");
+                scene.updateBounds();
+                scene.draw(frame, camera, false);
+            }
+
+            float scale = resolution.update(profiler);
+            bool drawScene = renderer.beginFrame(frame);
+            TextureStreamer::get().update(static_cast<int>(options.height * scale));
+            Shader::updateVariants();
+            graph.reset();
+            graph.importAttachment("Backbuffer", color, framebuffer);
+            graph.importAttachment("BackbufferDepth", depth, framebuffer);
+            if (drawScene) {
+                resolution.addScenePasses(graph, renderer, color, "Backbuffer", "BackbufferDepth");
+            } else {
+                // Nothing visible, the graph still clears the target
+                graph.addPass("Clear", [](const RenderGraph&) {}).write("Backbuffer");
+            }
+            graph.compile();
+            graph.execute();
+            renderer.endFrame();
+            GLState::get().endFrame();
+            profiler.endFrame();
+
+            // Submission time, then the whole frame once the GPU is done
+            double submitted = std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+            glFinish();
+            double finished = std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+
+            int measured = i - options.warmup;
+            if (measured < 0) continue;
+            cpuMs.push_back(submitted);
+            frameMs.push_back(finished);
+            scales.push_back(scale);
+
+            bool save = options.pngEvery > 0 ? measured % options.pngEvery == 0 : measured == options.frames - 1;
+            if (!options.pngDir.empty() && save) {
+                saveFrame(measured, readPixels());
+            }
+        }
+
+        passes = profiler.getResults();
+        if (options.gpuCulling) gpuCull = renderer.getGpuCuller()->getStats();
+        glState = GLState::get().getStats();
+        for (const std::string& name : scene.getShaderNames()) {
+            shaderVariants.push_back({name, scene.getShader(name)->getVariantCount()});
+        }
+        resolution.release();
+        graph.release();
+    }
+
+    GeometryArena::get().shutdown();
+    MaterialBuffer::get().shutdown();
+    profiler.shutdown();
+    JobSystem::get().shutdown();
+    destroyTarget();
+    destroyContext();
+
+    if (!loaded) {
+        std::cerr << "Headless: failed to load scene " << options.scene << std::endl;
+        return 1;
+    }
+
+    double mean = getMean(frameMs);
+    std::cout << "Headless: " << frameMs.size() << " frames, mean " << mean << " ms, p95 "
+              << getPercentile(frameMs, 0.95) << " ms, " << (mean > 0.0 ? 1000.0 / mean : 0.0) << " fps" << std::endl;
+
+    if (!options.jsonPath.empty() && !writeReport(passes)) {
+        std::cerr << "Headless: failed to write " << options.jsonPath << std::endl;
+        return 1;
+    }
+
+    bool passed = true;
+    for (const ImageResult& image : images) {
+        if (!image.compared) continue;
+        std::cout << "Headless: " << image.file << (image.passed ? " matches" : " DIFFERS") << " (" << image.diffPixels
+                  << " pixels, max channel difference " << image.maxDiff << ")" << std::endl;
+        passed = passed && image.passed;
+    }
+    return passed ? 0 : 2;
+}
+
+// === Internal helpers ===
+bool HeadlessRunner::createContext() {
+#if defined(__linux__)
+    // Surfaceless Mesa needs no display server, other platforms fall back to the default display
+    EGLDisplay eglDisplay = EGL_NO_DISPLAY;
+#if defined(EGL_PLATFORM_SURFACELESS_MESA)
+    auto getPlatformDisplay = (PFNEGLGETPLATFORMDISPLAYEXTPROC)eglGetProcAddress("eglGetPlatformDisplayEXT");
+    if (getPlatformDisplay) {
+        eglDisplay = getPlatformDisplay(EGL_PLATFORM_SURFACELESS_MESA, EGL_DEFAULT_DISPLAY, nullptr);
+    }
+#endif
+    if (eglDisplay == EGL_NO_DISPLAY) {
+        eglDisplay = eglGetDisplay(EGL_DEFAULT_DISPLAY);
+    }
+
+    EGLint major = 0, minor = 0;
+    if (eglDisplay == EGL_NO_DISPLAY || !eglInitialize(eglDisplay, &major, &minor)) {
+        std::cerr << "Headless: failed to initialize EGL" << std::endl;
+        return false;
+    }
+    display = eglDisplay;
+    eglBindAPI(EGL_OPENGL_API);
+
+    // Rendering goes to our own framebuffer, so any OpenGL config will do
+    const EGLint configAttributes[] = {EGL_RENDERABLE_TYPE, EGL_OPENGL_BIT, EGL_NONE};
+    EGLConfig config = nullptr;
+    EGLint configCount = 0;
+    eglChooseConfig(eglDisplay, configAttributes, &config, 1, &configCount);
+
+    // Newest OpenGL version first, like the window
+    EGLContext eglContext = EGL_NO_CONTEXT;
+    for (const auto& version : GL_VERSIONS) {
+        const EGLint contextAttributes[] = {
+            EGL_CONTEXT_MAJOR_VERSION, version[0],
+            EGL_CONTEXT_MINOR_VERSION, version[1],
+            EGL_CONTEXT_OPENGL_PROFILE_MASK, EGL_CONTEXT_OPENGL_CORE_PROFILE_BIT,
+            EGL_NONE
+        };
+        eglContext = eglCreateContext(eglDisplay, configCount ? config : nullptr, EGL_NO_CONTEXT, contextAttributes);
+        if (eglContext != EGL_NO_CONTEXT) break;
+    }
+    if (eglContext == EGL_NO_CONTEXT) {
+        std::cerr << "Headless: failed to create an OpenGL 3.3+ core context" << std::endl;
+        destroyContext();
+        return false;
+    }
+    context = eglContext;
+
+    if (!eglMakeCurrent(eglDisplay, EGL_NO_SURFACE, EGL_NO_SURFACE, eglContext)) {
+        std::cerr << "Headless: EGL has no surfaceless contexts" << std::endl;
+        destroyContext();
+        return false;
+    }
+    if (!gladLoadGLLoader((GLADloadproc)eglGetProcAddress)) {
+        std::cerr << "Failed to initialize GLAD\n";
+        destroyContext();
+        return false;
+    }
+    Shader::initParallelCompile((void* (*)(const char*))eglGetProcAddress);
+
+    glVersion = reinterpret_cast<const char*>(glGetString(GL_VERSION));
+    glRenderer = reinterpret_cast<const char*>(glGetString(GL_RENDERER));
+    GLState::get().setEnabled(GL_DEPTH_TEST, true);
+    return true;
+#else
+    std::cerr << "Headless: needs EGL, which this build does not have" << std::endl;
+    return false;
+#endif
+}
+
+void HeadlessRunner::destroyContext() {
+#if defined(__linux__)
+    if (!display) return;
+    eglMakeCurrent(display, EGL_NO_SURFACE, EGL_NO_SURFACE, EGL_NO_CONTEXT);
+    if (context) eglDestroyContext(display, context);
+    eglTerminate(display);
+    context = nullptr;
+    display = nullptr;
+#endif
+}
+
+void HeadlessRunner::createTarget() {
+    glGenRenderbuffers(1, &colorBuffer);
+    glBindRenderbuffer(GL_RENDERBUFFER, colorBuffer);
+    glRenderbufferStorage(GL_RENDERBUFFER, GL_RGBA8, options.width, options.height);
+
+    glGenRenderbuffers(1, &depthBuffer);
+    glBindRenderbuffer(GL_RENDERBUFFER, depthBuffer);
+    glRenderbufferStorage(GL_RENDERBUFFER, GL_DEPTH_COMPONENT24, options.width, options.height);
+    glBindRenderbuffer(GL_RENDERBUFFER, 0);
+
+    glGenFramebuffers(1, &framebuffer);
+    GLState::get().bindFramebuffer(GL_FRAMEBUFFER, framebuffer);
+    glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_RENDERBUFFER, colorBuffer);
+    glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, GL_RENDERBUFFER, depthBuffer);
+    if (glCheckFramebufferStatus(GL_FRAMEBUFFER) != GL_FRAMEBUFFER_COMPLETE) {
+        std::cerr << "Headless: framebuffer is incomplete" << std::endl;
+    }
+}
+
+void HeadlessRunner::destroyTarget() {
+    GLState::get().bindFramebuffer(GL_FRAMEBUFFER, 0);
+    GLState::get().deleteFramebuffer(framebuffer);
+    glDeleteRenderbuffers(1, &colorBuffer);
+    glDeleteRenderbuffers(1, &depthBuffer);
+}
+
+std::vector<unsigned char> HeadlessRunner::readPixels() const {
+    size_t stride = static_cast<size_t>(options.width) * 3;
+    std::vector<unsigned char> flipped(stride * options.height);
+    GLState::get().bindFramebuffer(GL_READ_FRAMEBUFFER, framebuffer);
+    glPixelStorei(GL_PACK_ALIGNMENT, 1);
+    glReadPixels(0, 0, options.width, options.height, GL_RGB, GL_UNSIGNED_BYTE, flipped.data());
+
+    // GL rows start at the bottom, images at the top
+    std::vector<unsigned char> pixels(flipped.size());
+    for (int y = 0; y < options.height; y++) {
+        std::copy_n(flipped.begin() + (options.height - 1 - y) * stride, stride, pixels.begin() + y * stride);
+    }
+    return pixels;
+}
+
+void HeadlessRunner::saveFrame(int frame, const std::vector<unsigned char>& pixels) {
+    char name[32];
+    std::snprintf(name, sizeof(name), "frame_%05d.png", frame);
+    std::filesystem::create_directories(options.pngDir);
+    std::string path = (std::filesystem::path(options.pngDir) / name).string();
+    if (!writePng(path, pixels, options.width, options.height)) {
+        std::cerr << "Headless: failed to write " << path << std::endl;
+    }
+
+    ImageResult result;
+    result.file = name;
+    result.frame = frame;
+    if (!options.goldenDir.empty()) {
+        std::string goldenPath = (std::filesystem::path(options.goldenDir) / name).string();
+        int width = 0, height = 0, channels = 0;
+        stbi_set_flip_vertically_on_load(false);
+        unsigned char* golden = stbi_load(goldenPath.c_str(), &width, &height, &channels, 3);
+
+        result.compared = true;
+        if (!golden || width != options.width || height != options.height) {
+            std::cerr << "Headless: no matching golden image " << goldenPath << std::endl;
+            result.passed = false;
+            result.diffPixels = static_cast<size_t>(options.width) * options.height;
+        } else {
+            // Differing pixels are marked red over a dimmed copy of the frame
+            std::vector<unsigned char> diffImage(pixels.size());
+            for (size_t i = 0; i < pixels.size(); i += 3) {
+                int difference = 0;
+                for (int c = 0; c < 3; c++) {
+                    difference = std::max(difference, std::abs(pixels[i + c] - golden[i + c]));
+                }
+                result.maxDiff = std::max(result.maxDiff, difference);
+                bool differs = difference > options.tolerance;
+                if (differs) result.diffPixels++;
+                for (int c = 0; c < 3; c++) {
+                    diffImage[i + c] = differs ? (c == 0 ? 255 : 0) : static_cast<unsigned char>(pixels[i + c] / 4);
+                }
+            }
+            result.passed = result.diffPixels <= options.maxDiffFraction * options.width * options.height;
+            if (!result.passed) {
+                std::snprintf(name, sizeof(name), "frame_%05d_diff.png", frame);
+                writePng((std::filesystem::path(options.pngDir) / name).string(), diffImage, options.width, options.height);
+            }
+        }
+        stbi_image_free(golden);
+    }
+    images.push_back(result);
+}
+
+bool HeadlessRunner::writeReport(const std::vector<ProfileResult>& passes) const {
+    std::ofstream out(options.jsonPath);
+    if (!out) return false;
+
+    double mean = getMean(frameMs);
+    out << "{\n";
+    out << "  \"scene\": \"" << escapeJson(options.scene) << "\",\n";
+    out << "  \"width\": " << options.width << ",\n";
+    out << "  \"height\": " << options.height << ",\n";
+    out << "  \"warmup\": " << options.warmup << ",\n";
+    out << "  \"frames\": " << frameMs.size() << ",\n";
+    out << "  \"depthPrepass\": " << (options.depthPrepass ? "true" : "false") << ",\n";
+    out << "  \"occlusionCulling\": " << (options.occlusionCulling ? "true" : "false") << ",\n";
+    out << "  \"gpuCulling\": " << (options.gpuCulling ? "true" : "false") << ",\n";
+    out << "  \"stateFiltering\": " << (options.stateFiltering ? "true" : "false") << ",\n";
+    out << "  \"parallelShaderCompile\": " << (Shader::hasParallelCompile() ? "true" : "false") << ",\n";
+    out << "  \"resolutionTargetMs\": " << options.resolutionTargetMs << ",\n";
+    out << "  \"gl\": {\"version\": \"" << escapeJson(glVersion) << "\", \"renderer\": \"" << escapeJson(glRenderer) << "\"},\n";
+
+    out << "  \"summary\": {\"meanMs\": " << mean
+        << ", \"medianMs\": " << getPercentile(frameMs, 0.5)
+        << ", \"p95Ms\": " << getPercentile(frameMs, 0.95)
+        << ", \"p99Ms\": " << getPercentile(frameMs, 0.99)
+        << ", \"minMs\": " << getPercentile(frameMs, 0.0)
+        << ", \"maxMs\": " << getPercentile(frameMs, 1.0)
+        << ", \"meanCpuMs\": " << getMean(cpuMs)
+        << ", \"fps\": " << (mean > 0.0 ? 1000.0 / mean : 0.0) << "},\n";
+
+    // Texture memory after the last frame, and with every mip resident
+    TextureStreamStats textures = TextureStreamer::get().getStats();
+    out << "  \"textures\": {\"count\": " << textures.textures << ", \"residentBytes\": " << textures.residentBytes
+        << ", \"fullBytes\": " << textures.fullBytes << ", \"pending\": " << textures.pending << "},\n";
+
+    // Instances of the last frame culled on the GPU
+    if (options.gpuCulling) {
+        out << "  \"gpuCull\": {\"instances\": " << gpuCull.instances << ", \"visible\": " << gpuCull.visible
+            << ", \"frustumCulled\": " << gpuCull.frustumCulled << ", \"occluded\": " << gpuCull.occluded << "},\n";
+    }
+
+    // GL state calls of the last frame, by kind
+    const std::pair<const char*, GLCallCounts> kinds[] = {
+        {"programs", glState.programs}, {"vertexArrays", glState.vertexArrays}, {"textures", glState.textures},
+        {"buffers", glState.buffers}, {"framebuffers", glState.framebuffers}, {"fixedFunction", glState.fixedFunction},
+        {"total", glState.getTotal()}};
+    out << "  \"glState\": {";
+    for (size_t i = 0; i < sizeof(kinds) / sizeof(kinds[0]); i++) {
+        out << (i ? ", " : "") << "\"" << kinds[i].first << "\": {\"issued\": " << kinds[i].second.issued
+            << ", \"filtered\": " << kinds[i].second.filtered << "}";
+    }
+    out << "},\n";
+
+    // Programs compiled per shader, the full one included
+    out << "  \"shaderVariants\": {";
+    for (size_t i = 0; i < shaderVariants.size(); i++) {
+        out << (i ? ", " : "") << "\"" << escapeJson(shaderVariants[i].first) << "\": " << shaderVariants[i].second;
+    }
+    out << "},\n";
+
+    // Smoothed per-scope timings, GPU is -1 for CPU-only scopes
+    out << "  \"passes\": [";
+    for (size_t i = 0; i < passes.size(); i++) {
+        const ProfileResult& pass = passes[i];
+        out << (i ? ",\n" : "\n") << "    {\"name\": \"" << escapeJson(pass.name) << "\", \"depth\": " << pass.depth
+            << ", \"cpuMs\": " << pass.cpuAverageMs << ", \"gpuMs\": " << pass.gpuAverageMs << "}";
+    }
+    out << "\n  ],\n";
+
+    out << "  \"images\": [";
+    for (size_t i = 0; i < images.size(); i++) {
+        const ImageResult& image = images[i];
+        out << (i ? ",\n" : "\n") << "    {\"file\": \"" << escapeJson(image.file) << "\", \"frame\": " << image.frame;
+        if (image.compared) {
+            out << ", \"passed\": " << (image.passed ? "true" : "false") << ", \"diffPixels\": " << image.diffPixels
+                << ", \"maxDiff\": " << image.maxDiff;
+        }
+        out << "}";
+    }
+    out << "\n  ],\n";
+
+    // Whole frame until the GPU finished, and submission alone
+    out << "  \"frameMs\": ";
+    writeArray(out, frameMs);
+    out << ",\n  \"cpuMs\": ";
+    writeArray(out, cpuMs);
+    out << ",\n  \"scales\": ";
+    writeArray(out, scales);
+    out << "\n}\n";
+    return static_cast<bool>(out);
+}
@@ -0,0 +1,120 @@
+#include <algorithm>
+#include <cctype>
+#include <iterator>
+
+#include "hierarchyview.hpp"
+
+// === Internal helpers ===
+static std::string toLower(std::string text) {
+    std::transform(text.begin(), text.end(), text.begin(), [](unsigned char c) {return std::tolower(c);});
+    return text;
+}
+
+// ### HierarchyView functions ###
+// === Sync ===
+void HierarchyView::sync(const Scene& target) {
+    if (scene == &target && revision == target.getHierarchyRevision()) return;
+
+    if (scene != &target) {
+        // Another scene, nothing carries over
+        expanded.clear();
+    } else if (removalRevision != target.getRemovalRevision() && !expanded.empty()) {
+        // Forget removed objects so a reused address does not come back expanded
+        std::unordered_set<const Object*> alive(target.getObjects().begin(), target.getObjects().end());
+        for (auto it = expanded.begin(); it != expanded.end();) {
+            it = alive.count(*it) ? std::next(it) : expanded.erase(it);
+        }
+    }
+
+    scene = &target;
+    revision = target.getHierarchyRevision();
+    removalRevision = target.getRemovalRevision();
+    candidatesFor = nullptr;
+    rebuild();
+}
+
+// === Rows ===
+void HierarchyView::setExpanded(size_t row, bool open) {
+    if (row >= rows.size()) return;
+    HierarchyRow parent = rows[row];
+
+    if (open) {
+        if (!expanded.insert(parent.object).second) return;
+
+        // Splice in the subtree below the row
+        std::vector<HierarchyRow> subtree;
+        for (Object* child : parent.object->children) {
+            appendVisible(child, parent.depth + 1, subtree);
+        }
+        rows.insert(rows.begin() + row + 1, subtree.begin(), subtree.end());
+    } else {
+        if (!expanded.erase(parent.object)) return;
+
+        // The subtree is every deeper row that follows
+        size_t end = row + 1;
+        while (end < rows.size() && rows[end].depth > parent.depth) end++;
+        rows.erase(rows.begin() + row + 1, rows.begin() + end);
+    }
+}
+
+size_t HierarchyView::reveal(const Object* object) {
+    bool changed = false;
+    for (const Object* ancestor = object->parent; ancestor; ancestor = ancestor->parent) {
+        changed |= expanded.insert(ancestor).second;
+    }
+    if (changed) rebuild();
+
+    for (size_t i = 0; i < rows.size(); i++) {
+        if (rows[i].object == object) return i;
+    }
+    return rows.size();
+}
+
+// === Parent candidates ===
+const std::vector<Object*>& HierarchyView::getParentCandidates(const Object* object, const std::string& filter) {
+    if (object == candidatesFor && filter == candidatesFilter && revision == candidatesRevision) return candidates;
+    candidatesFor = object;
+    candidatesFilter = filter;
+    candidatesRevision = revision;
+    candidates.clear();
+
+    // An object can not be parented to itself or anything below it
+    std::unordered_set<const Object*> excluded;
+    std::vector<const Object*> stack = {object};
+    while (!stack.empty()) {
+        const Object* current = stack.back();
+        stack.pop_back();
+        excluded.insert(current);
+        stack.insert(stack.end(), current->children.begin(), current->children.end());
+    }
+
+    std::string needle = toLower(filter);
+    for (Object* candidate : scene->getObjects()) {
+        if (excluded.count(candidate)) continue;
+        if (!needle.empty() && toLower(candidate->name).find(needle) == std::string::npos) continue;
+        candidates.push_back(candidate);
+    }
+    return candidates;
+}
+
+// === Internal helpers ===
+void HierarchyView::rebuild() {
+    rows.clear();
+    for (Object* object : scene->getObjects()) {
+        if (!object->parent) appendVisible(object, 0, rows);
+    }
+}
+
+void HierarchyView::appendVisible(Object* object, int depth, std::vector<HierarchyRow>& out) const {
+    // Depth first without recursion, long parent chains would overflow the stack
+    std::vector<HierarchyRow> stack = {{object, depth}};
+    while (!stack.empty()) {
+        HierarchyRow row = stack.back();
+        stack.pop_back();
+        out.push_back(row);
+        if (!isExpanded(row.object)) continue;
+        for (auto child = row.object->children.rbegin(); child != row.object->children.rend(); ++child) {
+            stack.push_back({*child, row.depth + 1});
+        }
+    }
+}
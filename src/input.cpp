@@ -82,7 +82,7 @@ void Input::processEditorInput(Window& window, Camera& camera, Camera& playCamer
         }
         if (isKeyPressedOnce(GLFW_KEY_C)) {
             std::string objName = "NewObj" + std::to_string(scene.getObjectCount());
-            scene.addObject(objName, std::make_unique<Object>(objName, "cube", "default.jpg", "default"));
+            scene.addObject(objName, scene.createObject(objName, "cube", "default.jpg", "default"));
             scene.selectObject(objName);
         }
         if (isKeyPressedOnce(GLFW_KEY_DELETE)) {
@@ -104,6 +104,7 @@ void Input::processEditorInput(Window& window, Camera& camera, Camera& playCamer
                 mode = Mode::Playtest;
                 playScene = std::make_unique<Scene>(scene);
                 playScene->clearSelection();
+                playScene->buildStaticBatches();
                 for (auto& obj : playScene->getObjects()) {
                     if (obj->isPlayer) {
                         playCamera.position = obj->transform.position;
@@ -306,18 +307,9 @@ void Input::mouse_button_callback(GLFWwindow* glfwWindow, int button, int action
 
             scene.clearSelection();
             
-            float closestT = std::numeric_limits<float>::max();
-            Object* selectedObject = nullptr;
-
-            for (auto& obj : scene.getObjects()) {
-                float t;
-                if (RayIntersectsOBB(camera.getPosition(), ray, obj->obb, t)) {
-                    if (t < closestT) {
-                        closestT = t;
-                        selectedObject = obj;
-                    }
-                }
-            }
+            // Closest triangle under the cursor
+            MeshHit hit;
+            Object* selectedObject = scene.pick(camera.getPosition(), ray, hit);
 
             if (selectedObject) {
                 scene.selectObject(selectedObject->name);
@@ -0,0 +1,130 @@
+#include <algorithm>
+
+#include "jobs.hpp"
+
+// === Constants ===
+static const unsigned int MAX_WORKERS = 15;
+
+// === Singleton access ===
+JobSystem& JobSystem::get() {
+    static JobSystem instance;
+    return instance;
+}
+
+// === Constructor ===
+JobSystem::JobSystem() {
+    // Leave one hardware thread for the caller
+    unsigned int hardware = std::thread::hardware_concurrency();
+    unsigned int count = std::min(hardware > 1 ? hardware - 1 : 0u, MAX_WORKERS);
+    for (unsigned int i = 0; i < count; i++) {
+        workers.emplace_back(&JobSystem::workerLoop, this);
+    }
+}
+
+// === Deconstructor ===
+JobSystem::~JobSystem() {
+    shutdown();
+}
+
+// === Dispatch ===
+void JobSystem::parallelFor(size_t count, const std::function<void(size_t)>& function) {
+    if (count == 0) return;
+
+    // Not worth waking anyone for a single job
+    if (workers.empty() || count == 1) {
+        for (size_t i = 0; i < count; i++) function(i);
+        return;
+    }
+
+    std::lock_guard<std::mutex> submitLock(submitMutex);
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        job = &function;
+        jobCount = count;
+        next = 0;
+        remaining = count;
+        generation++;
+    }
+    wake.notify_all();
+
+    runJobs(function, count);
+
+    // Wait for the last jobs and for every worker to leave this dispatch
+    std::unique_lock<std::mutex> lock(mutex);
+    done.wait(lock, [this]() {return remaining == 0 && busyWorkers == 0;});
+    job = nullptr;
+}
+
+void JobSystem::submit(std::function<void()> task) {
+    if (workers.empty()) {
+        task();
+        return;
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        tasks.push_back(std::move(task));
+    }
+    wake.notify_one();
+}
+
+// === Shutdown ===
+void JobSystem::shutdown() {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        running = false;
+    }
+    wake.notify_all();
+
+    for (std::thread& worker : workers) {
+        if (worker.joinable()) worker.join();
+    }
+    workers.clear();
+    tasks.clear();
+}
+
+// === Internal helpers ===
+void JobSystem::workerLoop() {
+    size_t seen = 0;
+    while (true) {
+        const std::function<void(size_t)>* current;
+        size_t count;
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            wake.wait(lock, [&]() {return !running || (job && generation != seen) || !tasks.empty();});
+            if (!running) return;
+
+            // Loops come first, the caller is waiting on them
+            if (!job || generation == seen) {
+                std::function<void()> task = std::move(tasks.front());
+                tasks.pop_front();
+                lock.unlock();
+                task();
+                continue;
+            }
+
+            seen = generation;
+            current = job;
+            count = jobCount;
+            busyWorkers++;
+        }
+
+        runJobs(*current, count);
+
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            busyWorkers--;
+        }
+        done.notify_all();
+    }
+}
+
+void JobSystem::runJobs(const std::function<void(size_t)>& current, size_t count) {
+    for (size_t i = next++; i < count; i = next++) {
+        current(i);
+        if (--remaining == 0) {
+            std::lock_guard<std::mutex> lock(mutex);
+            done.notify_all();
+        }
+    }
+}
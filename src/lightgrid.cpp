@@ -0,0 +1,269 @@
+#include <glad/glad.h>
+#include <algorithm>
+#include <cmath>
+
+#if defined(__SSE2__)
+#include <immintrin.h>
+#define LIGHTGRID_SSE 1
+#endif
+
+#include "lightgrid.hpp"
+#include "jobs.hpp"
+#include "glstate.hpp"
+
+// === Constants ===
+static const size_t MAX_VISIBLE_LIGHTS = 65535; // Indices are 16-bit
+static_assert(LightGrid::GRID_X % 4 == 0, "Cluster rows are tested four at a time");
+
+// === Constructor ===
+LightGrid::LightGrid()
+    : sliceLights(GRID_Z), clusterCounts(CLUSTER_COUNT, 0), clusterLights(static_cast<size_t>(CLUSTER_COUNT) * MAX_LIGHTS_PER_CLUSTER),
+      clusterData(CLUSTER_COUNT * 2, 0), lightIndices(1, 0) {
+    for (std::vector<float>* bounds : {&minX, &maxX, &minY, &maxY, &minZ, &maxZ}) {
+        bounds->resize(CLUSTER_COUNT);
+    }
+
+    // Texture buffers keep pointing at their buffer when its storage is respecified
+    glGenBuffers(1, &lightBuffer);
+    glGenBuffers(1, &clusterBuffer);
+    glGenBuffers(1, &indexBuffer);
+    glGenTextures(1, &lightTexture);
+    glGenTextures(1, &clusterTexture);
+    glGenTextures(1, &indexTexture);
+
+    gpuLights.resize(1);
+    upload();
+    gpuLights.clear();
+
+    GLState& state = GLState::get();
+    state.bindTexture(LIGHT_UNIT, GL_TEXTURE_BUFFER, lightTexture);
+    glTexBuffer(GL_TEXTURE_BUFFER, GL_RGBA32F, lightBuffer);
+    state.bindTexture(CLUSTER_UNIT, GL_TEXTURE_BUFFER, clusterTexture);
+    glTexBuffer(GL_TEXTURE_BUFFER, GL_RG32UI, clusterBuffer);
+    state.bindTexture(INDEX_UNIT, GL_TEXTURE_BUFFER, indexTexture);
+    glTexBuffer(GL_TEXTURE_BUFFER, GL_R16UI, indexBuffer);
+}
+
+// === Deconstructor ===
+LightGrid::~LightGrid() {
+    GLState::get().deleteTexture(lightTexture);
+    GLState::get().deleteTexture(clusterTexture);
+    GLState::get().deleteTexture(indexTexture);
+    GLState::get().deleteBuffer(lightBuffer);
+    GLState::get().deleteBuffer(clusterBuffer);
+    GLState::get().deleteBuffer(indexBuffer);
+}
+
+// === Binning ===
+void LightGrid::build(const std::vector<GpuLight>& lights, const glm::mat4& view, const glm::mat4& projection, float near, float far) {
+    stats = LightGridStats();
+    stats.lights = lights.size();
+
+    if (projection != boundsProjection || near != boundsNear || far != boundsFar) {
+        updateClusterBounds(projection, near, far);
+    }
+
+    binned.clear();
+    gpuLights.clear();
+    for (std::vector<int>& slice : sliceLights) slice.clear();
+
+    auto sliceOf = [&](float depth) {
+        int slice = static_cast<int>(std::floor(std::log(depth) * sliceScale - sliceBias));
+        return std::clamp(slice, 0, GRID_Z - 1);
+    };
+    auto tileOf = [](float ndc, int tiles) {
+        int tile = static_cast<int>(std::floor((ndc * 0.5f + 0.5f) * tiles));
+        return std::clamp(tile, 0, tiles - 1);
+    };
+
+    // Bound every light by a view-space sphere and find the clusters it can reach
+    for (const GpuLight& light : lights) {
+        if (gpuLights.size() == MAX_VISIBLE_LIGHTS) {
+            stats.overflowed++;
+            continue;
+        }
+
+        glm::vec3 center = glm::vec3(light.positionRange);
+        float radius = light.positionRange.w;
+        if (light.colorType.a > 0.5f) {
+            // Tightest sphere around the cone
+            float cosAngle = light.directionSpot.w;
+            glm::vec3 direction = glm::vec3(light.directionSpot);
+            if (cosAngle >= 0.70710678f) {
+                radius = light.positionRange.w / (2.0f * cosAngle);
+                center += direction * radius;
+            } else {
+                center += direction * (light.positionRange.w * cosAngle);
+                radius = light.positionRange.w * std::sqrt(std::max(0.0f, 1.0f - cosAngle * cosAngle));
+            }
+        }
+
+        BinnedLight bin;
+        bin.center = glm::vec3(view * glm::vec4(center, 1.0f));
+        bin.radius = radius;
+
+        float depth = -bin.center.z;
+        if (depth + radius < near || depth - radius > far) continue;
+        float nearDepth = std::max(depth - radius, near);
+        float farDepth = std::min(depth + radius, far);
+
+        // Screen bounds of the sphere's view box, extremes sit on its nearest or farthest face
+        float left = bin.center.x - radius, right = bin.center.x + radius;
+        float bottom = bin.center.y - radius, top = bin.center.y + radius;
+        float minNdcX = projection[0][0] * (left >= 0.0f ? left / farDepth : left / nearDepth);
+        float maxNdcX = projection[0][0] * (right >= 0.0f ? right / nearDepth : right / farDepth);
+        float minNdcY = projection[1][1] * (bottom >= 0.0f ? bottom / farDepth : bottom / nearDepth);
+        float maxNdcY = projection[1][1] * (top >= 0.0f ? top / nearDepth : top / farDepth);
+        if (maxNdcX < -1.0f || minNdcX > 1.0f || maxNdcY < -1.0f || minNdcY > 1.0f) continue;
+
+        bin.minX = tileOf(minNdcX, GRID_X);
+        bin.maxX = tileOf(maxNdcX, GRID_X);
+        bin.minY = tileOf(minNdcY, GRID_Y);
+        bin.maxY = tileOf(maxNdcY, GRID_Y);
+
+        int index = static_cast<int>(binned.size());
+        for (int slice = sliceOf(nearDepth); slice <= sliceOf(farDepth); slice++) {
+            sliceLights[slice].push_back(index);
+        }
+        binned.push_back(bin);
+        gpuLights.push_back(light);
+    }
+    stats.visibleLights = binned.size();
+
+    // Slices own disjoint clusters, so they fill without synchronization
+    std::fill(clusterCounts.begin(), clusterCounts.end(), 0);
+    JobSystem::get().parallelFor(GRID_Z, [this](size_t slice) {fillSlice(static_cast<int>(slice));});
+
+    // Pack the per-cluster lists into one index array
+    lightIndices.clear();
+    for (size_t cluster = 0; cluster < CLUSTER_COUNT; cluster++) {
+        size_t count = clusterCounts[cluster];
+        clusterData[cluster * 2] = static_cast<unsigned int>(lightIndices.size());
+        clusterData[cluster * 2 + 1] = static_cast<unsigned int>(std::min<size_t>(count, MAX_LIGHTS_PER_CLUSTER));
+        if (count > MAX_LIGHTS_PER_CLUSTER) {
+            stats.overflowed += count - MAX_LIGHTS_PER_CLUSTER;
+            count = MAX_LIGHTS_PER_CLUSTER;
+        }
+
+        const uint16_t* first = &clusterLights[cluster * MAX_LIGHTS_PER_CLUSTER];
+        lightIndices.insert(lightIndices.end(), first, first + count);
+        stats.maxPerCluster = std::max(stats.maxPerCluster, count);
+    }
+    stats.references = lightIndices.size();
+    if (lightIndices.empty()) lightIndices.push_back(0);
+}
+
+void LightGrid::upload() {
+    // Orphan and refill, the previous frame's storage stays with the GPU
+    auto fill = [](unsigned int buffer, size_t bytes, const void* data) {
+        GLState::get().bindBuffer(GL_TEXTURE_BUFFER, buffer);
+        glBufferData(GL_TEXTURE_BUFFER, bytes, nullptr, GL_STREAM_DRAW);
+        glBufferSubData(GL_TEXTURE_BUFFER, 0, bytes, data);
+    };
+
+    GpuLight empty = {};
+    fill(lightBuffer, std::max<size_t>(gpuLights.size(), 1) * sizeof(GpuLight), gpuLights.empty() ? &empty : gpuLights.data());
+    fill(clusterBuffer, clusterData.size() * sizeof(unsigned int), clusterData.data());
+    fill(indexBuffer, lightIndices.size() * sizeof(uint16_t), lightIndices.data());
+    GLState::get().bindBuffer(GL_TEXTURE_BUFFER, 0);
+}
+
+// === Binding ===
+void LightGrid::bind() const {
+    GLState& state = GLState::get();
+    state.bindTexture(LIGHT_UNIT, GL_TEXTURE_BUFFER, lightTexture);
+    state.bindTexture(CLUSTER_UNIT, GL_TEXTURE_BUFFER, clusterTexture);
+    state.bindTexture(INDEX_UNIT, GL_TEXTURE_BUFFER, indexTexture);
+}
+
+void LightGrid::setUniforms(const Shader& shader, const glm::vec2& viewportSize) const {
+    shader.setInt("lightData", LIGHT_UNIT);
+    shader.setInt("clusterData", CLUSTER_UNIT);
+    shader.setInt("lightIndices", INDEX_UNIT);
+    shader.setVec3("clusterGrid", glm::vec3(GRID_X, GRID_Y, GRID_Z));
+    shader.setVec2("clusterScale", glm::vec2(GRID_X, GRID_Y) / glm::max(viewportSize, glm::vec2(1.0f)));
+    shader.setVec2("clusterDepth", glm::vec2(sliceScale, sliceBias));
+}
+
+// === Internal helpers ===
+void LightGrid::updateClusterBounds(const glm::mat4& projection, float near, float far) {
+    boundsProjection = projection;
+    boundsNear = near;
+    boundsFar = far;
+
+    // Slice k spans near * (far / near)^(k / GRID_Z) to the next boundary
+    sliceScale = GRID_Z / std::log(far / near);
+    sliceBias = std::log(near) * sliceScale;
+
+    for (int z = 0; z < GRID_Z; z++) {
+        float nearDepth = near * std::pow(far / near, static_cast<float>(z) / GRID_Z);
+        float farDepth = near * std::pow(far / near, static_cast<float>(z + 1) / GRID_Z);
+
+        for (int y = 0; y < GRID_Y; y++) {
+            float bottom = -1.0f + 2.0f * y / GRID_Y;
+            float top = -1.0f + 2.0f * (y + 1) / GRID_Y;
+
+            for (int x = 0; x < GRID_X; x++) {
+                float left = -1.0f + 2.0f * x / GRID_X;
+                float right = -1.0f + 2.0f * (x + 1) / GRID_X;
+
+                // The froxel widens with depth, so its box spans both end faces
+                size_t cluster = getClusterIndex(x, y, z);
+                minX[cluster] = std::min(left * nearDepth, left * farDepth) / projection[0][0];
+                maxX[cluster] = std::max(right * nearDepth, right * farDepth) / projection[0][0];
+                minY[cluster] = std::min(bottom * nearDepth, bottom * farDepth) / projection[1][1];
+                maxY[cluster] = std::max(top * nearDepth, top * farDepth) / projection[1][1];
+                minZ[cluster] = -farDepth;
+                maxZ[cluster] = -nearDepth;
+            }
+        }
+    }
+}
+
+void LightGrid::fillSlice(int slice) {
+    for (int index : sliceLights[slice]) {
+        const BinnedLight& light = binned[index];
+        const float radiusSq = light.radius * light.radius;
+
+        for (int y = light.minY; y <= light.maxY; y++) {
+            // Y and Z bounds are shared along a row, only X changes per cluster
+            size_t row = getClusterIndex(0, y, slice);
+            float dy = std::max(0.0f, std::max(minY[row] - light.center.y, light.center.y - maxY[row]));
+            float dz = std::max(0.0f, std::max(minZ[row] - light.center.z, light.center.z - maxZ[row]));
+            float rowDistSq = dy * dy + dz * dz;
+            if (rowDistSq > radiusSq) continue;
+
+            auto append = [&](int x) {
+                size_t cluster = row + x;
+                uint16_t& count = clusterCounts[cluster];
+                if (count < MAX_LIGHTS_PER_CLUSTER) {
+                    clusterLights[cluster * MAX_LIGHTS_PER_CLUSTER + count] = static_cast<uint16_t>(index);
+                }
+                if (count < UINT16_MAX) count++;
+            };
+
+#if LIGHTGRID_SSE
+            // Four clusters per test, rows are a multiple of four wide
+            const __m128 centerX = _mm_set1_ps(light.center.x);
+            const __m128 zero = _mm_setzero_ps();
+            const __m128 limit = _mm_set1_ps(radiusSq - rowDistSq);
+            for (int x = light.minX & ~3; x <= light.maxX; x += 4) {
+                __m128 below = _mm_sub_ps(_mm_loadu_ps(&minX[row + x]), centerX);
+                __m128 above = _mm_sub_ps(centerX, _mm_loadu_ps(&maxX[row + x]));
+                __m128 dx = _mm_max_ps(zero, _mm_max_ps(below, above));
+                int hits = _mm_movemask_ps(_mm_cmple_ps(_mm_mul_ps(dx, dx), limit));
+
+                for (int lane = 0; lane < 4; lane++) {
+                    int tile = x + lane;
+                    if ((hits >> lane & 1) && tile >= light.minX && tile <= light.maxX) append(tile);
+                }
+            }
+#else
+            for (int x = light.minX; x <= light.maxX; x++) {
+                float dx = std::max(0.0f, std::max(minX[row + x] - light.center.x, light.center.x - maxX[row + x]));
+                if (dx * dx + rowDistSq <= radiusSq) append(x);
+            }
+#endif
+        }
+    }
+}
@@ -16,8 +16,23 @@
 #include "scene.hpp"
 #include "gui.hpp"
 #include "mode.hpp"
+#include "arena.hpp"
+#include "renderer.hpp"
+#include "jobs.hpp"
+#include "profiler.hpp"
+#include "renderthread.hpp"
+#include "headless.hpp"
+#include "glstate.hpp"
+
+int main(int argc, char** argv) {
+    // === Headless run ===
+    // No window or editor, see HeadlessOptions::printUsage()
+    HeadlessOptions headless;
+    if (!headless.parse(argc, argv)) return 1;
+    if (headless.enabled) {
+        return HeadlessRunner(headless).run();
+    }
 
-int main() {
     // === Context setup ===
     Context context;
 
@@ -25,8 +40,7 @@ int main() {
     std::cout << "===Setting up window===" << std::endl;
     Window window("Game Engine", false);
     context.window = &window;
-    glEnable(GL_DEPTH_TEST);
-    glfwSwapInterval(1); // VSync
+    GLState::get().setEnabled(GL_DEPTH_TEST, true);
 
     // === Camera setup ===
     Camera editorCamera(static_cast<float>(window.getWidth()) / window.getHeight());
@@ -37,6 +51,10 @@ int main() {
     std::cout << "===Setting up GUI===" << std::endl;
     Gui gui(window);
 
+    // === Renderer setup ===
+    std::cout << "===Setting up renderer===" << std::endl;
+    Renderer renderer;
+
     // === Scene and objects ===
     std::cout << "===Initializing scene===" << std::endl;
     Scene editorScene;
@@ -63,11 +81,31 @@ int main() {
     const double timestep = 1.0 / 60.0;
     double accumulator = 0.0;
     double currentTime = glfwGetTime();
+    Profiler& profiler = Profiler::get();
+
+    // === Render thread setup ===
+    // The GL context moves to the render thread, this thread only records snapshots from here on
+    std::cout << "===Starting render thread===" << std::endl;
+    RenderThread& renderThread = RenderThread::get();
+    const GLFWvidmode* videoMode = glfwGetVideoMode(glfwGetPrimaryMonitor());
+    if (videoMode && videoMode->refreshRate > 0) {
+        renderThread.getPacer().setRefreshHz(static_cast<float>(videoMode->refreshRate));
+    }
+    renderThread.start(window, renderer);
 
     // Main render loop
     std::cout << "===Rendering===" << std::endl;
     while (!window.shouldClose()) {
+        profiler.beginFrame();
+
+        // === Frame pacing ===
+        // Waits for the cap or, in low latency, until just late enough to make the next refresh
+        profiler.beginScope("Pacing", false);
+        double inputTime = renderThread.getPacer().waitForInput();
+        profiler.endScope();
+
         // === Poll for events ===
+        profiler.beginScope("Input", false);
         window.pollEvents();
 
         double newTime = glfwGetTime();
@@ -85,10 +123,15 @@ int main() {
         gui.syncMouseFromGLFW(window.getGLFWwindow());
         gui.syncKeyboardFromGLFW(window.getGLFWwindow());
 
+        profiler.endScope();
+
         // === GUI begin ===
+        profiler.beginScope("GUI", false);
         gui.beginFrame();
+        profiler.endScope();
 
         // === Process input ===
+        profiler.beginScope("Input", false);
         while (accumulator >= timestep) {
             if (mode == Mode::Editor) {
                 Input::processEditorInput(window, editorCamera, playCamera, editorScene, playScene, mode);
@@ -97,29 +140,20 @@ int main() {
             }
             accumulator -= timestep;
         }
-
-        // === Flush screen ===
-        glClearColor(0.5f, 0.7f, 1.0f, 1.0f);
-        glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
-
-        // === OBB updating ===
-        for (auto& obj : editorScene.getObjects()) {
-            if (obj->transform.needsUpdate()) {
-                obj->updateOBB();
-            }
-        }
+        profiler.endScope();
 
         // === Editor mode ===
+        // GUI runs before recording, so anything it frees is never in this frame's snapshot
+        profiler.beginScope("GUI", false);
         if (mode == Mode::Editor) {
             context.camera = &editorCamera;
             context.scene = &editorScene;
 
-            editorScene.draw(editorCamera, false);
-
-            // === Draw editor GUI ===
-            gui.drawMainMenu(window, editorScene, playScene, editorCamera, playCamera, mode);
+            gui.drawMainMenu(window, editorScene, renderer, playScene, editorCamera, playCamera, mode);
             gui.drawSidebar(editorScene);
             gui.drawDeleteConfirmation(editorScene);
+            gui.drawProfiler();
+            gui.drawRenderGraph();
         }
 
         // === Playtest mode ===
@@ -131,28 +165,51 @@ int main() {
                 if (obj->isPlayer) {
                     obj->transform.position = playCamera.position; //- glm::vec3(0.0f, 0.0f, 0.0f);  TODO: Dynamically change camera position for object
                     obj->transform.rotation.y = -playCamera.yaw;
-                    obj->transform.markDirty();
+                    obj->markDirty();
                     break;
                 }
             }
 
-            playScene->draw(playCamera, true);
-
             gui.drawPlaytestUI();
 
             if (Object* cube = playScene->getObject("cube")) {
                 cube->transform.rotation.x = newTime * 15.0f;
                 cube->transform.rotation.y = newTime * 20.0f;
                 cube->transform.rotation.z = newTime * 5.0f;
-                cube->transform.markDirty();
+                cube->markDirty();
             }
         }
+        profiler.endScope();
+
+        // === OBB updating ===
+        profiler.beginScope("OBB update", false);
+        bool inPlaytest = mode == Mode::Playtest && playScene;
+        Scene& activeScene = inPlaytest ? *playScene : editorScene;
+        Camera& activeCamera = inPlaytest ? playCamera : editorCamera;
+        activeScene.updateBounds();
+        profiler.endScope();
+
+        // === Wait for a free snapshot, at most one frame is in flight ===
+        profiler.beginScope("Render wait", false);
+        FrameSnapshot& snapshot = renderThread.beginFrame();
+        profiler.endScope();
+
+        // === Record snapshot ===
+        profiler.beginScope("Scene record", false);
+        snapshot.width = window.getWidth();
+        snapshot.height = window.getHeight();
+        snapshot.inputTime = inputTime;
+        activeScene.draw(snapshot.scene, activeCamera, inPlaytest);
+        profiler.endScope();
 
         // === GUI end ===
-        gui.endFrame();
+        profiler.beginScope("GUI", false);
+        gui.endFrame(snapshot.gui);
+        profiler.endScope();
 
-        // === Buffer Swap and Events ===
-        window.swapBuffers();
+        // === Hand over to the render thread ===
+        renderThread.submit();
+        profiler.endFrame();
 
         // === Update camera aspect ratio ===
         editorCamera.setAspectRatio(static_cast<float>(window.getWidth()) / window.getHeight());
@@ -160,7 +217,13 @@ int main() {
     }
 
     // === Cleanup ===
+    renderThread.stop();
     gui.shutdown();
+    GeometryArena::get().shutdown();
+    MaterialBuffer::get().shutdown();
+    profiler.shutdown();
+    Profiler::getRender().shutdown();
+    JobSystem::get().shutdown();
 
     return 0;
 }
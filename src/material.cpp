@@ -0,0 +1,147 @@
+#include <glad/glad.h>
+#include <algorithm>
+#include <cstring>
+
+#include "material.hpp"
+#include "glstate.hpp"
+#include "renderthread.hpp"
+
+// === Constants ===
+static const size_t INITIAL_SLOTS = 64;
+static const size_t RETIRE_FRAMES = RenderThread::SNAPSHOT_COUNT; // Frames recorded before a release that may still be drawn
+
+// ### Material functions ###
+// === Constructors ===
+Material::Material(const std::string& name, Shader* shader, Texture* texture, const MaterialParams& params)
+    : name(name), shader(shader), texture(texture), params(params) {
+    slot = MaterialBuffer::get().allocate(params);
+}
+
+Material::Material(const Material& other, const std::string& name)
+    : Material(name, other.shader, other.texture, other.params) {}
+
+// === Deconstructor ===
+Material::~Material() {
+    MaterialBuffer::get().release(slot);
+}
+
+// === Getters ===
+unsigned int Material::getFeatures() const {
+    // Nothing to add, the variant without the specular terms draws the same
+    if (params.specularStrength <= 0.0f) return ~static_cast<unsigned int>(FEATURE_SPECULAR);
+    return ~0u;
+}
+
+// === Setters ===
+void Material::setParams(const MaterialParams& newParams) {
+    params = newParams;
+    MaterialBuffer::get().write(slot, params);
+}
+
+// ### MaterialBuffer functions ###
+// === Singleton access ===
+MaterialBuffer& MaterialBuffer::get() {
+    static MaterialBuffer instance;
+    return instance;
+}
+
+// === Slots ===
+unsigned int MaterialBuffer::allocate(const MaterialParams& params) {
+    std::lock_guard<std::mutex> lock(mutex);
+    unsigned int slot;
+    if (!freeSlots.empty()) {
+        slot = freeSlots.back();
+        freeSlots.pop_back();
+        blocks[slot] = params;
+    } else {
+        slot = static_cast<unsigned int>(blocks.size());
+        blocks.push_back(params);
+    }
+
+    dirtyFirst = dirtyFirst == dirtyEnd ? slot : std::min<size_t>(dirtyFirst, slot);
+    dirtyEnd = std::max<size_t>(dirtyEnd, slot + 1);
+    return slot;
+}
+
+void MaterialBuffer::release(unsigned int slot) {
+    // Frames already recorded may still bind the slot, it is reused once they are drawn
+    std::lock_guard<std::mutex> lock(mutex);
+    retiredSlots.push_back({slot, frame});
+}
+
+void MaterialBuffer::write(unsigned int slot, const MaterialParams& params) {
+    std::lock_guard<std::mutex> lock(mutex);
+    if (slot >= blocks.size()) return;
+    blocks[slot] = params;
+    dirtyFirst = dirtyFirst == dirtyEnd ? slot : std::min<size_t>(dirtyFirst, slot);
+    dirtyEnd = std::max<size_t>(dirtyEnd, slot + 1);
+}
+
+// === GPU side ===
+void MaterialBuffer::upload() {
+    std::vector<unsigned char> staging;
+    size_t first = 0;
+    bool grow = false;
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+
+        // Every frame recorded before these releases has started drawing with the old blocks,
+        // new contents written from now on reach the GPU with a later upload
+        frame++;
+        auto retired = std::stable_partition(retiredSlots.begin(), retiredSlots.end(),
+            [&](const std::pair<unsigned int, size_t>& slot) {return slot.second + RETIRE_FRAMES > frame;});
+        for (auto slot = retired; slot != retiredSlots.end(); ++slot) {
+            freeSlots.push_back(slot->first);
+        }
+        retiredSlots.erase(retired, retiredSlots.end());
+
+        if (stride == 0) {
+            GLint alignment = 0;
+            glGetIntegerv(GL_UNIFORM_BUFFER_OFFSET_ALIGNMENT, &alignment);
+            size_t align = std::max<size_t>(alignment, 1);
+            stride = (sizeof(MaterialParams) + align - 1) / align * align;
+        }
+
+        // A larger buffer is filled whole, otherwise only the changed slots go over
+        size_t end = dirtyEnd;
+        if (blocks.size() > capacity) {
+            grow = true;
+            capacity = std::max({blocks.size(), capacity * 2, INITIAL_SLOTS});
+            end = blocks.size();
+        } else if (dirtyFirst == dirtyEnd) {
+            return;
+        } else {
+            first = dirtyFirst;
+        }
+
+        staging.resize((end - first) * stride);
+        for (size_t i = first; i < end; i++) {
+            std::memcpy(staging.data() + (i - first) * stride, &blocks[i], sizeof(MaterialParams));
+        }
+        dirtyFirst = dirtyEnd = 0;
+    }
+
+    GLState& state = GLState::get();
+    if (!buffer) glGenBuffers(1, &buffer);
+    state.bindBuffer(GL_UNIFORM_BUFFER, buffer);
+    if (grow) glBufferData(GL_UNIFORM_BUFFER, capacity * stride, nullptr, GL_DYNAMIC_DRAW);
+    glBufferSubData(GL_UNIFORM_BUFFER, first * stride, staging.size(), staging.data());
+}
+
+void MaterialBuffer::bind(unsigned int slot) const {
+    if (!buffer || slot >= capacity) return;
+    GLState::get().bindBufferRange(GL_UNIFORM_BUFFER, BINDING, buffer, slot * stride, sizeof(MaterialParams));
+}
+
+void MaterialBuffer::shutdown() {
+    GLState::get().deleteBuffer(buffer);
+    std::lock_guard<std::mutex> lock(mutex);
+    capacity = 0;
+    stride = 0;
+}
+
+// === Getters ===
+size_t MaterialBuffer::getSlotCount() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    return blocks.size() - freeSlots.size() - retiredSlots.size();
+}
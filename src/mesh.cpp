@@ -13,24 +13,33 @@
 
 #include "scene.hpp"
 #include "mesh.hpp"
+#include "arena.hpp"
+#include "renderthread.hpp"
+#include "glstate.hpp"
+#include "jobs.hpp"
 
 // === Constructors ===
 Mesh::Mesh(const std::string& meshName, const std::vector<Vertex>& verts, const std::vector<unsigned int>& inds)
-    : name(meshName), vertices(verts), indices(inds) {
+    : name(meshName), vertices(verts), indices(inds), bvhState(std::make_shared<BVHState>()) {
+    bvhState->mesh = this;
     setupMesh(vertices, indices);
     indexCount = indices.size();
 }
 
 Mesh::Mesh(const Mesh& other)
-    : indexCount(other.indexCount), name(other.name), minBounds(other.minBounds), maxBounds(other.maxBounds), vertices(other.vertices), indices(other.indices) {
+    : indexCount(other.indexCount), name(other.name), minBounds(other.minBounds), maxBounds(other.maxBounds), vertices(other.vertices), indices(other.indices), bvhState(std::make_shared<BVHState>()) {
+    bvhState->mesh = this;
     setupMesh(vertices, indices);
 }
 
 // === Deconstructor ===
 Mesh::~Mesh() {
-    glDeleteVertexArrays(1, &VAO);
-    glDeleteBuffers(1, &VBO);
-    glDeleteBuffers(1, &EBO);
+    // Waits for a build in progress, one not started yet is skipped
+    {
+        std::lock_guard<std::mutex> lock(bvhState->mutex);
+        bvhState->mesh = nullptr;
+    }
+    RenderThread::get().run([this]() {GeometryArena::get().release(arenaHandle);});
 }
 
 // === OBB handling ===
@@ -50,46 +59,35 @@ void Mesh::calculateBounds(const std::vector<Vertex>& vertices) {
     }
 }
 
-// === Rendering ===
-void Mesh::draw() const {
-    glBindVertexArray(VAO);
-    glDrawElements(GL_TRIANGLES, (GLsizei)indexCount, GL_UNSIGNED_INT, 0);
-    glBindVertexArray(0);
+// === Picking ===
+void Mesh::requestBVH() const {
+    // Large meshes take a while, so loading starts the build off the UI thread
+    std::shared_ptr<BVHState> state = bvhState;
+    JobSystem::get().submit([state]() {
+        std::lock_guard<std::mutex> lock(state->mutex);
+        if (!state->mesh || state->bvh) return;
+        state->bvh = std::make_unique<MeshBVH>();
+        state->bvh->build(state->mesh->vertices, state->mesh->indices);
+    });
 }
 
-// === Internal setup ===
-void Mesh::setupMesh(const std::vector<Vertex>& vertices, const std::vector<unsigned int>& indices) {
-    glGenVertexArrays(1, &VAO);
-    glGenBuffers(1, &VBO);
-    glGenBuffers(1, &EBO);
-
-    glBindVertexArray(VAO);
-
-    // Vertex buffer
-    glBindBuffer(GL_ARRAY_BUFFER, VBO);
-    glBufferData(GL_ARRAY_BUFFER, vertices.size() * sizeof(Vertex), vertices.data(), GL_STATIC_DRAW);
-
-    // Element buffer
-    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, EBO);
-    glBufferData(GL_ELEMENT_ARRAY_BUFFER, indices.size() * sizeof(unsigned int), indices.data(), GL_STATIC_DRAW);
-
-    // Position attribute
-    glEnableVertexAttribArray(0);
-    glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, sizeof(Vertex), (void*)offsetof(Vertex, position));
-
-    // Color attribute
-    glEnableVertexAttribArray(1);
-    glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, sizeof(Vertex), (void*)offsetof(Vertex, color));
-
-    // Normal attribute
-    glEnableVertexAttribArray(2);
-    glVertexAttribPointer(2, 3, GL_FLOAT, GL_FALSE, sizeof(Vertex), (void*)offsetof(Vertex, normal));
+const MeshBVH& Mesh::getBVH() const {
+    std::lock_guard<std::mutex> lock(bvhState->mutex);
+    if (!bvhState->bvh) {
+        bvhState->bvh = std::make_unique<MeshBVH>();
+        bvhState->bvh->build(vertices, indices);
+    }
+    return *bvhState->bvh;
+}
 
-    // Texture attribute
-    glEnableVertexAttribArray(3);
-    glVertexAttribPointer(3, 2, GL_FLOAT, GL_FALSE, sizeof(Vertex), (void*)offsetof(Vertex, texCoords));
+bool Mesh::raycast(const glm::vec3& origin, const glm::vec3& dir, MeshHit& hit) const {
+    return getBVH().intersect(vertices, indices, origin, dir, hit);
+}
 
-    glBindVertexArray(0);
+// === Internal setup ===
+void Mesh::setupMesh(const std::vector<Vertex>& vertices, const std::vector<unsigned int>& indices) {
+    // Sub-allocate from the shared vertex/index buffers
+    RenderThread::get().run([&]() {arenaHandle = GeometryArena::get().allocate(vertices, indices);});
 }
 
 // === Loaders
@@ -134,6 +132,7 @@ Mesh* loadVertFile(const std::string& filepath) {
 
     Mesh* mesh = new Mesh(name, vertices, indices);
     mesh->calculateBounds(vertices);
+    mesh->requestBVH();
     return mesh;
 }
 
@@ -147,7 +146,7 @@ unsigned int loadTexture(const std::string& path) {
     if (data) {
         GLenum format = nrChannels == 3 ? GL_RGB : GL_RGBA;
 
-        glBindTexture(GL_TEXTURE_2D, textureID);
+        GLState::get().bindTexture(0, GL_TEXTURE_2D, textureID);
         glTexImage2D(GL_TEXTURE_2D, 0, format, width, height, 0, format, GL_UNSIGNED_BYTE, data);
         glGenerateMipmap(GL_TEXTURE_2D);
 
@@ -190,11 +189,8 @@ bool saveMesh(const std::string& name, const Mesh& mesh, const std::string& file
     }
     out.close();
 
-    if (scene.getMesh(name)) {
-        scene.removeMesh(name);
-    }
-
-    scene.addMesh(std::make_unique<Mesh>(*loadVertFile(filepath)));
+    // Replaces any existing mesh of the same name
+    scene.addMesh(std::unique_ptr<Mesh>(loadVertFile(filepath)));
 
     return true;
 }
\ No newline at end of file
@@ -0,0 +1,245 @@
+#include <algorithm>
+#include <cfloat>
+
+#include "meshbvh.hpp"
+#include "mesh.hpp"
+
+// === Constants ===
+static const int BIN_COUNT = 12;
+static const uint32_t LEAF_SIZE = 4;
+static const uint32_t MAX_LEAF_SIZE = 16;
+static const int MAX_DEPTH = 60;
+static const int STACK_SIZE = 64;
+static const float TRAVERSAL_COST = 1.0f;
+
+// === Internal helpers ===
+static float getSurfaceArea(const glm::vec3& min, const glm::vec3& max) {
+    glm::vec3 size = glm::max(max - min, glm::vec3(0.0f));
+    return 2.0f * (size.x * size.y + size.y * size.z + size.z * size.x);
+}
+
+// Slab test returning the entry distance, or FLT_MAX on a miss or past tMax
+static float getEntry(const glm::vec3& min, const glm::vec3& max, const glm::vec3& origin, const glm::vec3& invDir, float tMax) {
+    glm::vec3 t0 = (min - origin) * invDir;
+    glm::vec3 t1 = (max - origin) * invDir;
+    glm::vec3 tNear = glm::min(t0, t1);
+    glm::vec3 tFar = glm::max(t0, t1);
+    float enter = std::max(std::max(tNear.x, tNear.y), std::max(tNear.z, 0.0f));
+    float exit = std::min(std::min(tFar.x, tFar.y), std::min(tFar.z, tMax));
+    return enter <= exit ? enter : FLT_MAX;
+}
+
+// ### MeshBVH functions ###
+// === Building ===
+void MeshBVH::build(const std::vector<Vertex>& vertices, const std::vector<unsigned int>& indices) {
+    nodes.clear();
+    triangles.clear();
+    uint32_t count = static_cast<uint32_t>(indices.size() / 3);
+    if (count == 0) return;
+
+    std::vector<BuildTriangle> build(count);
+    triangles.resize(count);
+    for (uint32_t i = 0; i < count; i++) {
+        const glm::vec3& a = vertices[indices[i * 3]].position;
+        const glm::vec3& b = vertices[indices[i * 3 + 1]].position;
+        const glm::vec3& c = vertices[indices[i * 3 + 2]].position;
+        build[i].min = glm::min(a, glm::min(b, c));
+        build[i].max = glm::max(a, glm::max(b, c));
+        build[i].centroid = (a + b + c) / 3.0f;
+        triangles[i] = i;
+    }
+
+    nodes.reserve(count * 2 / LEAF_SIZE + 1);
+    buildRecursive(build, 0, count, 0);
+    nodes.shrink_to_fit();
+}
+
+// === Queries ===
+bool MeshBVH::intersect(const std::vector<Vertex>& vertices, const std::vector<unsigned int>& indices,
+                        const glm::vec3& origin, const glm::vec3& dir, MeshHit& hit) const {
+    if (nodes.empty()) return false;
+
+    glm::vec3 invDir = 1.0f / dir;
+    float closestT = FLT_MAX;
+    int closest = -1;
+    glm::vec2 closestUV(0.0f);
+
+    // Far children wait on the stack, the near one is visited straight away
+    uint32_t stack[STACK_SIZE];
+    int stackSize = 0;
+    uint32_t index = 0;
+    if (getEntry(nodes[0].min, nodes[0].max, origin, invDir, closestT) == FLT_MAX) return false;
+
+    while (true) {
+        const Node& node = nodes[index];
+        if (node.isLeaf()) {
+            for (uint32_t i = node.offset; i < node.offset + node.count; i++) {
+                uint32_t triangle = triangles[i];
+                const glm::vec3& a = vertices[indices[triangle * 3]].position;
+                const glm::vec3& b = vertices[indices[triangle * 3 + 1]].position;
+                const glm::vec3& c = vertices[indices[triangle * 3 + 2]].position;
+
+                // Moller-Trumbore, both faces count
+                glm::vec3 edge1 = b - a;
+                glm::vec3 edge2 = c - a;
+                glm::vec3 p = glm::cross(dir, edge2);
+                float det = glm::dot(edge1, p);
+                if (det == 0.0f) continue;
+                float invDet = 1.0f / det;
+                glm::vec3 s = origin - a;
+                float u = glm::dot(s, p) * invDet;
+                if (u < 0.0f || u > 1.0f) continue;
+                glm::vec3 q = glm::cross(s, edge1);
+                float v = glm::dot(dir, q) * invDet;
+                if (v < 0.0f || u + v > 1.0f) continue;
+                float t = glm::dot(edge2, q) * invDet;
+                if (t >= 0.0f && t < closestT) {
+                    closestT = t;
+                    closest = static_cast<int>(triangle);
+                    closestUV = glm::vec2(u, v);
+                }
+            }
+        } else {
+            uint32_t left = index + 1;
+            uint32_t right = node.offset;
+            float tLeft = getEntry(nodes[left].min, nodes[left].max, origin, invDir, closestT);
+            float tRight = getEntry(nodes[right].min, nodes[right].max, origin, invDir, closestT);
+            if (tLeft > tRight) {
+                std::swap(left, right);
+                std::swap(tLeft, tRight);
+            }
+            if (tLeft != FLT_MAX) {
+                if (tRight != FLT_MAX) stack[stackSize++] = right;
+                index = left;
+                continue;
+            }
+        }
+
+        // Pop the next subtree that can still hold something closer
+        bool found = false;
+        while (stackSize > 0 && !found) {
+            index = stack[--stackSize];
+            found = getEntry(nodes[index].min, nodes[index].max, origin, invDir, closestT) != FLT_MAX;
+        }
+        if (!found) break;
+    }
+
+    if (closest == -1) return false;
+    hit.t = closestT;
+    hit.point = origin + dir * closestT;
+    hit.triangle = closest;
+    hit.barycentrics = closestUV;
+    return true;
+}
+
+// === Internal building ===
+void MeshBVH::buildRecursive(std::vector<BuildTriangle>& build, uint32_t first, uint32_t count, int depth) {
+    uint32_t index = static_cast<uint32_t>(nodes.size());
+    nodes.push_back(Node());
+
+    glm::vec3 boundsMin(FLT_MAX), boundsMax(-FLT_MAX);
+    glm::vec3 centroidMin(FLT_MAX), centroidMax(-FLT_MAX);
+    for (uint32_t i = first; i < first + count; i++) {
+        const BuildTriangle& triangle = build[triangles[i]];
+        boundsMin = glm::min(boundsMin, triangle.min);
+        boundsMax = glm::max(boundsMax, triangle.max);
+        centroidMin = glm::min(centroidMin, triangle.centroid);
+        centroidMax = glm::max(centroidMax, triangle.centroid);
+    }
+    nodes[index].min = boundsMin;
+    nodes[index].max = boundsMax;
+
+    auto makeLeaf = [&]() {
+        nodes[index].offset = first;
+        nodes[index].count = count;
+    };
+    if (count <= LEAF_SIZE || depth >= MAX_DEPTH) {
+        makeLeaf();
+        return;
+    }
+
+    // Split along the axis the centroids spread the most
+    glm::vec3 extent = centroidMax - centroidMin;
+    int axis = extent.x > extent.y ? (extent.x > extent.z ? 0 : 2) : (extent.y > extent.z ? 1 : 2);
+    uint32_t leftCount = 0;
+
+    if (extent[axis] > 0.0f) {
+        // Binned SAH over the triangle centroids
+        struct Bin {
+            glm::vec3 min = glm::vec3(FLT_MAX);
+            glm::vec3 max = glm::vec3(-FLT_MAX);
+            uint32_t count = 0;
+        };
+        Bin bins[BIN_COUNT];
+        float scale = BIN_COUNT / extent[axis];
+        auto getBin = [&](const BuildTriangle& triangle) {
+            int bin = static_cast<int>((triangle.centroid[axis] - centroidMin[axis]) * scale);
+            return std::min(bin, BIN_COUNT - 1);
+        };
+        for (uint32_t i = first; i < first + count; i++) {
+            const BuildTriangle& triangle = build[triangles[i]];
+            Bin& bin = bins[getBin(triangle)];
+            bin.min = glm::min(bin.min, triangle.min);
+            bin.max = glm::max(bin.max, triangle.max);
+            bin.count++;
+        }
+
+        // Sweep from the right, then from the left evaluating each plane
+        float rightArea[BIN_COUNT];
+        uint32_t rightCount[BIN_COUNT];
+        glm::vec3 sweepMin(FLT_MAX), sweepMax(-FLT_MAX);
+        uint32_t sweepCount = 0;
+        for (int i = BIN_COUNT - 1; i > 0; i--) {
+            sweepMin = glm::min(sweepMin, bins[i].min);
+            sweepMax = glm::max(sweepMax, bins[i].max);
+            sweepCount += bins[i].count;
+            rightArea[i] = getSurfaceArea(sweepMin, sweepMax);
+            rightCount[i] = sweepCount;
+        }
+
+        float bestCost = FLT_MAX;
+        int bestSplit = -1;
+        sweepMin = glm::vec3(FLT_MAX);
+        sweepMax = glm::vec3(-FLT_MAX);
+        sweepCount = 0;
+        for (int i = 0; i < BIN_COUNT - 1; i++) {
+            sweepMin = glm::min(sweepMin, bins[i].min);
+            sweepMax = glm::max(sweepMax, bins[i].max);
+            sweepCount += bins[i].count;
+            if (sweepCount == 0 || rightCount[i + 1] == 0) continue;
+            float cost = getSurfaceArea(sweepMin, sweepMax) * sweepCount + rightArea[i + 1] * rightCount[i + 1];
+            if (cost < bestCost) {
+                bestCost = cost;
+                bestSplit = i;
+            }
+        }
+
+        // Small nodes stay leaves when splitting does not pay for the extra traversal
+        float leafCost = getSurfaceArea(boundsMin, boundsMax) * count;
+        float splitCost = getSurfaceArea(boundsMin, boundsMax) * TRAVERSAL_COST + bestCost;
+        if (count <= MAX_LEAF_SIZE && (bestSplit == -1 || leafCost <= splitCost)) {
+            makeLeaf();
+            return;
+        }
+
+        if (bestSplit != -1) {
+            uint32_t* middle = std::partition(triangles.data() + first, triangles.data() + first + count,
+                [&](uint32_t triangle) {return getBin(build[triangle]) <= bestSplit;});
+            leftCount = static_cast<uint32_t>(middle - (triangles.data() + first));
+        }
+    }
+
+    // Coincident centroids, split the run in half
+    if (leftCount == 0 || leftCount == count) {
+        if (count <= MAX_LEAF_SIZE) {
+            makeLeaf();
+            return;
+        }
+        leftCount = count / 2;
+    }
+
+    buildRecursive(build, first, leftCount, depth + 1);
+    nodes[index].offset = static_cast<uint32_t>(nodes.size());
+    nodes[index].count = 0;
+    buildRecursive(build, first + leftCount, count - leftCount, depth + 1);
+}
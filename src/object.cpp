@@ -3,11 +3,14 @@
 #define GLM_ENABLE_EXPERIMENTAL
 #include <glm/gtx/matrix_decompose.hpp>
 #include <glm/gtx/euler_angles.hpp>
+#include <algorithm>
+#include <cmath>
 #include <iostream>
 #include <ostream>
 
 #include "object.hpp"
 #include "camera.hpp"
+#include "commandbuffer.hpp"
 
 // ### Transform functions ###
 // === Update handling ===
@@ -19,7 +22,9 @@ bool Transform::needsUpdate() const {
 }
 
 // === Get transformed model ===
-glm::mat4 Transform::getModelMatrix() const {
+const glm::mat4& Transform::getModelMatrix() const {
+    if (!matrixDirty) return modelMatrix;
+
     glm::mat4 model = glm::mat4(1.0f);
 
     model = glm::translate(model, position);
@@ -28,7 +33,9 @@ glm::mat4 Transform::getModelMatrix() const {
     model = glm::rotate(model, glm::radians(rotation.z), glm::vec3(0, 0, 1));
     model = glm::scale(model, scale);
 
-    return model;
+    modelMatrix = model;
+    matrixDirty = false;
+    return modelMatrix;
 }
 
 void Transform::setFromModelMatrix(const glm::mat4& model) {
@@ -52,15 +59,21 @@ Object::Object(const std::string& name, const std::string& modelName, const std:
     std::string modelPath = "assets/models/" + modelName + ".vert";
     mesh = loadVertFile(modelPath);
     std::string texturePath = "assets/textures/" + textureName;
-    texture = new Texture(texturePath);
+    Texture* texture = new Texture(texturePath);
     std::string vertPath = "assets/shaders/" + shaderName + "/vertex.glsl";
     std::string fragPath = "assets/shaders/" + shaderName + "/fragment.glsl";
-    shader = new Shader(vertPath, fragPath, shaderName);
+    Shader* shader = new Shader(vertPath, fragPath, shaderName);
+    material = std::make_shared<Material>(name, shader, texture);
     Object::initializeOBB(mesh->getMinBounds(), mesh->getMaxBounds());
 } 
 
+Object::Object(const std::string& name, Mesh* mesh, std::shared_ptr<Material> material)
+    : name(name), mesh(mesh), material(std::move(material)) {
+    Object::initializeOBB(mesh->getMinBounds(), mesh->getMaxBounds());
+}
+
 Object::Object(const Object& other)
-    : name(other.name), mesh(other.mesh), shader(other.shader), texture(other.texture), textureScale(other.textureScale), transform(other.transform), obb(other.obb), parent(nullptr), children() {}
+    : name(other.name), isStatic(other.isStatic), mesh(other.mesh), material(other.material), textureScale(other.textureScale), light(other.light), transform(other.transform), obb(other.obb), parent(nullptr), children() {}
 
 // === OBB handling ===
 void Object::initializeOBB(const glm::vec3& meshMin, const glm::vec3& meshMax) {
@@ -86,24 +99,31 @@ void Object::updateOBB() {
         obb.axes[i] = glm::normalize(obb.axes[i]);
     }
     
-    // 2. Apply scale to extents (in local space)
+    // 2. Scale local extents by the world scale along each axis
+    // (the axis lengths already include this object's and its parents' scale)
     glm::vec3 localExtents = mesh->getMaxBounds() - localCenter;
-    obb.extents = localExtents * transform.scale;
-    
-    // 3. Transform extents to account for rotation
-    // (This handles non-uniform scaling correctly)
+    obb.extents = localExtents;
     obb.extents.x *= glm::length(glm::vec3(modelMatrix[0]));
     obb.extents.y *= glm::length(glm::vec3(modelMatrix[1]));
     obb.extents.z *= glm::length(glm::vec3(modelMatrix[2]));
 }
 
 // === Inheritance handling ===
-glm::mat4 Object::getWorldMatrix() const {
+const glm::mat4& Object::getWorldMatrix() const {
+    if (!worldDirty) return worldMatrix;
+
     if (parent) {
-        return parent->getWorldMatrix() * transform.getModelMatrix();
+        worldMatrix = parent->getWorldMatrix() * transform.getModelMatrix();
     } else {
-        return transform.getModelMatrix();
+        worldMatrix = transform.getModelMatrix();
     }
+    worldDirty = false;
+    return worldMatrix;
+}
+
+void Object::markDirty() {
+    transform.markDirty();
+    invalidateWorld();
 }
 
 void Object::setParent(Object* newParent) {
@@ -123,7 +143,7 @@ void Object::setParent(Object* newParent) {
     glm::mat4 parentWorldInverse = newParent ? glm::inverse(newParent->getWorldMatrix()) : glm::mat4(1.0f);
     glm::mat4 localMatrix = parentWorldInverse * worldMatrix;
     transform.setFromModelMatrix(localMatrix);
-    transform.markDirty();
+    markDirty();
 }
 
 bool Object::isDescendant(const Object* target) const {
@@ -135,6 +155,22 @@ bool Object::isDescendant(const Object* target) const {
     return false;
 }
 
+// === Picking ===
+bool Object::raycast(const glm::vec3& origin, const glm::vec3& dir, MeshHit& hit) const {
+    if (!mesh) return false;
+
+    // Into mesh space without renormalizing, so t stays the same along the world ray
+    glm::mat4 world = getWorldMatrix();
+    if (glm::determinant(world) == 0.0f) return false;
+    glm::mat4 toLocal = glm::inverse(world);
+    glm::vec3 localOrigin = glm::vec3(toLocal * glm::vec4(origin, 1.0f));
+    glm::vec3 localDir = glm::vec3(toLocal * glm::vec4(dir, 0.0f));
+    if (!mesh->raycast(localOrigin, localDir, hit)) return false;
+
+    hit.point = origin + dir * hit.t;
+    return true;
+}
+
 void getDescendants(Object* obj, std::vector<Object*>& out) {
     out.push_back(obj);
     for (Object* child : obj->children) {
@@ -142,43 +178,55 @@ void getDescendants(Object* obj, std::vector<Object*>& out) {
     }
 }
 
+// === Internal helpers ===
+void Object::invalidateWorld() {
+    // A subtree that is already dirty below here was dirtied along with this object
+    if (worldDirty) return;
+    worldDirty = true;
+    for (Object* child : children) {
+        child->invalidateWorld();
+    }
+}
+
+glm::mat3 computeNormalMatrix(const glm::mat4& model) {
+    const glm::mat3 linear(model);
+
+    // Rotation times uniform scale keeps normals pointing the right way, shaders renormalize
+    float lengthX = glm::dot(linear[0], linear[0]);
+    float lengthY = glm::dot(linear[1], linear[1]);
+    float lengthZ = glm::dot(linear[2], linear[2]);
+    float tolerance = 1e-4f * std::max(lengthX, std::max(lengthY, lengthZ));
+    bool uniformScale = std::abs(lengthX - lengthY) <= tolerance && std::abs(lengthX - lengthZ) <= tolerance
+        && std::abs(glm::dot(linear[0], linear[1])) <= tolerance
+        && std::abs(glm::dot(linear[0], linear[2])) <= tolerance
+        && std::abs(glm::dot(linear[1], linear[2])) <= tolerance;
+    if (uniformScale) return linear;
+
+    // Non-uniform scale or skew needs the inverse transpose
+    return glm::transpose(glm::inverse(linear));
+}
+
 // === Rendering ===
-void Object::draw(const Camera& camera, const Object* selectedObject, const bool inPlaytest) const {
+void Object::draw(CommandBuffer& buffer, const Object* selectedObject, const bool inPlaytest, unsigned int features) const {
     bool isHighlighted = (this == selectedObject) || (selectedObject && selectedObject->isDescendant(this));
 
-    if (!(inPlaytest && isPlayer)) {
-        shader->use();
-
-        // Set 3D model
-        shader->setMat4("model", getWorldMatrix());
-        shader->setMat4("view", camera.getViewMatrix());
-        shader->setMat4("projection", camera.getProjectionMatrix());
-
-        // Set lighting params
-        shader->setVec3("viewPos", camera.getPosition());
-        shader->setVec3("lightDir", glm::normalize(glm::vec3(-0.2f, -1.0f, -0.3f))); // Sunlight from above
-        shader->setVec3("lightColor", glm::vec3(1.0f, 1.0f, 1.0f)); // White sunlight
-        shader->setVec3("fogColor", glm::vec3(0.5f, 0.6f, 0.7f)); // Adjust to your desired fog color
-        shader->setFloat("fogStart", 50.0f);  // Distance where fog starts
-        shader->setFloat("fogEnd", 100.0f);   // Distance where fog fully saturates
-        shader->setBool("isSelected", isHighlighted);    // Whether or not object is selected
-
-        // Set texture
-        if (texture) {
-            texture->bind(0);
-            shader->setInt("texture1", 0);
-            shader->setVec2("textureScale", textureScale);
-        }
+    // Only highlighted objects need the tint compiled in, the material drops what its constants make useless
+    if (!isHighlighted) features &= ~FEATURE_HIGHLIGHT;
+    if (!material) return;
+    features &= material->getFeatures();
 
-        mesh->draw();
-    }
+    if (!(inPlaytest && isPlayer)) {
+        InstanceData instance;
+        instance.model = getWorldMatrix();
+        instance.normalMatrix = glm::mat3x4(computeNormalMatrix(instance.model));
+        instance.params = glm::vec4(textureScale, isHighlighted ? 1.0f : 0.0f, 0.0f);
 
-    for (const Object* child : children) {
-        child->draw(camera, selectedObject, inPlaytest);
+        Shader* shader = material->getShader();
+        buffer.submit(mesh, shader ? shader->getVariant(features) : nullptr, *material, instance);
     }
 }
 
-std::unique_ptr<Mesh> combineMeshes(const std::string& name, const std::vector<Object*>& objects) {
+std::unique_ptr<Mesh> combineMeshes(const std::string& name, const std::vector<Object*>& objects, bool bakeTextureScale) {
     std::vector<Vertex> combinedVertices;
     std::vector<unsigned int> combinedIndices;
 
@@ -186,6 +234,7 @@ std::unique_ptr<Mesh> combineMeshes(const std::string& name, const std::vector<O
 
     for (Object* obj : objects) {
         const glm::mat4 world = obj->getWorldMatrix();
+        const glm::mat3 normalMatrix = computeNormalMatrix(world);
         const std::vector<Vertex>& verts = obj->mesh->getVertices();
         const std::vector<unsigned int>& inds = obj->mesh->getIndices();
 
@@ -194,7 +243,12 @@ std::unique_ptr<Mesh> combineMeshes(const std::string& name, const std::vector<O
             glm::vec4 worldPos = world * glm::vec4(v.position, 1.0f);
             transformed.position = glm::vec3(worldPos);
 
-            // Transform normals?
+            if (glm::dot(v.normal, v.normal) > 0.0f) {
+                transformed.normal = glm::normalize(normalMatrix * v.normal);
+            }
+            if (bakeTextureScale) {
+                transformed.texCoords *= obj->textureScale;
+            }
             combinedVertices.push_back(transformed);
         }
 
@@ -205,5 +259,7 @@ std::unique_ptr<Mesh> combineMeshes(const std::string& name, const std::vector<O
         indexOffset += verts.size();
     }
 
-    return std::make_unique<Mesh>(name, combinedVertices, combinedIndices);
+    auto mesh = std::make_unique<Mesh>(name, combinedVertices, combinedIndices);
+    mesh->calculateBounds(combinedVertices);
+    return mesh;
 }
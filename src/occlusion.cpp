@@ -0,0 +1,320 @@
+#include <algorithm>
+#include <cmath>
+#include <cfloat>
+
+#if defined(__SSE2__)
+#include <immintrin.h>
+#define OCCLUSION_SSE 1
+#endif
+
+#include "occlusion.hpp"
+#include "jobs.hpp"
+
+// === Constants ===
+static const size_t TEST_BATCH = 64;
+static const int PYRAMID_TEST_TEXELS = 4;
+
+// === Constructor ===
+OcclusionCuller::OcclusionCuller(int width, int height)
+    : width(width), height(height) {
+    tilesX = (width + TILE_SIZE - 1) / TILE_SIZE;
+    tilesY = (height + TILE_SIZE - 1) / TILE_SIZE;
+    stride = tilesX * TILE_SIZE;
+
+    // Halve down to a single texel, padding rounds up so coarse texels stay conservative
+    glm::ivec2 size(stride, tilesY * TILE_SIZE);
+    while (true) {
+        pyramidSizes.push_back(size);
+        pyramid.emplace_back(size.x * size.y, 1.0f);
+        if (size.x == 1 && size.y == 1) break;
+        size = glm::max((size + 1) / 2, glm::ivec2(1));
+    }
+}
+
+// === Frame lifecycle ===
+void OcclusionCuller::beginFrame(const glm::mat4& viewProj) {
+    viewProjection = viewProj;
+    occluders.clear();
+    stats = OcclusionStats();
+}
+
+void OcclusionCuller::addOccluder(const Mesh& mesh, const glm::mat4& model) {
+    occluders.push_back({&mesh, viewProjection * model});
+}
+
+void OcclusionCuller::rasterize() {
+    JobSystem& jobs = JobSystem::get();
+    std::fill(pyramid[0].begin(), pyramid[0].end(), 1.0f);
+
+    // Transform, clip and bin every occluder in parallel
+    const size_t tileCount = static_cast<size_t>(tilesX * tilesY);
+    triangles.resize(occluders.size());
+    bins.resize(occluders.size());
+    for (auto& tileBins : bins) tileBins.resize(tileCount);
+    jobs.parallelFor(occluders.size(), [this](size_t i) {setupOccluder(i);});
+
+    stats.occluders = occluders.size();
+    for (size_t i = 0; i < occluders.size(); i++) {
+        stats.triangles += triangles[i].size();
+    }
+
+    // Each tile owns its pixels, so tiles rasterize without synchronization
+    if (stats.triangles > 0) {
+        jobs.parallelFor(tileCount, [this](size_t tile) {rasterizeTile(static_cast<int>(tile));});
+    }
+    buildPyramid();
+}
+
+// === Queries ===
+bool OcclusionCuller::isVisible(const OBB& obb) const {
+    if (stats.triangles == 0) return true;
+
+    glm::vec3 minScreen(FLT_MAX);
+    glm::vec3 maxScreen(-FLT_MAX);
+    for (int i = 0; i < 8; i++) {
+        glm::vec3 corner = obb.center
+            + obb.axes[0] * ((i & 1) ? obb.extents.x : -obb.extents.x)
+            + obb.axes[1] * ((i & 2) ? obb.extents.y : -obb.extents.y)
+            + obb.axes[2] * ((i & 4) ? obb.extents.z : -obb.extents.z);
+        glm::vec4 clip = viewProjection * glm::vec4(corner, 1.0f);
+
+        // Boxes crossing the near plane are always kept
+        if (clip.z < -clip.w) return true;
+
+        glm::vec3 ndc = glm::vec3(clip) / clip.w;
+        glm::vec3 screen((ndc.x * 0.5f + 0.5f) * width, (ndc.y * 0.5f + 0.5f) * height, ndc.z * 0.5f + 0.5f);
+        minScreen = glm::min(minScreen, screen);
+        maxScreen = glm::max(maxScreen, screen);
+    }
+
+    // Off screen is the frustum test's call, not ours
+    if (maxScreen.x < 0.0f || maxScreen.y < 0.0f || minScreen.x >= width || minScreen.y >= height) return true;
+
+    // Occluders cover a pixel when they cover its center, so grow the rectangle by half
+    // a pixel to always reach the first uncovered center past an occluder's edge
+    int x0 = std::max(0, static_cast<int>(std::floor(minScreen.x - 0.5f)));
+    int y0 = std::max(0, static_cast<int>(std::floor(minScreen.y - 0.5f)));
+    int x1 = std::min(width - 1, static_cast<int>(std::floor(maxScreen.x + 0.5f)));
+    int y1 = std::min(height - 1, static_cast<int>(std::floor(maxScreen.y + 0.5f)));
+
+    // Pick the level where the rectangle spans a handful of texels
+    int level = 0;
+    while (level + 1 < static_cast<int>(pyramid.size())
+        && ((x1 >> level) - (x0 >> level) >= PYRAMID_TEST_TEXELS || (y1 >> level) - (y0 >> level) >= PYRAMID_TEST_TEXELS)) {
+        level++;
+    }
+
+    // Hidden only if every covered texel's farthest occluder is nearer than the box
+    const std::vector<float>& texels = pyramid[level];
+    const int levelWidth = pyramidSizes[level].x;
+    for (int y = y0 >> level; y <= y1 >> level; y++) {
+        for (int x = x0 >> level; x <= x1 >> level; x++) {
+            if (texels[y * levelWidth + x] >= minScreen.z) return true;
+        }
+    }
+    return false;
+}
+
+size_t OcclusionCuller::cullOBBs(const std::vector<const OBB*>& boxes, std::vector<unsigned char>& visible) {
+    visible.resize(boxes.size());
+
+    size_t batches = (boxes.size() + TEST_BATCH - 1) / TEST_BATCH;
+    JobSystem::get().parallelFor(batches, [&](size_t batch) {
+        size_t end = std::min(boxes.size(), (batch + 1) * TEST_BATCH);
+        for (size_t i = batch * TEST_BATCH; i < end; i++) {
+            visible[i] = isVisible(*boxes[i]);
+        }
+    });
+
+    size_t visibleCount = 0;
+    for (unsigned char v : visible) visibleCount += v;
+    stats.tested += boxes.size();
+    stats.occluded += boxes.size() - visibleCount;
+    return visibleCount;
+}
+
+// === Internal helpers ===
+void OcclusionCuller::setupOccluder(size_t index) {
+    const Occluder& occluder = occluders[index];
+    std::vector<Triangle>& tris = triangles[index];
+    std::vector<std::vector<unsigned int>>& tileBins = bins[index];
+    tris.clear();
+    for (auto& bin : tileBins) bin.clear();
+
+    const std::vector<Vertex>& vertices = occluder.mesh->getVertices();
+    const std::vector<unsigned int>& indices = occluder.mesh->getIndices();
+
+    std::vector<glm::vec4> clip(vertices.size());
+    for (size_t i = 0; i < vertices.size(); i++) {
+        clip[i] = occluder.clipFromModel * glm::vec4(vertices[i].position, 1.0f);
+    }
+
+    auto emit = [&](const glm::vec4& a, const glm::vec4& b, const glm::vec4& c) {
+        Triangle tri;
+        const glm::vec4* in[3] = {&a, &b, &c};
+        for (int i = 0; i < 3; i++) {
+            glm::vec3 ndc = glm::vec3(*in[i]) / in[i]->w;
+            tri.v[i] = glm::vec3((ndc.x * 0.5f + 0.5f) * width, (ndc.y * 0.5f + 0.5f) * height, ndc.z * 0.5f + 0.5f);
+        }
+
+        // Both windings occlude, store counter-clockwise so edge tests are positive inside
+        glm::vec2 e1 = glm::vec2(tri.v[1] - tri.v[0]);
+        glm::vec2 e2 = glm::vec2(tri.v[2] - tri.v[0]);
+        float area = e1.x * e2.y - e1.y * e2.x;
+        if (std::fabs(area) < 1e-6f) return;
+        if (area < 0.0f) std::swap(tri.v[1], tri.v[2]);
+
+        glm::vec3 lo = glm::min(glm::min(tri.v[0], tri.v[1]), tri.v[2]);
+        glm::vec3 hi = glm::max(glm::max(tri.v[0], tri.v[1]), tri.v[2]);
+        int x0 = std::max(0, static_cast<int>(std::floor(lo.x)));
+        int y0 = std::max(0, static_cast<int>(std::floor(lo.y)));
+        int x1 = std::min(width - 1, static_cast<int>(std::floor(hi.x)));
+        int y1 = std::min(height - 1, static_cast<int>(std::floor(hi.y)));
+        if (x0 > x1 || y0 > y1) return;
+
+        unsigned int triIndex = static_cast<unsigned int>(tris.size());
+        tris.push_back(tri);
+        for (int ty = y0 / TILE_SIZE; ty <= y1 / TILE_SIZE; ty++) {
+            for (int tx = x0 / TILE_SIZE; tx <= x1 / TILE_SIZE; tx++) {
+                tileBins[ty * tilesX + tx].push_back(triIndex);
+            }
+        }
+    };
+
+    for (size_t i = 0; i + 2 < indices.size(); i += 3) {
+        glm::vec4 p[3] = {clip[indices[i]], clip[indices[i + 1]], clip[indices[i + 2]]};
+
+        // Trivially reject triangles entirely outside one clip plane
+        if ((p[0].x < -p[0].w && p[1].x < -p[1].w && p[2].x < -p[2].w)
+         || (p[0].x >  p[0].w && p[1].x >  p[1].w && p[2].x >  p[2].w)
+         || (p[0].y < -p[0].w && p[1].y < -p[1].w && p[2].y < -p[2].w)
+         || (p[0].y >  p[0].w && p[1].y >  p[1].w && p[2].y >  p[2].w)
+         || (p[0].z >  p[0].w && p[1].z >  p[1].w && p[2].z >  p[2].w)) {
+            continue;
+        }
+
+        // Clip against the near plane (z = -w), the other planes are handled by the screen bounds
+        glm::vec4 polygon[4];
+        int count = 0;
+        for (int j = 0; j < 3; j++) {
+            const glm::vec4& a = p[j];
+            const glm::vec4& b = p[(j + 1) % 3];
+            float da = a.z + a.w;
+            float db = b.z + b.w;
+            if (da >= 0.0f) polygon[count++] = a;
+            if ((da >= 0.0f) != (db >= 0.0f)) {
+                polygon[count++] = a + (b - a) * (da / (da - db));
+            }
+        }
+
+        for (int j = 1; j + 1 < count; j++) {
+            emit(polygon[0], polygon[j], polygon[j + 1]);
+        }
+    }
+}
+
+void OcclusionCuller::rasterizeTile(int tile) {
+    int tileX = (tile % tilesX) * TILE_SIZE;
+    int tileY = (tile / tilesX) * TILE_SIZE;
+    int tileMaxX = std::min(tileX + TILE_SIZE, width) - 1;
+    int tileMaxY = std::min(tileY + TILE_SIZE, height) - 1;
+
+    for (size_t o = 0; o < occluders.size(); o++) {
+        for (unsigned int index : bins[o][tile]) {
+            const Triangle& tri = triangles[o][index];
+            glm::vec3 lo = glm::min(glm::min(tri.v[0], tri.v[1]), tri.v[2]);
+            glm::vec3 hi = glm::max(glm::max(tri.v[0], tri.v[1]), tri.v[2]);
+            rasterizeTriangle(tri,
+                std::max(tileX, static_cast<int>(std::floor(lo.x))),
+                std::max(tileY, static_cast<int>(std::floor(lo.y))),
+                std::min(tileMaxX, static_cast<int>(std::floor(hi.x))),
+                std::min(tileMaxY, static_cast<int>(std::floor(hi.y))));
+        }
+    }
+}
+
+void OcclusionCuller::rasterizeTriangle(const Triangle& tri, int minX, int minY, int maxX, int maxY) {
+    if (minX > maxX || minY > maxY) return;
+
+    // Edge functions E(x, y) = A * x + B * y + C, positive inside
+    float A[3], B[3], C[3];
+    for (int i = 0; i < 3; i++) {
+        const glm::vec3& v0 = tri.v[i];
+        const glm::vec3& v1 = tri.v[(i + 1) % 3];
+        A[i] = v0.y - v1.y;
+        B[i] = v1.x - v0.x;
+        C[i] = -(A[i] * v0.x + B[i] * v0.y);
+    }
+
+    // Depth plane z(x, y) = zA * x + zB * y + zC, raised to the farthest depth within each pixel
+    glm::vec3 e1 = tri.v[1] - tri.v[0];
+    glm::vec3 e2 = tri.v[2] - tri.v[0];
+    float area = e1.x * e2.y - e1.y * e2.x;
+    float zA = (e1.z * e2.y - e2.z * e1.y) / area;
+    float zB = (e2.z * e1.x - e1.z * e2.x) / area;
+    float zC = tri.v[0].z - zA * tri.v[0].x - zB * tri.v[0].y + 0.5f * (std::fabs(zA) + std::fabs(zB));
+
+    float* depth = pyramid[0].data();
+
+#if OCCLUSION_SSE
+    // 4 pixels per step, tiles are 4-aligned so lanes never leave the tile
+    const __m128 laneOffsets = _mm_setr_ps(0.5f, 1.5f, 2.5f, 3.5f);
+    const __m128 zero = _mm_setzero_ps();
+    const int startX = minX & ~3;
+
+    for (int y = minY; y <= maxY; y++) {
+        float py = y + 0.5f;
+        __m128 rowE0 = _mm_set1_ps(B[0] * py + C[0]);
+        __m128 rowE1 = _mm_set1_ps(B[1] * py + C[1]);
+        __m128 rowE2 = _mm_set1_ps(B[2] * py + C[2]);
+        __m128 rowZ = _mm_set1_ps(zB * py + zC);
+        float* row = depth + y * stride;
+
+        for (int x = startX; x <= maxX; x += 4) {
+            __m128 px = _mm_add_ps(_mm_set1_ps(static_cast<float>(x)), laneOffsets);
+            __m128 e0 = _mm_add_ps(_mm_mul_ps(_mm_set1_ps(A[0]), px), rowE0);
+            __m128 e1 = _mm_add_ps(_mm_mul_ps(_mm_set1_ps(A[1]), px), rowE1);
+            __m128 e2 = _mm_add_ps(_mm_mul_ps(_mm_set1_ps(A[2]), px), rowE2);
+            __m128 inside = _mm_and_ps(_mm_and_ps(_mm_cmpge_ps(e0, zero), _mm_cmpge_ps(e1, zero)), _mm_cmpge_ps(e2, zero));
+            if (_mm_movemask_ps(inside) == 0) continue;
+
+            __m128 z = _mm_add_ps(_mm_mul_ps(_mm_set1_ps(zA), px), rowZ);
+            __m128 current = _mm_loadu_ps(row + x);
+            __m128 nearest = _mm_min_ps(current, z);
+            _mm_storeu_ps(row + x, _mm_or_ps(_mm_and_ps(inside, nearest), _mm_andnot_ps(inside, current)));
+        }
+    }
+#else
+    for (int y = minY; y <= maxY; y++) {
+        float py = y + 0.5f;
+        float* row = depth + y * stride;
+        for (int x = minX; x <= maxX; x++) {
+            float px = x + 0.5f;
+            if (A[0] * px + B[0] * py + C[0] < 0.0f) continue;
+            if (A[1] * px + B[1] * py + C[1] < 0.0f) continue;
+            if (A[2] * px + B[2] * py + C[2] < 0.0f) continue;
+            row[x] = std::min(row[x], zA * px + zB * py + zC);
+        }
+    }
+#endif
+}
+
+void OcclusionCuller::buildPyramid() {
+    for (size_t level = 1; level < pyramid.size(); level++) {
+        const std::vector<float>& src = pyramid[level - 1];
+        std::vector<float>& dst = pyramid[level];
+        glm::ivec2 srcSize = pyramidSizes[level - 1];
+        glm::ivec2 dstSize = pyramidSizes[level];
+
+        for (int y = 0; y < dstSize.y; y++) {
+            int sy0 = y * 2;
+            int sy1 = std::min(sy0 + 1, srcSize.y - 1);
+            for (int x = 0; x < dstSize.x; x++) {
+                int sx0 = x * 2;
+                int sx1 = std::min(sx0 + 1, srcSize.x - 1);
+                dst[y * dstSize.x + x] = std::max(std::max(src[sy0 * srcSize.x + sx0], src[sy0 * srcSize.x + sx1]),
+                                                  std::max(src[sy1 * srcSize.x + sx0], src[sy1 * srcSize.x + sx1]));
+            }
+        }
+    }
+}
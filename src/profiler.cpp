@@ -0,0 +1,266 @@
+#include <glad/glad.h>
+#include <algorithm>
+#include <iostream>
+
+#include "profiler.hpp"
+
+// === Constants ===
+static const double AVERAGE_WEIGHT = 0.05;
+
+// Timeline bound to the calling thread
+static thread_local Profiler* threadProfiler = nullptr;
+
+// === Singleton access ===
+Profiler& Profiler::get() {
+    static Profiler instance(false);
+    return instance;
+}
+
+Profiler& Profiler::getRender() {
+    static Profiler instance(true);
+    return instance;
+}
+
+Profiler& Profiler::forThread() {
+    return threadProfiler ? *threadProfiler : get();
+}
+
+void Profiler::bindToThread() {
+    threadProfiler = this;
+}
+
+// === Constructor ===
+Profiler::Profiler(bool gpuCapable)
+    : gpuCapable(gpuCapable), cpuHistory(HISTORY_SIZE, 0.0f), gpuHistory(HISTORY_SIZE, 0.0f) {}
+
+// === Frame lifecycle ===
+void Profiler::beginFrame() {
+    if (!initialized) {
+        // Timestamp queries are core since 3.3, and need the thread owning the context
+        std::lock_guard<std::mutex> lock(resultsMutex);
+        gpuTimers = gpuCapable && GLAD_GL_VERSION_3_3;
+        initialized = true;
+        std::cout << "Profiler " << (gpuTimers ? "using GPU timestamp queries" : "running CPU-only") << std::endl;
+    }
+
+    // Reusing a frame the GPU never finished loses its results instead of waiting
+    current = (current + 1) % FRAME_COUNT;
+    Frame& frame = frames[current];
+    if (frame.pending) {
+        if (isAvailable(frame)) {
+            resolve(frame);
+        } else {
+            frame.pending = false;
+            std::lock_guard<std::mutex> lock(resultsMutex);
+            droppedFrames++;
+        }
+    }
+
+    frame.scopes.clear();
+    frame.queryCount = 0;
+    openScopes.clear();
+    recording = true;
+
+    // Frame bounds are scope zero
+    frame.start = Clock::now();
+    frame.scopes.push_back({"Frame", -1, frame.start, frame.start, gpuTimers ? timestamp(frame) : -1, -1});
+}
+
+void Profiler::endFrame() {
+    if (!recording) return;
+    while (!openScopes.empty()) endScope();
+
+    Frame& frame = frames[current];
+    frame.end = Clock::now();
+    frame.scopes[0].end = frame.end;
+    if (gpuTimers) frame.scopes[0].queryEnd = timestamp(frame);
+    frame.pending = true;
+    recording = false;
+
+    if (!gpuTimers) {
+        resolve(frame);
+        return;
+    }
+    resolveAvailable();
+}
+
+// === Scope handling ===
+void Profiler::beginScope(const char* name, bool gpu) {
+    if (!recording) return;
+    Frame& frame = frames[current];
+
+    Scope scope;
+    scope.name = name;
+    scope.depth = static_cast<int>(openScopes.size());
+    scope.start = Clock::now();
+    if (gpu && gpuTimers) scope.queryBegin = timestamp(frame);
+
+    openScopes.push_back(static_cast<int>(frame.scopes.size()));
+    frame.scopes.push_back(scope);
+}
+
+void Profiler::endScope() {
+    if (!recording || openScopes.empty()) return;
+    Frame& frame = frames[current];
+
+    Scope& scope = frame.scopes[openScopes.back()];
+    openScopes.pop_back();
+    scope.end = Clock::now();
+    if (scope.queryBegin != -1) scope.queryEnd = timestamp(frame);
+}
+
+// === Results ===
+std::vector<ProfileResult> Profiler::getResults() const {
+    std::lock_guard<std::mutex> lock(resultsMutex);
+    return results;
+}
+
+std::optional<ProfileResult> Profiler::getResult(const std::string& name) const {
+    std::lock_guard<std::mutex> lock(resultsMutex);
+    for (const ProfileResult& result : results) {
+        if (result.name == name) return result;
+    }
+    return std::nullopt;
+}
+
+double Profiler::getFrameCpuMs() const {
+    std::lock_guard<std::mutex> lock(resultsMutex);
+    return frameCpuMs;
+}
+
+double Profiler::getFrameGpuMs() const {
+    std::lock_guard<std::mutex> lock(resultsMutex);
+    return frameGpuMs;
+}
+
+size_t Profiler::getResolvedFrames() const {
+    std::lock_guard<std::mutex> lock(resultsMutex);
+    return resolvedFrames;
+}
+
+size_t Profiler::getDroppedFrames() const {
+    std::lock_guard<std::mutex> lock(resultsMutex);
+    return droppedFrames;
+}
+
+bool Profiler::hasGpuTimers() const {
+    std::lock_guard<std::mutex> lock(resultsMutex);
+    return gpuTimers;
+}
+
+std::vector<float> Profiler::getCpuHistory() const {
+    std::lock_guard<std::mutex> lock(resultsMutex);
+    return cpuHistory;
+}
+
+std::vector<float> Profiler::getGpuHistory() const {
+    std::lock_guard<std::mutex> lock(resultsMutex);
+    return gpuHistory;
+}
+
+int Profiler::getHistoryOffset() const {
+    std::lock_guard<std::mutex> lock(resultsMutex);
+    return historyOffset;
+}
+
+// === Shutdown ===
+void Profiler::shutdown() {
+    for (Frame& frame : frames) {
+        if (!frame.queries.empty()) {
+            glDeleteQueries(static_cast<GLsizei>(frame.queries.size()), frame.queries.data());
+        }
+        frame.queries.clear();
+        frame.pending = false;
+    }
+    recording = false;
+}
+
+// === Internal helpers ===
+int Profiler::timestamp(Frame& frame) {
+    if (frame.queryCount == frame.queries.size()) {
+        unsigned int query;
+        glGenQueries(1, &query);
+        frame.queries.push_back(query);
+    }
+
+    int index = static_cast<int>(frame.queryCount++);
+    glQueryCounter(frame.queries[index], GL_TIMESTAMP);
+    return index;
+}
+
+bool Profiler::isAvailable(const Frame& frame) const {
+    if (frame.queryCount == 0) return true;
+
+    // Queries complete in order, so the last one stands for the whole frame
+    GLint available = 0;
+    glGetQueryObjectiv(frame.queries[frame.queryCount - 1], GL_QUERY_RESULT_AVAILABLE, &available);
+    return available != 0;
+}
+
+void Profiler::resolve(Frame& frame) {
+    frame.pending = false;
+
+    std::vector<GLuint64> stamps(frame.queryCount);
+    for (size_t i = 0; i < frame.queryCount; i++) {
+        glGetQueryObjectui64v(frame.queries[i], GL_QUERY_RESULT, &stamps[i]);
+    }
+    auto gpuMs = [&](const Scope& scope) {
+        if (scope.queryBegin == -1 || scope.queryEnd == -1) return -1.0;
+        return static_cast<double>(stamps[scope.queryEnd] - stamps[scope.queryBegin]) * 1e-6;
+    };
+    auto cpuMs = [](const Scope& scope) {
+        return std::chrono::duration<double, std::milli>(scope.end - scope.start).count();
+    };
+
+    // Sum repeated scopes by name, in first-seen order
+    std::lock_guard<std::mutex> lock(resultsMutex);
+    results.clear();
+    for (size_t i = 1; i < frame.scopes.size(); i++) {
+        const Scope& scope = frame.scopes[i];
+        ProfileResult* result = nullptr;
+        for (ProfileResult& existing : results) {
+            if (existing.name == scope.name) result = &existing;
+        }
+        if (!result) {
+            results.push_back(ProfileResult());
+            result = &results.back();
+            result->name = scope.name;
+            result->depth = scope.depth;
+        }
+
+        result->cpuMs += cpuMs(scope);
+        double gpu = gpuMs(scope);
+        if (gpu >= 0.0) result->gpuMs = std::max(result->gpuMs, 0.0) + gpu;
+    }
+
+    // Smooth each pass so the table is readable
+    for (ProfileResult& result : results) {
+        auto it = averages.find(result.name);
+        if (it == averages.end()) {
+            result.cpuAverageMs = result.cpuMs;
+            result.gpuAverageMs = result.gpuMs;
+        } else {
+            result.cpuAverageMs = it->second.cpuAverageMs + (result.cpuMs - it->second.cpuAverageMs) * AVERAGE_WEIGHT;
+            result.gpuAverageMs = result.gpuMs < 0.0 ? -1.0 : it->second.gpuAverageMs < 0.0 ? result.gpuMs
+                : it->second.gpuAverageMs + (result.gpuMs - it->second.gpuAverageMs) * AVERAGE_WEIGHT;
+        }
+        averages[result.name] = result;
+    }
+
+    frameCpuMs = cpuMs(frame.scopes[0]);
+    frameGpuMs = gpuMs(frame.scopes[0]);
+    cpuHistory[historyOffset] = static_cast<float>(frameCpuMs);
+    gpuHistory[historyOffset] = static_cast<float>(std::max(frameGpuMs, 0.0));
+    historyOffset = (historyOffset + 1) % HISTORY_SIZE;
+    resolvedFrames++;
+}
+
+void Profiler::resolveAvailable() {
+    // Walk pending frames oldest first and stop at the first one still in flight
+    for (int i = 1; i <= FRAME_COUNT; i++) {
+        Frame& frame = frames[(current + i) % FRAME_COUNT];
+        if (!frame.pending) continue;
+        if (!isAvailable(frame)) break;
+        resolve(frame);
+    }
+}
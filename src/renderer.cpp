@@ -0,0 +1,354 @@
+#include <glad/glad.h>
+#include <algorithm>
+#include <cmath>
+#include <iostream>
+#include <cstring>
+
+#include "renderer.hpp"
+#include "profiler.hpp"
+#include "texturestreamer.hpp"
+#include "glstate.hpp"
+
+// === Constants ===
+static const size_t INITIAL_FRAME_BYTES = 1 << 20;
+
+// ### RenderFrame functions ###
+// === Recording ===
+void RenderFrame::begin(const Camera& camera, size_t bufferCount) {
+    view = camera.getViewMatrix();
+    projection = camera.getProjectionMatrix();
+    viewPos = camera.getPosition();
+    nearPlane = camera.getNear();
+    farPlane = camera.getFar();
+    lights.clear();
+
+    buffers.resize(bufferCount);
+    for (CommandBuffer& buffer : buffers) {
+        buffer.begin(view);
+    }
+}
+
+void RenderFrame::submitLight(const Light& light, const glm::vec3& position, const glm::vec3& direction) {
+    GpuLight gpuLight;
+    gpuLight.positionRange = glm::vec4(position, light.range);
+    gpuLight.colorType = glm::vec4(light.color * light.intensity, light.type == LightType::Spot ? 1.0f : 0.0f);
+
+    float cosInner = std::cos(glm::radians(light.innerAngle));
+    float cosOuter = std::cos(glm::radians(std::max(light.outerAngle, light.innerAngle)));
+    gpuLight.directionSpot = glm::vec4(direction, cosOuter);
+    gpuLight.spotParams = glm::vec4(1.0f / std::max(cosInner - cosOuter, 1e-4f), 0.0f, 0.0f, 0.0f);
+    lights.push_back(gpuLight);
+}
+
+// ### Renderer functions ###
+// === Constructor ===
+Renderer::Renderer()
+    : frameData(INITIAL_FRAME_BYTES) {
+    // glMultiDrawElementsIndirect is core in 4.3, older contexts loop instead
+    multiDrawIndirect = GLAD_GL_VERSION_4_3;
+    std::cout << "Renderer using " << (multiDrawIndirect ? "multi-draw indirect" : "per-command fallback") << " submission" << std::endl;
+
+    // Compute culling needs 4.3, storage buffer ranges its offset alignment
+    if (GpuCuller::isSupported()) {
+        culler = std::make_unique<GpuCuller>();
+        GLint alignment = 0;
+        glGetIntegerv(GL_SHADER_STORAGE_BUFFER_OFFSET_ALIGNMENT, &alignment);
+        instanceAlignment = std::max<size_t>(instanceAlignment, alignment);
+        std::cout << "Renderer GPU culling available, " << (culler->usesDrawCount() ? "compacted with draw counts" : "without draw counts") << std::endl;
+    }
+
+    // Position-only program for the depth pre-pass
+    depthShader = std::make_unique<Shader>("assets/shaders/depth/vertex.glsl", "assets/shaders/depth/fragment.glsl", "depth");
+    for (OverdrawQuery& query : queries) {
+        glGenQueries(1, &query.id);
+    }
+}
+
+// === Deconstructor ===
+Renderer::~Renderer() {
+    for (OverdrawQuery& query : queries) {
+        glDeleteQueries(1, &query.id);
+    }
+}
+
+// === Frame lifecycle ===
+bool Renderer::beginFrame(const RenderFrame& frame) {
+    // One thread translates every recorded buffer
+    stream.merge(frame.buffers);
+
+    // Screen sizes for the texture streamer, which updates before the passes run
+    TextureStreamer& streamer = TextureStreamer::get();
+    for (const TextureUse& use : stream.getTextureUses()) {
+        streamer.request(use.texture, use.size * frame.projection[1][1]);
+    }
+
+    stats = RenderStats();
+    stats.items = stream.getInstances().size();
+    stats.batches = stream.getRunCount();
+    stats.commands = stream.getDraws().size();
+    if (stream.getDraws().empty()) return false;
+
+    {
+        ProfileScope scope("Light binning");
+        lightGrid.build(frame.lights, frame.view, frame.projection, frame.nearPlane, frame.farPlane);
+    }
+    lightGrid.upload();
+    lightGrid.bind();
+
+    // Constants of materials created or edited since the last frame
+    MaterialBuffer::get().upload();
+
+    frameData.beginFrame();
+    if (!upload()) {
+        frameData.endFrame();
+        return false;
+    }
+
+    // Stays bound through the graph, other passes restore their own bindings
+    GeometryArena& arena = GeometryArena::get();
+    arena.bind();
+
+    // Culled survivors replace the frame's instances, the culler owns the commands then
+    cullingThisFrame = frame.gpuCulling && culler;
+    viewProjection = frame.projection * frame.view;
+    if (cullingThisFrame) {
+        ProfileScope scope("GPU culling");
+        culler->cull(stream, frameData.getID(), instanceOffset, viewProjection);
+        instanceBuffer = culler->getInstanceBuffer();
+        instanceBase = 0;
+    } else {
+        instanceBuffer = frameData.getID();
+        instanceBase = instanceOffset;
+    }
+    bindInstanceAttributes(0);
+
+    if (multiDrawIndirect && !cullingThisFrame) {
+        GLState::get().bindBuffer(GL_DRAW_INDIRECT_BUFFER, frameData.getID());
+    }
+
+    currentFrame = &frame;
+    prepassThisFrame = depthPrepass;
+    return true;
+}
+
+void Renderer::addPasses(RenderGraph& graph, const std::string& color, const std::string& depth) {
+    if (!currentFrame) return;
+
+    // Lay down depth first so the main pass only shades visible fragments
+    if (prepassThisFrame) {
+        graph.addPass("Depth prepass", [this](const RenderGraph&) {drawDepthPrepass();})
+            .write(depth);
+        graph.addPass("Opaque", [this](const RenderGraph&) {drawOpaque();})
+            .read(depth, ReadAccess::Attachment)
+            .write(color);
+    } else {
+        graph.addPass("Opaque", [this](const RenderGraph&) {drawOpaque();})
+            .write(color)
+            .write(depth);
+    }
+
+    // Next frame's occlusion test reads this frame's depth, nothing in the graph does
+    if (needsSampledDepth()) {
+        graph.addPass("Hi-Z", [this, depth](const RenderGraph& compiled) {buildHiZ(compiled, depth);})
+            .read(depth)
+            .keepAlive();
+    }
+}
+
+bool Renderer::needsSampledDepth() const {
+    return currentFrame && cullingThisFrame && culler->getOcclusion();
+}
+
+void Renderer::endFrame() {
+    if (!currentFrame) return;
+    currentFrame = nullptr;
+    cullingThisFrame = false;
+
+    if (multiDrawIndirect) {
+        GLState::get().bindBuffer(GL_DRAW_INDIRECT_BUFFER, 0);
+    }
+    GLState::get().bindVertexArray(0);
+
+    // Fence this frame's region so it is not rewritten while in flight
+    frameData.endFrame();
+}
+
+// === Backend ===
+void Renderer::bindProgram(Shader* shader) {
+    shader->use();
+    setFrameUniforms(*shader, *currentFrame);
+    currentProgram = shader;
+}
+
+void Renderer::bindMaterial(unsigned int material, Texture* texture) {
+    MaterialBuffer::get().bind(material);
+    if (!texture) return;
+    texture->bind(0);
+    if (currentProgram) currentProgram->setInt("texture1", 0);
+}
+
+void Renderer::draw(size_t firstCommand, size_t commandCount) {
+    drawCommands(firstCommand, commandCount);
+}
+
+// === Internal helpers ===
+bool Renderer::upload() {
+    const std::vector<InstanceData>& instances = stream.getInstances();
+    const std::vector<DrawElementsIndirectCommand>& commands = stream.getDraws();
+    size_t instanceBytes = instances.size() * sizeof(InstanceData);
+    size_t commandBytes = multiDrawIndirect ? commands.size() * sizeof(DrawElementsIndirectCommand) : 0;
+    frameData.reserve(instanceBytes + commandBytes + instanceAlignment + sizeof(glm::vec4));
+
+    // Write straight into the mapped ring, no driver copies
+    void* instanceDst = frameData.allocate(instanceBytes, instanceAlignment, instanceOffset);
+    if (!instanceDst) return false;
+    std::memcpy(instanceDst, instances.data(), instanceBytes);
+
+    if (multiDrawIndirect) {
+        void* commandDst = frameData.allocate(commandBytes, sizeof(glm::vec4), commandOffset);
+        if (!commandDst) return false;
+        std::memcpy(commandDst, commands.data(), commandBytes);
+    }
+
+    frameData.flush();
+    return true;
+}
+
+void Renderer::drawCommands(size_t firstCommand, size_t commandCount) {
+    if (cullingThisFrame) {
+        stats.drawCalls += culler->draw(firstCommand, commandCount);
+    } else if (multiDrawIndirect) {
+        const void* offset = (const void*)(commandOffset + firstCommand * sizeof(DrawElementsIndirectCommand));
+        glMultiDrawElementsIndirect(GL_TRIANGLES, GL_UNSIGNED_INT, offset, (GLsizei)commandCount, 0);
+        stats.drawCalls++;
+    } else {
+        // GL 3.3 has no base instance, so re-point the instance attributes per command
+        for (size_t i = firstCommand; i < firstCommand + commandCount; i++) {
+            const DrawElementsIndirectCommand& cmd = stream.getDraws()[i];
+            bindInstanceAttributes(cmd.baseInstance);
+            glDrawElementsInstancedBaseVertex(GL_TRIANGLES, (GLsizei)cmd.count, GL_UNSIGNED_INT,
+                (const void*)(cmd.firstIndex * sizeof(unsigned int)), (GLsizei)cmd.instanceCount, cmd.baseVertex);
+            stats.drawCalls++;
+        }
+    }
+}
+
+void Renderer::drawDepthPrepass() {
+    // Every opaque command in one go, no textures or lighting needed.
+    // The graph turns color writes off for a depth-only pass.
+    depthShader->use();
+    depthShader->setMat4("view", currentFrame->view);
+    depthShader->setMat4("projection", currentFrame->projection);
+
+    size_t drawCalls = stats.drawCalls;
+    drawCommands(0, stream.getDraws().size());
+    stats.depthDrawCalls = stats.drawCalls - drawCalls;
+    stats.drawCalls = drawCalls;
+}
+
+void Renderer::drawOpaque() {
+    // Depth is already final after a pre-pass, the graph keeps it read-only
+    if (prepassThisFrame) {
+        GLState::get().setDepthFunc(GL_EQUAL);
+    }
+
+    // Count shaded fragments, results are read back once ready
+    resolveOverdraw();
+    OverdrawQuery& query = queries[currentQuery];
+    GLint viewport[4];
+    glGetIntegerv(GL_VIEWPORT, viewport);
+    viewportSize = glm::vec2(viewport[2], viewport[3]);
+    query.pixels = static_cast<size_t>(viewport[2]) * viewport[3];
+    glBeginQuery(GL_SAMPLES_PASSED, query.id);
+
+    currentProgram = nullptr;
+    stream.replay(*this);
+
+    glEndQuery(GL_SAMPLES_PASSED);
+    query.pending = true;
+    currentQuery = (currentQuery + 1) % QUERY_COUNT;
+
+    if (prepassThisFrame) {
+        GLState::get().setDepthFunc(GL_LESS);
+    }
+}
+
+void Renderer::buildHiZ(const RenderGraph& graph, const std::string& depth) {
+    unsigned int texture = graph.getTexture(depth);
+    if (!texture) return;
+
+    GLint width = 0, height = 0;
+    GLState::get().bindTexture(0, GL_TEXTURE_2D, texture);
+    glGetTexLevelParameteriv(GL_TEXTURE_2D, 0, GL_TEXTURE_WIDTH, &width);
+    glGetTexLevelParameteriv(GL_TEXTURE_2D, 0, GL_TEXTURE_HEIGHT, &height);
+    culler->buildHiZ(texture, width, height, viewProjection);
+}
+
+void Renderer::resolveOverdraw() {
+    // Oldest pending query first, stop at the first one still in flight
+    for (int i = 0; i < QUERY_COUNT; i++) {
+        OverdrawQuery& query = queries[(currentQuery + i) % QUERY_COUNT];
+        if (!query.pending) continue;
+
+        GLint available = 0;
+        glGetQueryObjectiv(query.id, GL_QUERY_RESULT_AVAILABLE, &available);
+        if (!available) break;
+
+        GLuint64 samples = 0;
+        glGetQueryObjectui64v(query.id, GL_QUERY_RESULT, &samples);
+        shadedFragments = samples;
+        overdraw = query.pixels ? static_cast<double>(samples) / query.pixels : 0.0;
+        query.pending = false;
+    }
+
+    // A query the GPU still owns is dropped rather than waited on
+    queries[currentQuery].pending = false;
+}
+
+void Renderer::bindInstanceAttributes(size_t baseInstance) const {
+    GLState::get().bindBuffer(GL_ARRAY_BUFFER, instanceBuffer);
+    size_t base = instanceBase + baseInstance * sizeof(InstanceData);
+
+    // Model matrix (locations 4-7)
+    for (int i = 0; i < 4; i++) {
+        glEnableVertexAttribArray(4 + i);
+        glVertexAttribPointer(4 + i, 4, GL_FLOAT, GL_FALSE, sizeof(InstanceData), (void*)(base + offsetof(InstanceData, model) + i * sizeof(glm::vec4)));
+        glVertexAttribDivisor(4 + i, 1);
+    }
+
+    // Instance params (location 8)
+    glEnableVertexAttribArray(8);
+    glVertexAttribPointer(8, 4, GL_FLOAT, GL_FALSE, sizeof(InstanceData), (void*)(base + offsetof(InstanceData, params)));
+    glVertexAttribDivisor(8, 1);
+
+    // Normal matrix (locations 9-11)
+    for (int i = 0; i < 3; i++) {
+        glEnableVertexAttribArray(9 + i);
+        glVertexAttribPointer(9 + i, 3, GL_FLOAT, GL_FALSE, sizeof(InstanceData), (void*)(base + offsetof(InstanceData, normalMatrix) + i * sizeof(glm::vec4)));
+        glVertexAttribDivisor(9 + i, 1);
+    }
+}
+
+void Renderer::setFrameUniforms(const Shader& shader, const RenderFrame& frame) const {
+    // Set 3D view
+    shader.setMat4("view", frame.view);
+    shader.setMat4("projection", frame.projection);
+
+    // Set lighting params
+    shader.setVec3("viewPos", frame.viewPos);
+    shader.setVec3("lightDir", glm::normalize(glm::vec3(-0.2f, -1.0f, -0.3f))); // Sunlight from above
+    shader.setVec3("lightColor", glm::vec3(1.0f, 1.0f, 1.0f)); // White sunlight
+    shader.setUniformBlock("Material", MaterialBuffer::BINDING);
+
+    // Uniforms of features compiled out of this variant are gone
+    if (shader.isFeatureEnabled(FEATURE_FOG)) {
+        shader.setVec3("fogColor", glm::vec3(0.5f, 0.6f, 0.7f)); // Adjust to your desired fog color
+        shader.setFloat("fogStart", frame.fogStart);
+        shader.setFloat("fogEnd", frame.fogEnd);
+    }
+
+    // Clustered local lights
+    if (shader.isFeatureEnabled(FEATURE_LOCAL_LIGHTS)) {
+        lightGrid.setUniforms(shader, viewportSize);
+    }
+}
@@ -0,0 +1,648 @@
+#include <glad/glad.h>
+#include <algorithm>
+#include <iostream>
+#include <sstream>
+#include <iomanip>
+
+#include "rendergraph.hpp"
+#include "profiler.hpp"
+#include "glstate.hpp"
+
+// === Constants ===
+static const unsigned int UNKNOWN_STATE = ~0u;
+
+// === Format helpers ===
+static bool isDepthFormat(AttachmentFormat format) {
+    return format == AttachmentFormat::Depth24;
+}
+
+static size_t getBytesPerPixel(AttachmentFormat format) {
+    switch (format) {
+    case AttachmentFormat::RGBA16F: return 8;
+    default: return 4;
+    }
+}
+
+static const char* getFormatName(AttachmentFormat format) {
+    switch (format) {
+    case AttachmentFormat::RGBA8: return "RGBA8";
+    case AttachmentFormat::RGBA16F: return "RGBA16F";
+    case AttachmentFormat::Depth24: return "Depth24";
+    }
+    return "?";
+}
+
+static size_t getAttachmentBytes(const AttachmentDesc& desc) {
+    return static_cast<size_t>(desc.width) * desc.height * getBytesPerPixel(desc.format);
+}
+
+static bool isCompatible(const AttachmentDesc& a, const AttachmentDesc& b) {
+    return a.width == b.width && a.height == b.height && a.format == b.format;
+}
+
+// ### PassBuilder functions ###
+// === Declaration ===
+RenderGraph::PassBuilder& RenderGraph::PassBuilder::read(const std::string& name, ReadAccess access) {
+    Pass& target = graph.passes[pass];
+    int resource = graph.findResource(name);
+    if (resource < 0) {
+        graph.report(std::string(target.name) + " reads undeclared attachment " + name);
+        target.valid = false;
+        return *this;
+    }
+    target.reads.push_back(resource);
+    target.readAccess.push_back(access);
+    return *this;
+}
+
+RenderGraph::PassBuilder& RenderGraph::PassBuilder::write(const std::string& name) {
+    Pass& target = graph.passes[pass];
+    int resource = graph.findResource(name);
+    if (resource < 0) {
+        graph.report(std::string(target.name) + " writes undeclared attachment " + name);
+        target.valid = false;
+        return *this;
+    }
+    target.writes.push_back(resource);
+    return *this;
+}
+
+RenderGraph::PassBuilder& RenderGraph::PassBuilder::keepAlive() {
+    graph.passes[pass].keepAlive = true;
+    return *this;
+}
+
+// ### RenderGraph functions ###
+// === Deconstructor ===
+RenderGraph::~RenderGraph() {
+    release();
+}
+
+// === Building ===
+void RenderGraph::reset() {
+    resources.clear();
+    passes.clear();
+    order.clear();
+    slots.clear();
+    compiled = false;
+}
+
+void RenderGraph::createAttachment(const std::string& name, const AttachmentDesc& desc) {
+    if (findResource(name) >= 0) {
+        report("attachment " + name + " declared twice");
+        return;
+    }
+    Resource resource;
+    resource.name = name;
+    resource.desc = desc;
+    resources.push_back(resource);
+}
+
+void RenderGraph::importAttachment(const std::string& name, const AttachmentDesc& desc, unsigned int framebuffer) {
+    if (findResource(name) >= 0) {
+        report("attachment " + name + " declared twice");
+        return;
+    }
+    Resource resource;
+    resource.name = name;
+    resource.desc = desc;
+    resource.imported = true;
+    resource.framebuffer = framebuffer;
+    resources.push_back(resource);
+}
+
+RenderGraph::PassBuilder RenderGraph::addPass(const char* name, PassFunction execute) {
+    Pass pass;
+    pass.name = name;
+    pass.execute = std::move(execute);
+    passes.push_back(std::move(pass));
+    return PassBuilder(*this, passes.size() - 1);
+}
+
+// === Compiling and running ===
+void RenderGraph::compile() {
+    for (PooledTexture& texture : pool) texture.used = false;
+    for (CachedFramebuffer& framebuffer : framebuffers) framebuffer.used = false;
+
+    validate();
+    cull();
+    computeLifetimes();
+    alias();
+    assignFramebuffers();
+    buildTransitions();
+    releaseUnused();
+    compiled = true;
+
+    RenderGraphStats frameStats;
+    frameStats.passes = order.size();
+    frameStats.culledPasses = passes.size() - order.size();
+    frameStats.textures = slots.size();
+    for (const Resource& resource : resources) {
+        if (resource.imported || resource.slot < 0) continue;
+        frameStats.transients++;
+        frameStats.requestedBytes += getAttachmentBytes(resource.desc);
+    }
+    for (int texture : slots) {
+        frameStats.allocatedBytes += getAttachmentBytes(pool[texture].desc);
+    }
+    for (int index : order) {
+        frameStats.transitions += passes[index].transitions.size() + passes[index].invalidate.size();
+    }
+
+    bool buildText = dumpRequested.exchange(false);
+    std::string text = buildText ? buildDump() : std::string();
+    std::lock_guard<std::mutex> lock(statsMutex);
+    stats = frameStats;
+    if (buildText) dump = std::move(text);
+}
+
+void RenderGraph::execute() {
+    if (!compiled) return;
+
+    GLState& state = GLState::get();
+    for (int index : order) {
+        const Pass& pass = passes[index];
+        for (const Transition& transition : pass.transitions) {
+            switch (transition.type) {
+            case TransitionType::BindFramebuffer:
+                GLState::get().bindFramebuffer(GL_FRAMEBUFFER, transition.value);
+                break;
+            case TransitionType::Viewport:
+                glViewport(0, 0, pass.width, pass.height);
+                break;
+            case TransitionType::ColorMask:
+                state.setColorMask(transition.value != 0);
+                break;
+            case TransitionType::DepthMask:
+                state.setDepthMask(transition.value != 0);
+                break;
+            case TransitionType::Clear: {
+                const AttachmentDesc& desc = resources[transition.resource].desc;
+                if (isDepthFormat(desc.format)) {
+                    const float depth = 1.0f;
+                    glClearBufferfv(GL_DEPTH, 0, &depth);
+                } else {
+                    glClearBufferfv(GL_COLOR, transition.value, &desc.clearColor[0]);
+                }
+                break;
+            }
+            }
+        }
+
+        {
+            ProfileScope scope(pass.name, true);
+            pass.execute(*this);
+        }
+
+        // Contents past their last use need not be kept
+        for (unsigned int texture : pass.invalidate) {
+            glInvalidateTexImage(texture, 0);
+        }
+    }
+
+    // Hand back the default write masks
+    state.setColorMask(true);
+    state.setDepthMask(true);
+}
+
+void RenderGraph::release() {
+    for (CachedFramebuffer& framebuffer : framebuffers) {
+        GLState::get().deleteFramebuffer(framebuffer.id);
+    }
+    for (PooledTexture& texture : pool) {
+        GLState::get().deleteTexture(texture.id);
+    }
+    framebuffers.clear();
+    pool.clear();
+    reset();
+}
+
+unsigned int RenderGraph::getTexture(const std::string& name) const {
+    int resource = findResource(name);
+    if (resource < 0 || resources[resource].slot < 0) return 0;
+    return pool[slots[resources[resource].slot]].id;
+}
+
+// === Debug output ===
+RenderGraphStats RenderGraph::getStats() const {
+    std::lock_guard<std::mutex> lock(statsMutex);
+    return stats;
+}
+
+std::string RenderGraph::getDump() const {
+    std::lock_guard<std::mutex> lock(statsMutex);
+    return dump;
+}
+
+// === Internal helpers ===
+int RenderGraph::findResource(const std::string& name) const {
+    for (size_t i = 0; i < resources.size(); i++) {
+        if (resources[i].name == name) return static_cast<int>(i);
+    }
+    return -1;
+}
+
+void RenderGraph::report(const std::string& message) {
+    // The graph is rebuilt every frame, so each problem is only printed once
+    if (reported.insert(message).second) {
+        std::cerr << "Render graph: " << message << std::endl;
+    }
+}
+
+void RenderGraph::validate() {
+    for (Pass& pass : passes) {
+        pass.alive = false;
+        pass.colorAttachments.clear();
+        pass.depthAttachment = -1;
+        pass.writesDepth = false;
+        if (!pass.valid) continue;
+
+        // Everything bound to the pass's framebuffer, writes first
+        std::vector<int> attachments = pass.writes;
+        for (size_t i = 0; i < pass.reads.size(); i++) {
+            int resource = pass.reads[i];
+            if (pass.readAccess[i] == ReadAccess::Attachment) {
+                attachments.push_back(resource);
+                continue;
+            }
+            if (resources[resource].imported) {
+                report(std::string(pass.name) + " samples imported attachment " + resources[resource].name);
+                pass.valid = false;
+            }
+            if (std::find(pass.writes.begin(), pass.writes.end(), resource) != pass.writes.end()) {
+                report(std::string(pass.name) + " samples and writes " + resources[resource].name);
+                pass.valid = false;
+            }
+        }
+
+        for (int resource : attachments) {
+            const Resource& attachment = resources[resource];
+            const Resource& first = resources[attachments.front()];
+            if (attachment.imported != first.imported || attachment.framebuffer != first.framebuffer ||
+                attachment.desc.width != first.desc.width || attachment.desc.height != first.desc.height) {
+                report(std::string(pass.name) + " mixes attachments of different framebuffers or sizes");
+                pass.valid = false;
+            }
+
+            bool written = std::find(pass.writes.begin(), pass.writes.end(), resource) != pass.writes.end();
+            if (isDepthFormat(attachment.desc.format)) {
+                if (pass.depthAttachment >= 0 && pass.depthAttachment != resource) {
+                    report(std::string(pass.name) + " binds more than one depth attachment");
+                    pass.valid = false;
+                }
+                pass.depthAttachment = resource;
+                pass.writesDepth = pass.writesDepth || written;
+            } else if (std::find(pass.colorAttachments.begin(), pass.colorAttachments.end(), resource) == pass.colorAttachments.end()) {
+                pass.colorAttachments.push_back(resource);
+            }
+        }
+
+        if (pass.colorAttachments.size() > MAX_COLOR_ATTACHMENTS) {
+            report(std::string(pass.name) + " binds too many color attachments");
+            pass.valid = false;
+        }
+        if (!attachments.empty()) {
+            pass.width = resources[attachments.front()].desc.width;
+            pass.height = resources[attachments.front()].desc.height;
+        }
+    }
+}
+
+void RenderGraph::cull() {
+    // Walk back from the passes that write imported attachments or are kept, keeping whatever feeds them
+    std::vector<bool> needed(resources.size(), false);
+    for (size_t i = passes.size(); i-- > 0;) {
+        Pass& pass = passes[i];
+        if (!pass.valid) continue;
+        if (pass.keepAlive) pass.alive = true;
+
+        for (int resource : pass.writes) {
+            if (resources[resource].imported || needed[resource]) pass.alive = true;
+        }
+        if (!pass.alive) continue;
+
+        for (int resource : pass.reads) {
+            needed[resource] = true;
+        }
+    }
+
+    order.clear();
+    for (size_t i = 0; i < passes.size(); i++) {
+        if (passes[i].alive) order.push_back(static_cast<int>(i));
+    }
+}
+
+void RenderGraph::computeLifetimes() {
+    for (Resource& resource : resources) {
+        resource.first = -1;
+        resource.last = -1;
+        resource.slot = -1;
+    }
+
+    for (size_t position = 0; position < order.size(); position++) {
+        const Pass& pass = passes[order[position]];
+        auto touch = [this, position](int index) {
+            Resource& resource = resources[index];
+            if (resource.first < 0) resource.first = static_cast<int>(position);
+            resource.last = static_cast<int>(position);
+        };
+        for (int resource : pass.reads) touch(resource);
+        for (int resource : pass.writes) touch(resource);
+    }
+
+    // A transient read before anything writes it holds undefined contents
+    for (int index : order) {
+        const Pass& pass = passes[index];
+        for (int resource : pass.reads) {
+            const Resource& attachment = resources[resource];
+            if (attachment.imported) continue;
+
+            bool writtenBefore = false;
+            for (int earlier : order) {
+                if (earlier == index) break;
+                const std::vector<int>& writes = passes[earlier].writes;
+                if (std::find(writes.begin(), writes.end(), resource) != writes.end()) writtenBefore = true;
+            }
+            if (!writtenBefore) report(std::string(pass.name) + " reads " + attachment.name + " before any pass writes it");
+        }
+    }
+}
+
+void RenderGraph::alias() {
+    // Transients in order of first use, each takes the first compatible slot that is free again
+    std::vector<int> transients;
+    for (size_t i = 0; i < resources.size(); i++) {
+        if (!resources[i].imported && resources[i].first >= 0) transients.push_back(static_cast<int>(i));
+    }
+    std::stable_sort(transients.begin(), transients.end(), [this](int a, int b) {
+        return resources[a].first < resources[b].first;
+    });
+
+    std::vector<AttachmentDesc> slotDescs;
+    std::vector<int> slotLast;
+    for (int index : transients) {
+        Resource& resource = resources[index];
+        for (size_t slot = 0; slot < slotDescs.size(); slot++) {
+            if (slotLast[slot] < resource.first && isCompatible(slotDescs[slot], resource.desc)) {
+                resource.slot = static_cast<int>(slot);
+                break;
+            }
+        }
+        if (resource.slot < 0) {
+            resource.slot = static_cast<int>(slotDescs.size());
+            slotDescs.push_back(resource.desc);
+            slotLast.push_back(resource.last);
+        }
+        slotLast[resource.slot] = resource.last;
+    }
+
+    slots.clear();
+    for (const AttachmentDesc& desc : slotDescs) {
+        slots.push_back(acquireTexture(desc));
+    }
+}
+
+void RenderGraph::assignFramebuffers() {
+    for (int index : order) {
+        Pass& pass = passes[index];
+        int first = !pass.colorAttachments.empty() ? pass.colorAttachments.front() : pass.depthAttachment;
+        if (first < 0) {
+            pass.framebuffer = 0;
+        } else if (resources[first].imported) {
+            pass.framebuffer = resources[first].framebuffer;
+        } else {
+            pass.framebuffer = getFramebuffer(pass);
+        }
+    }
+}
+
+void RenderGraph::buildTransitions() {
+    bool invalidate = GLAD_GL_VERSION_4_3;
+
+    // State is unknown when the frame starts
+    unsigned int framebuffer = UNKNOWN_STATE;
+    int width = -1;
+    int height = -1;
+    unsigned int colorMask = UNKNOWN_STATE;
+    unsigned int depthMask = UNKNOWN_STATE;
+    std::vector<bool> written(resources.size(), false);
+
+    for (size_t position = 0; position < order.size(); position++) {
+        Pass& pass = passes[order[position]];
+        pass.transitions.clear();
+        pass.invalidate.clear();
+
+        bool hasAttachments = !pass.colorAttachments.empty() || pass.depthAttachment >= 0;
+        if (hasAttachments && pass.framebuffer != framebuffer) {
+            pass.transitions.push_back({TransitionType::BindFramebuffer, pass.framebuffer, -1});
+            framebuffer = pass.framebuffer;
+        }
+        if (hasAttachments && (pass.width != width || pass.height != height)) {
+            pass.transitions.push_back({TransitionType::Viewport, 0, -1});
+            width = pass.width;
+            height = pass.height;
+        }
+
+        // Depth-only passes write no color, depth read as an attachment is not written
+        unsigned int wantColor = pass.colorAttachments.empty() ? 0 : 1;
+        if (hasAttachments && wantColor != colorMask) {
+            pass.transitions.push_back({TransitionType::ColorMask, wantColor, -1});
+            colorMask = wantColor;
+        }
+        unsigned int wantDepth = pass.writesDepth ? 1 : 0;
+        if (pass.depthAttachment >= 0 && wantDepth != depthMask) {
+            pass.transitions.push_back({TransitionType::DepthMask, wantDepth, -1});
+            depthMask = wantDepth;
+        }
+
+        // First writer clears, aliased textures hold whatever the previous user left
+        for (int resource : pass.writes) {
+            if (written[resource]) continue;
+            written[resource] = true;
+            if (!resources[resource].desc.clear) continue;
+
+            auto color = std::find(pass.colorAttachments.begin(), pass.colorAttachments.end(), resource);
+            unsigned int drawBuffer = static_cast<unsigned int>(color - pass.colorAttachments.begin());
+            pass.transitions.push_back({TransitionType::Clear, drawBuffer, resource});
+        }
+
+        if (!invalidate) continue;
+        auto addInvalidate = [this, &pass, position](int index) {
+            const Resource& resource = resources[index];
+            if (resource.imported || resource.last != static_cast<int>(position)) return;
+            unsigned int texture = pool[slots[resource.slot]].id;
+            if (std::find(pass.invalidate.begin(), pass.invalidate.end(), texture) == pass.invalidate.end()) {
+                pass.invalidate.push_back(texture);
+            }
+        };
+        for (int resource : pass.reads) addInvalidate(resource);
+        for (int resource : pass.writes) addInvalidate(resource);
+    }
+}
+
+unsigned int RenderGraph::getFramebuffer(const Pass& pass) {
+    std::vector<unsigned int> textures;
+    for (int resource : pass.colorAttachments) {
+        textures.push_back(pool[slots[resources[resource].slot]].id);
+    }
+    if (pass.depthAttachment >= 0) {
+        textures.push_back(pool[slots[resources[pass.depthAttachment].slot]].id);
+    }
+
+    for (CachedFramebuffer& framebuffer : framebuffers) {
+        if (framebuffer.textures == textures) {
+            framebuffer.used = true;
+            return framebuffer.id;
+        }
+    }
+
+    CachedFramebuffer framebuffer;
+    framebuffer.textures = textures;
+    framebuffer.used = true;
+    glGenFramebuffers(1, &framebuffer.id);
+    GLState::get().bindFramebuffer(GL_FRAMEBUFFER, framebuffer.id);
+
+    GLenum drawBuffers[MAX_COLOR_ATTACHMENTS];
+    for (size_t i = 0; i < pass.colorAttachments.size(); i++) {
+        drawBuffers[i] = GL_COLOR_ATTACHMENT0 + static_cast<GLenum>(i);
+        glFramebufferTexture2D(GL_FRAMEBUFFER, drawBuffers[i], GL_TEXTURE_2D, textures[i], 0);
+    }
+    if (pass.depthAttachment >= 0) {
+        glFramebufferTexture2D(GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, GL_TEXTURE_2D, textures.back(), 0);
+    }
+    if (pass.colorAttachments.empty()) {
+        glDrawBuffer(GL_NONE);
+    } else {
+        glDrawBuffers(static_cast<GLsizei>(pass.colorAttachments.size()), drawBuffers);
+    }
+
+    if (glCheckFramebufferStatus(GL_FRAMEBUFFER) != GL_FRAMEBUFFER_COMPLETE) {
+        report(std::string("framebuffer for ") + pass.name + " is incomplete");
+    }
+    framebuffers.push_back(framebuffer);
+    return framebuffer.id;
+}
+
+int RenderGraph::acquireTexture(const AttachmentDesc& desc) {
+    for (size_t i = 0; i < pool.size(); i++) {
+        if (!pool[i].used && isCompatible(pool[i].desc, desc)) {
+            pool[i].used = true;
+            return static_cast<int>(i);
+        }
+    }
+
+    PooledTexture texture;
+    texture.desc = desc;
+    texture.used = true;
+    glGenTextures(1, &texture.id);
+    GLState::get().bindTexture(0, GL_TEXTURE_2D, texture.id);
+    switch (desc.format) {
+    case AttachmentFormat::RGBA8:
+        glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA8, desc.width, desc.height, 0, GL_RGBA, GL_UNSIGNED_BYTE, nullptr);
+        break;
+    case AttachmentFormat::RGBA16F:
+        glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA16F, desc.width, desc.height, 0, GL_RGBA, GL_HALF_FLOAT, nullptr);
+        break;
+    case AttachmentFormat::Depth24:
+        glTexImage2D(GL_TEXTURE_2D, 0, GL_DEPTH_COMPONENT24, desc.width, desc.height, 0, GL_DEPTH_COMPONENT, GL_UNSIGNED_INT, nullptr);
+        break;
+    }
+    GLint filter = isDepthFormat(desc.format) ? GL_NEAREST : GL_LINEAR;
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, filter);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, filter);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+
+    pool.push_back(texture);
+    return static_cast<int>(pool.size() - 1);
+}
+
+void RenderGraph::releaseUnused() {
+    // Framebuffers go first, a kept one only points at kept textures
+    for (CachedFramebuffer& framebuffer : framebuffers) {
+        if (!framebuffer.used) GLState::get().deleteFramebuffer(framebuffer.id);
+    }
+    framebuffers.erase(std::remove_if(framebuffers.begin(), framebuffers.end(),
+        [](const CachedFramebuffer& framebuffer) {return !framebuffer.used;}), framebuffers.end());
+
+    // Slots index into the pool, so remap them while compacting
+    std::vector<int> remap(pool.size(), -1);
+    size_t kept = 0;
+    for (size_t i = 0; i < pool.size(); i++) {
+        if (!pool[i].used) {
+            GLState::get().deleteTexture(pool[i].id);
+            continue;
+        }
+        remap[i] = static_cast<int>(kept);
+        pool[kept++] = pool[i];
+    }
+    pool.resize(kept);
+    for (int& slot : slots) {
+        slot = remap[slot];
+    }
+}
+
+std::string RenderGraph::buildDump() const {
+    std::ostringstream out;
+    out << "Render graph: " << order.size() << " passes, " << passes.size() - order.size() << " culled\n";
+
+    static const char* transitionNames[] = {"bind framebuffer", "viewport", "color mask", "depth mask", "clear"};
+    out << "Passes:\n";
+    for (size_t i = 0; i < passes.size(); i++) {
+        const Pass& pass = passes[i];
+        auto position = std::find(order.begin(), order.end(), static_cast<int>(i));
+        if (position == order.end()) {
+            out << "  [-] " << pass.name << (pass.valid ? " (culled)" : " (invalid)") << "\n";
+            continue;
+        }
+
+        out << "  [" << position - order.begin() << "] " << pass.name;
+        for (size_t r = 0; r < pass.reads.size(); r++) {
+            out << (r ? ", " : " reads ") << resources[pass.reads[r]].name;
+            if (pass.readAccess[r] == ReadAccess::Attachment) out << " (attachment)";
+        }
+        for (size_t w = 0; w < pass.writes.size(); w++) {
+            out << (w ? ", " : " writes ") << resources[pass.writes[w]].name;
+        }
+        if (pass.keepAlive) out << " (kept)";
+        out << "\n";
+
+        for (const Transition& transition : pass.transitions) {
+            out << "        " << transitionNames[static_cast<int>(transition.type)];
+            switch (transition.type) {
+            case TransitionType::BindFramebuffer: out << " " << transition.value; break;
+            case TransitionType::Viewport: out << " " << pass.width << "x" << pass.height; break;
+            case TransitionType::ColorMask:
+            case TransitionType::DepthMask: out << (transition.value ? " on" : " off"); break;
+            case TransitionType::Clear: out << " " << resources[transition.resource].name; break;
+            }
+            out << "\n";
+        }
+        if (!pass.invalidate.empty()) {
+            out << "        invalidate " << pass.invalidate.size() << " texture(s) after\n";
+        }
+    }
+
+    out << "Attachments:\n";
+    size_t requested = 0;
+    for (const Resource& resource : resources) {
+        out << "  " << resource.name << " " << getFormatName(resource.desc.format) << " "
+            << resource.desc.width << "x" << resource.desc.height;
+        if (resource.imported) {
+            out << " imported (framebuffer " << resource.framebuffer << ")\n";
+        } else if (resource.slot < 0) {
+            out << " unused\n";
+        } else {
+            out << " passes " << resource.first << "-" << resource.last << " texture " << resource.slot << "\n";
+            requested += getAttachmentBytes(resource.desc);
+        }
+    }
+
+    size_t allocated = 0;
+    for (int texture : slots) {
+        allocated += getAttachmentBytes(pool[texture].desc);
+    }
+    out << std::fixed << std::setprecision(2) << "Memory: " << requested / 1048576.0 << " MB requested, "
+        << allocated / 1048576.0 << " MB allocated, " << (requested - allocated) / 1048576.0 << " MB saved by aliasing\n";
+    return out.str();
+}
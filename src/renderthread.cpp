@@ -0,0 +1,218 @@
+#include <glad/glad.h>
+#include <GLFW/glfw3.h>
+#include <iostream>
+
+#include "backends/imgui_impl_opengl3.h"
+
+#include "renderthread.hpp"
+#include "window.hpp"
+#include "profiler.hpp"
+#include "texturestreamer.hpp"
+#include "glstate.hpp"
+#include "shader.hpp"
+
+// ### GuiSnapshot functions ###
+// === Deconstructor ===
+GuiSnapshot::~GuiSnapshot() {
+    clear();
+}
+
+// === Capture ===
+void GuiSnapshot::capture(const ImDrawData* source) {
+    clear();
+    if (!source || !source->Valid) return;
+
+    // Only the output buffers are cloned, enough to replay the lists
+    for (ImDrawList* list : source->CmdLists) {
+        drawData.CmdLists.push_back(list->CloneOutput());
+    }
+    drawData.Valid = true;
+    drawData.CmdListsCount = source->CmdListsCount;
+    drawData.TotalIdxCount = source->TotalIdxCount;
+    drawData.TotalVtxCount = source->TotalVtxCount;
+    drawData.DisplayPos = source->DisplayPos;
+    drawData.DisplaySize = source->DisplaySize;
+    drawData.FramebufferScale = source->FramebufferScale;
+}
+
+void GuiSnapshot::clear() {
+    for (ImDrawList* list : drawData.CmdLists) {
+        IM_DELETE(list);
+    }
+    drawData.Clear();
+}
+
+// ### RenderThread functions ###
+// === Singleton access ===
+RenderThread& RenderThread::get() {
+    static RenderThread instance;
+    return instance;
+}
+
+// === Deconstructor ===
+RenderThread::~RenderThread() {
+    stop();
+}
+
+// === Thread lifecycle ===
+void RenderThread::start(Window& targetWindow, Renderer& targetRenderer) {
+    if (running) return;
+    window = &targetWindow;
+    renderer = &targetRenderer;
+
+    // A context is current on one thread at a time
+    glfwMakeContextCurrent(nullptr);
+    swapInterval = -1;
+
+    recording = 0;
+    pending = -1;
+    drawing = -1;
+    stopping = false;
+    running = true;
+    thread = std::thread(&RenderThread::threadLoop, this);
+    std::cout << "Render thread started" << std::endl;
+}
+
+void RenderThread::stop() {
+    if (!running) return;
+
+    // Snapshots already handed over are still drawn
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stopping = true;
+    }
+    wake.notify_all();
+    thread.join();
+    running = false;
+
+    glfwMakeContextCurrent(window->getGLFWwindow());
+    for (FrameSnapshot& snapshot : snapshots) {
+        snapshot.gui.clear();
+    }
+}
+
+// === Frame handoff ===
+FrameSnapshot& RenderThread::beginFrame() {
+    // Wait for the previous snapshot to be picked up and for this slot to be drawn
+    std::unique_lock<std::mutex> lock(mutex);
+    done.wait(lock, [this]() {return pending == -1 && drawing != recording;});
+    return snapshots[recording];
+}
+
+void RenderThread::submit() {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        pending = recording;
+        recording = (recording + 1) % SNAPSHOT_COUNT;
+    }
+    wake.notify_all();
+}
+
+// === Resource work ===
+void RenderThread::run(const std::function<void()>& work) {
+    if (!running || std::this_thread::get_id() == thread.get_id()) {
+        work();
+        return;
+    }
+
+    std::unique_lock<std::mutex> lock(mutex);
+    done.wait(lock, [this]() {return task == nullptr;});
+    task = &work;
+    wake.notify_all();
+    done.wait(lock, [this, &work]() {return task != &work;});
+}
+
+// === Internal helpers ===
+void RenderThread::threadLoop() {
+    glfwMakeContextCurrent(window->getGLFWwindow());
+    Profiler::getRender().bindToThread();
+
+    std::unique_lock<std::mutex> lock(mutex);
+    while (true) {
+        wake.wait(lock, [this]() {return pending != -1 || task || stopping;});
+
+        // Frames go before tasks so a task never frees what a queued frame uses
+        if (pending != -1) {
+            drawing = pending;
+            pending = -1;
+            lock.unlock();
+            done.notify_all();
+
+            draw(snapshots[drawing]);
+
+            lock.lock();
+            drawing = -1;
+            done.notify_all();
+        } else if (task) {
+            (*task)();
+            task = nullptr;
+            done.notify_all();
+        } else {
+            break;
+        }
+    }
+    lock.unlock();
+
+    // Hand the context back finished, without the graph's textures
+    resolution.release();
+    graph.release();
+    glFinish();
+    glfwMakeContextCurrent(nullptr);
+}
+
+void RenderThread::draw(FrameSnapshot& snapshot) {
+    Profiler& profiler = Profiler::getRender();
+    profiler.beginFrame();
+
+    // The window's own buffers, cleared by whichever pass writes them first
+    AttachmentDesc color;
+    color.width = snapshot.width;
+    color.height = snapshot.height;
+    color.clearColor = snapshot.clearColor;
+    AttachmentDesc depth = color;
+    depth.format = AttachmentFormat::Depth24;
+
+    resolution.update(profiler);
+    bool scene = renderer->beginFrame(snapshot.scene);
+    {
+        // Mips for this frame's screen sizes, at the resolution the scene is drawn at
+        ProfileScope scope("Texture streaming");
+        TextureStreamer::get().update(static_cast<int>(snapshot.height * resolution.getScale()));
+    }
+    {
+        // Links variants asked for while recording, this frame still draws with what is ready
+        ProfileScope scope("Shader variants");
+        Shader::updateVariants();
+    }
+    {
+        ProfileScope scope("Graph compile");
+        graph.reset();
+        graph.importAttachment("Backbuffer", color, 0);
+        graph.importAttachment("BackbufferDepth", depth, 0);
+        if (scene) {
+            resolution.addScenePasses(graph, *renderer, color, "Backbuffer", "BackbufferDepth");
+        }
+        graph.addPass("GUI", [&snapshot](const RenderGraph&) {
+            ImGui_ImplOpenGL3_RenderDrawData(&snapshot.gui.drawData);
+        }).write("Backbuffer");
+        graph.compile();
+    }
+    graph.execute();
+    renderer->endFrame();
+    GLState::get().endFrame();
+
+    // The swap interval belongs to the context, so the pacer's mode is applied here
+    int interval = pacer.getSwapInterval();
+    if (interval != swapInterval) {
+        glfwSwapInterval(interval);
+        swapInterval = interval;
+    }
+
+    profiler.beginScope("Swap", false);
+    double swapStart = FramePacer::now();
+    window->swapBuffers();
+    pacer.onSwap(snapshot.inputTime, swapStart, FramePacer::now());
+    profiler.endScope();
+
+    profiler.endFrame();
+}
@@ -1,15 +1,29 @@
 #include <iostream>
+#include <algorithm>
 #include <ostream>
 #include <fstream>
 #include <filesystem>
+#include <map>
+#include <tuple>
+#include <cfloat>
 
 #include "scene.hpp"
+#include "jobs.hpp"
+
+// === Constants ===
+static const size_t MAX_OCCLUDERS = 16;
+static const float MIN_OCCLUDER_COVERAGE = 0.1f;
+static const float STATIC_CELL_SIZE = 32.0f;
+static const size_t MAX_BATCH_VERTICES = 1 << 16;
+static const size_t MIN_RECORD_SLICE = 256;
+static const char* PASS_SHADERS[] = {"compute", "depth", "upscale"}; // Loaded by the passes that use them, not for objects
 
 // === Constructors ===
 Scene::Scene() {
     loadAllMeshes();
     loadAllShaders();
     loadAllTextures();
+    loadAllMaterials();
 }
 
 Scene::Scene(const Scene& other) {
@@ -24,10 +38,11 @@ Scene::Scene(const Scene& other) {
         cloned->textureScale = obj->textureScale;
         cloned->obb = obj->obb;
         cloned->isPlayer = obj->isPlayer;
+        cloned->isStatic = obj->isStatic;
+        cloned->light = obj->light;
 
         cloned->mesh = obj->mesh;
-        cloned->shader = obj->shader;
-        cloned->texture = obj->texture;
+        cloned->material = obj->material;
 
         pointerMap[obj.get()] = cloned.get();
         objects[name] = std::move(cloned);
@@ -50,12 +65,23 @@ Scene::Scene(const Scene& other) {
         }
     }
 
+    // Keep the original's order
+    objectList.reserve(other.objectList.size());
+    for (Object* obj : other.objectList) {
+        objectList.push_back(pointerMap[obj]);
+    }
+
     // Fix selectedObject pointer
     if (other.selectedObject) {
         selectedObject = pointerMap[other.selectedObject];
     }
 
+    // Meshes stay owned by the source, playtest copies still cull with their proxies
+    occluderProxies = other.occluderProxies;
+
     name = other.name;
+    occlusionCulling = other.occlusionCulling;
+    gpuCulling = other.gpuCulling;
 }
 
 // === Mesh access ===
@@ -75,8 +101,21 @@ std::vector<Mesh*> Scene::getMeshes() const {
 
 bool Scene::addMesh(std::unique_ptr<Mesh> mesh) {
     if (!mesh) return false;
-    const std::string& name = mesh->getName();
+    const std::string name = mesh->getName();
+
+    // Re-point objects still using a mesh being replaced
+    auto existing = meshes.find(name);
+    if (existing != meshes.end()) {
+        for (auto& [objName, obj] : objects) {
+            if (obj->mesh == existing->second.get()) {
+                obj->mesh = mesh.get();
+                obj->markDirty();
+            }
+        }
+    }
+
     meshes[name] = std::move(mesh);
+    linkOccluderProxies();
     return true;
 }
 
@@ -84,6 +123,7 @@ bool Scene::removeMesh(const std::string& name) {
     auto it = meshes.find(name);
     if (it != meshes.end()) {
         meshes.erase(it);
+        linkOccluderProxies();
         return true;
     }
     return false;
@@ -120,6 +160,72 @@ std::vector<Texture*> Scene::getTextures() const {
     return result;
 }
 
+// === Material access ===
+std::shared_ptr<Material> Scene::getMaterial(const std::string& name) const {
+    auto it = materials.find(name);
+    if (it != materials.end()) return it->second;
+    return nullptr;
+}
+
+std::shared_ptr<Material> Scene::findMaterial(const std::string& shaderName, const std::string& textureName) {
+    Shader* shader = getShader(shaderName);
+    std::string textureStem = std::filesystem::path(textureName).stem().string();
+    Texture* texture = getTexture(textureStem);
+    if (!shader || !texture) return nullptr;
+
+    // Prefer the material named after the texture, then any using the same pair
+    std::shared_ptr<Material> named = getMaterial(textureStem);
+    if (named && named->getShader() == shader && named->getTexture() == texture) return named;
+    for (const std::shared_ptr<Material>& material : getMaterials()) {
+        if (material->getShader() == shader && material->getTexture() == texture) return material;
+    }
+
+    // Named after the texture unless taken, numbered past any other library entry
+    std::string name = named ? shaderName + "_" + textureStem : textureStem;
+    for (int counter = 1; materials.count(name); counter++) {
+        name = shaderName + "_" + textureStem + "_" + std::to_string(counter);
+    }
+    auto material = std::make_shared<Material>(name, shader, texture);
+    materials[name] = material;
+    return material;
+}
+
+std::vector<std::shared_ptr<Material>> Scene::getMaterials() const {
+    std::vector<std::shared_ptr<Material>> result;
+    for (const auto& [name, material] : materials) {
+        result.push_back(material);
+    }
+    std::sort(result.begin(), result.end(), [](const auto& a, const auto& b) {return a->getName() < b->getName();});
+    return result;
+}
+
+std::shared_ptr<Material> Scene::duplicateMaterial(const Material& original) {
+    // Find the next free numbered name
+    std::string newName;
+    int counter = 1;
+    do {
+        newName = original.getName() + "_" + std::to_string(counter++);
+    } while (materials.count(newName));
+
+    auto material = std::make_shared<Material>(original, newName);
+    materials[newName] = material;
+    return material;
+}
+
+bool Scene::saveMaterial(const Material& material) const {
+    std::filesystem::create_directories("assets/materials");
+    std::ofstream file("assets/materials/" + material.getName() + ".mat");
+    if (!file.is_open()) return false;
+
+    const MaterialParams& params = material.getParams();
+    if (material.getShader()) file << "shader " << material.getShader()->getName() << "\n";
+    if (material.getTexture()) file << "texture " << material.getTexture()->getName() << "\n";
+    file << "color " << params.color.r << " " << params.color.g << " " << params.color.b << " " << params.color.a << "\n";
+    file << "specular " << params.specularStrength << "\n";
+    file << "shininess " << params.shininess << "\n";
+    return true;
+}
+
 // === Scene handling ===
 bool Scene::loadScene(const std::string& scnName) {
     clearSelection();
@@ -133,10 +239,12 @@ bool Scene::loadScene(const std::string& scnName) {
     }
 
     std::string line;
-    std::string objName, meshName, textureName, shaderName, parentName = "None";
+    std::string objName, meshName, materialName, textureName, shaderName, parentName = "None";
     glm::vec3 position(0), rotation(0), scale(1);
     glm::vec2 textureScale(1);
     bool isPlayer;
+    bool isStatic;
+    std::optional<Light> light;
     bool inObjectBlock = false;
     std::unordered_map<std::string, std::unique_ptr<Object>> tempObjects;
     std::unordered_map<std::string, std::string> parentMap;
@@ -150,15 +258,19 @@ bool Scene::loadScene(const std::string& scnName) {
 
         if (token == "object") {
             iss >> objName;
-            meshName = shaderName = textureName = "";
+            meshName = materialName = shaderName = textureName = "";
             position = rotation = glm::vec3(0);
             scale = glm::vec3(1);
             textureScale = glm::vec2(1);
             isPlayer = false;
+            isStatic = false;
+            light.reset();
             parentName = "None";
             inObjectBlock = true;
         } else if (token == "mesh") {
             iss >> meshName;
+        } else if (token == "material") {
+            iss >> materialName;
         } else if (token == "shader") {
             iss >> shaderName;
         } else if (token == "texture") {
@@ -173,20 +285,35 @@ bool Scene::loadScene(const std::string& scnName) {
             iss >> scale.x >> scale.y >> scale.z;
         } else if (token == "isPlayer") {
             iss >> isPlayer;
+        } else if (token == "isStatic") {
+            iss >> isStatic;
+        } else if (token == "light") {
+            // light <point|spot> r g b intensity range [inner outer]
+            std::string type;
+            light = Light();
+            iss >> type >> light->color.r >> light->color.g >> light->color.b >> light->intensity >> light->range;
+            if (type == "spot") {
+                light->type = LightType::Spot;
+                iss >> light->innerAngle >> light->outerAngle;
+            }
         } else if (token == "parent") {
             iss >> parentName;
         } else if (token == "endobject" && inObjectBlock) {
-            auto obj = std::make_unique<Object>(objName, meshName, textureName, shaderName);
+            // Files from before materials name the shader and texture instead
+            inObjectBlock = false;
+            auto obj = materialName.empty() ? createObject(objName, meshName, textureName, shaderName)
+                                            : createObject(objName, meshName, materialName);
+            if (!obj) continue;
             obj->transform.position = position;
             obj->transform.rotation = rotation;
             obj->transform.scale = scale;
             obj->textureScale = textureScale;
             obj->isPlayer = isPlayer;
+            obj->isStatic = isStatic;
+            obj->light = light;
 
             tempObjects[objName] = std::move(obj);
             parentMap[objName] = parentName;
-
-            inObjectBlock = false;
         }
     }
 
@@ -216,17 +343,36 @@ bool Scene::saveScene(const std::string& scnName) {
 
     // Write objects from scene to .scn file
     setName(scnName);
+    std::unordered_set<const Material*> savedMaterials;
     for (const auto& objPtr : objects) {
         Object* obj = objPtr.second.get();
         file << "object " << obj->name << "\n";
         file << "mesh " << obj->mesh->getName() << "\n";
-        file << "shader " << obj->shader->getName() << "\n";
-        file << "texture " << obj->texture->getName() << "\n";
+
+        // Library materials are written next to the scene, private ones as their shader and texture
+        const Material* material = obj->material.get();
+        if (material && getMaterial(material->getName()).get() == material) {
+            file << "material " << material->getName() << "\n";
+            if (savedMaterials.insert(material).second) saveMaterial(*material);
+        } else if (material) {
+            if (material->getShader()) file << "shader " << material->getShader()->getName() << "\n";
+            if (material->getTexture()) file << "texture " << material->getTexture()->getName() << "\n";
+        }
         file << "texturescale " << obj->textureScale.x << " " << obj->textureScale.y << "\n";
         file << "position " << obj->transform.position.x << " " << obj->transform.position.y << " " << obj->transform.position.z << "\n";
         file << "rotation " << obj->transform.rotation.x << " " << obj->transform.rotation.y << " " << obj->transform.rotation.z << "\n";
         file << "scale " << obj->transform.scale.x << " " << obj->transform.scale.y << " " << obj->transform.scale.z << "\n";
         file << "isPlayer " << obj->isPlayer << "\n";
+        file << "isStatic " << obj->isStatic << "\n";
+
+        if (const std::optional<Light>& light = obj->light) {
+            file << "light " << (light->type == LightType::Spot ? "spot " : "point ")
+                 << light->color.r << " " << light->color.g << " " << light->color.b << " " << light->intensity << " " << light->range;
+            if (light->type == LightType::Spot) {
+                file << " " << light->innerAngle << " " << light->outerAngle;
+            }
+            file << "\n";
+        }
 
         if (obj->parent) {
             file << "parent " << obj->parent->name << "\n";
@@ -256,8 +402,41 @@ void Scene::setName(const std::string& newName) {
 }
 
 // === Object handling ===
+std::unique_ptr<Object> Scene::createObject(const std::string& name, const std::string& meshName, const std::string& textureName, const std::string& shaderName) {
+    // Share the scene's resources so objects can be batched together
+    Mesh* sharedMesh = getMesh(meshName);
+    std::shared_ptr<Material> sharedMaterial = findMaterial(shaderName, textureName);
+
+    if (sharedMesh && sharedMaterial) {
+        return std::make_unique<Object>(name, sharedMesh, sharedMaterial);
+    }
+
+    // Fall back to loading private copies
+    return std::make_unique<Object>(name, meshName, textureName, shaderName);
+}
+
+std::unique_ptr<Object> Scene::createObject(const std::string& name, const std::string& meshName, const std::string& materialName) {
+    Mesh* sharedMesh = getMesh(meshName);
+    std::shared_ptr<Material> sharedMaterial = getMaterial(materialName);
+    if (!sharedMesh || !sharedMaterial) {
+        std::cerr << "Object " << name << " needs missing mesh '" << meshName << "' or material '" << materialName << "'" << std::endl;
+        return nullptr;
+    }
+    return std::make_unique<Object>(name, sharedMesh, sharedMaterial);
+}
+
 void Scene::addObject(const std::string& name, std::unique_ptr<Object> obj) {
-    objects[name] = std::move(obj);
+    // A replaced object keeps its place in the order
+    std::unique_ptr<Object>& slot = objects[name];
+    auto listed = std::find(objectList.begin(), objectList.end(), slot.get());
+    if (slot && listed != objectList.end()) {
+        *listed = obj.get();
+    } else {
+        objectList.push_back(obj.get());
+    }
+    slot = std::move(obj);
+    hierarchyRevision++;
+    bvhDirty = true;
 }
 
 Object* Scene::getObject(const std::string& name) {
@@ -268,14 +447,6 @@ Object* Scene::getObject(const std::string& name) {
     return nullptr;
 }
 
-std::vector<Object*> Scene::getObjects() {
-    std::vector<Object*> result;
-    for (auto& [name, objPtr] : objects) {
-        result.push_back(objPtr.get());
-    }
-    return result;
-}
-
 std::vector<std::string> Scene::getObjectNames() const {
     std::vector<std::string> names;
     for (const auto& [name, _] : objects) {
@@ -289,7 +460,22 @@ size_t Scene::getObjectCount() const {
 }
 
 void Scene::deleteObject(const std::string& name) {
-    objects.erase(name);
+    auto it = objects.find(name);
+    if (it == objects.end()) return;
+
+    // Unlink it so nothing in the hierarchy points at it, its children stay where they are
+    Object* obj = it->second.get();
+    obj->setParent(nullptr);
+    while (!obj->children.empty()) {
+        obj->children.back()->setParent(nullptr);
+    }
+
+    batchedObjects.erase(obj);
+    objectList.erase(std::find(objectList.begin(), objectList.end(), obj));
+    objects.erase(it);
+    hierarchyRevision++;
+    removalRevision++;
+    bvhDirty = true;
 }
 
 std::string Scene::duplicateObject(const std::string& originalName) {
@@ -311,7 +497,7 @@ std::string Scene::duplicateObject(const std::string& originalName) {
     newObject->name = newName;
 
     // Insert into the scene
-    objects[newName] = std::move(newObject);
+    addObject(newName, std::move(newObject));
     return newName;
 }
 
@@ -331,6 +517,7 @@ std::string Scene::renameObject(const std::string& oldName, const std::string& n
     objects.erase(it);
 
     objects[finalName]->name = finalName;
+    hierarchyRevision++;
 
     if (selectedObject && selectedObject->name == oldName) {
         selectedObject = objects[finalName].get();
@@ -340,10 +527,88 @@ std::string Scene::renameObject(const std::string& oldName, const std::string& n
 }
 
 void Scene::clear() {
+    clearStaticBatches();
     objects.clear();
+    objectList.clear();
+    hierarchyRevision++;
+    removalRevision++;
+    bvhDirty = true;
     setName("");
 }
 
+// === Hierarchy ===
+void Scene::setParent(Object* object, Object* parent) {
+    if (object->parent == parent) return;
+    object->setParent(parent);
+    hierarchyRevision++;
+}
+
+// === Static batching ===
+size_t Scene::buildStaticBatches() {
+    clearStaticBatches();
+
+    // An object only stays put if everything above it does too
+    auto isStaticHierarchy = [](const Object* obj) {
+        for (; obj; obj = obj->parent) {
+            if (!obj->isStatic) return false;
+        }
+        return true;
+    };
+
+    // Group by material, then by grid cell so batches can still be culled
+    std::map<std::tuple<Material*, int, int, int>, std::vector<Object*>> groups;
+    for (auto& [name, obj] : objects) {
+        if (!obj->mesh || !obj->material || obj->isPlayer || !isStaticHierarchy(obj.get())) continue;
+        obj->updateOBB();
+        glm::ivec3 cell = glm::ivec3(glm::floor(obj->obb.center / STATIC_CELL_SIZE));
+        groups[{obj->material.get(), cell.x, cell.y, cell.z}].push_back(obj.get());
+    }
+
+    size_t batchedCount = 0;
+    for (auto& [key, group] : groups) {
+        // Split crowded cells so one batch never grows past the vertex cap
+        size_t start = 0;
+        while (start < group.size()) {
+            size_t end = start;
+            size_t vertexCount = 0;
+            while (end < group.size() && (end == start || vertexCount + group[end]->mesh->getVertices().size() <= MAX_BATCH_VERTICES)) {
+                vertexCount += group[end]->mesh->getVertices().size();
+                end++;
+            }
+
+            // A lone object gains nothing from a private copy
+            if (end - start > 1) {
+                std::vector<Object*> members(group.begin() + start, group.begin() + end);
+                std::string batchName = "static_batch_" + std::to_string(staticBatches.size());
+
+                staticMeshes.push_back(combineMeshes(batchName, members, true));
+                auto batch = std::make_unique<Object>(batchName, staticMeshes.back().get(), members.front()->material);
+                batch->isStatic = true;
+                staticBatches.push_back(std::move(batch));
+
+                for (Object* member : members) {
+                    batchedObjects.insert(member);
+                }
+                batchedCount += members.size();
+            }
+            start = end;
+        }
+    }
+
+    if (!staticBatches.empty()) {
+        std::cout << "Static batching merged " << batchedCount << " objects into " << staticBatches.size() << " batches" << std::endl;
+    }
+    bvhDirty = true;
+    return staticBatches.size();
+}
+
+void Scene::clearStaticBatches() {
+    staticBatches.clear();
+    staticMeshes.clear();
+    batchedObjects.clear();
+    bvhDirty = true;
+}
+
 // === Selection handling ===
 void Scene::selectObject(const std::string& name) {
     selectedObject = getObject(name);
@@ -357,12 +622,257 @@ void Scene::clearSelection() {
     selectedObject = nullptr;
 }
 
+// === Spatial queries ===
+void Scene::updateBounds() {
+    // Objects were added or removed, refresh everything and rebuild
+    if (bvhDirty) {
+        for (auto& [name, obj] : objects) {
+            obj->updateOBB();
+            obj->transform.markClean();
+        }
+        rebuildBVH();
+        return;
+    }
+
+    // Refit moved objects along with everything parented under them. Batched
+    // objects are walked too, so no stale world matrix is left for the draw jobs
+    movedObjects.clear();
+    for (Object* obj : objectList) {
+        if (obj->transform.needsUpdate()) {
+            getDescendants(obj, movedObjects);
+        }
+    }
+
+    for (Object* obj : movedObjects) {
+        obj->updateOBB();
+        obj->transform.markClean();
+
+        // Batched objects are not in the tree, their batch already holds them
+        auto item = bvhItems.find(obj);
+        if (item != bvhItems.end()) bvh.update(item->second, AABB::fromOBB(obj->obb));
+    }
+
+    // Refitting degrades the tree as objects drift, rebuild once it has
+    if (bvh.needsRebuild()) rebuildBVH();
+}
+
+Object* Scene::raycast(const glm::vec3& origin, const glm::vec3& dir, const std::function<bool(const Object&, float&)>& hitTest, float& t) {
+    updateBounds();
+
+    int item = bvh.queryRay(origin, dir, [&](int candidate, float& hitT) {
+        return hitTest(*bvhObjects[candidate], hitT);
+    }, t);
+    return item != -1 ? bvhObjects[item] : nullptr;
+}
+
+Object* Scene::pick(const glm::vec3& origin, const glm::vec3& dir, MeshHit& hit) {
+    // Objects whose bounds the ray enters are tested triangle by triangle, nearest first
+    float closestT = FLT_MAX;
+    float t = FLT_MAX;
+    return raycast(origin, dir, [&](const Object& obj, float& hitT) {
+        MeshHit candidate;
+        if (!obj.raycast(origin, dir, candidate) || candidate.t >= closestT) return false;
+        hit = candidate;
+        hitT = closestT = candidate.t;
+        return true;
+    }, t);
+}
+
+std::vector<Object*> Scene::queryAABB(const AABB& box) {
+    updateBounds();
+
+    std::vector<int> items;
+    bvh.queryAABB(box, items);
+    return toObjects(items);
+}
+
+std::vector<Object*> Scene::querySphere(const glm::vec3& center, float radius) {
+    updateBounds();
+
+    std::vector<int> items;
+    bvh.querySphere(center, radius, items);
+    return toObjects(items);
+}
+
 // === Rendering ===
-void Scene::draw(const Camera& camera, bool inPlaytest) {
-    for (const auto& [name, obj] : objects) {
-        if (obj->parent) continue; // Only draw root objects
-        
-        obj->draw(camera, selectedObject, inPlaytest);
+void Scene::draw(RenderFrame& frame, const Camera& camera, bool inPlaytest) {
+    if (bvhDirty) updateBounds();
+
+    // The GPU culls per instance against last frame's depth, so everything is submitted
+    visibleItems.clear();
+    if (gpuCulling) {
+        for (size_t i = 0; i < bvhObjects.size(); i++) {
+            visibleItems.push_back(static_cast<int>(i));
+        }
+        cullStats = CullStats();
+        cullStats.visible = visibleItems.size();
+    } else {
+        cullVisible(camera, inPlaytest);
+    }
+
+    // Every job records its own slice of the visible set into its own buffer
+    JobSystem& jobs = JobSystem::get();
+    size_t sliceCount = std::max<size_t>(1, std::min(jobs.getThreadCount(), visibleItems.size() / MIN_RECORD_SLICE));
+    frame.begin(camera, sliceCount);
+    frame.gpuCulling = gpuCulling;
+    findLitItems();
+    jobs.parallelFor(sliceCount, [&](size_t slice) {
+        CommandBuffer& buffer = frame.buffers[slice];
+        size_t first = visibleItems.size() * slice / sliceCount;
+        size_t last = visibleItems.size() * (slice + 1) / sliceCount;
+        for (size_t i = first; i < last; i++) {
+            int item = visibleItems[i];
+            bvhObjects[item]->draw(buffer, selectedObject, inPlaytest, getShaderFeatures(item, frame.viewPos, frame.fogStart));
+        }
+        buffer.end();
+    });
+
+    // Lights reach past their object's bounds, the light grid does their culling
+    for (auto& [name, obj] : objects) {
+        if (!obj->light) continue;
+        glm::mat4 world = obj->getWorldMatrix();
+        glm::vec3 forward = -glm::vec3(world[2]);
+        if (glm::dot(forward, forward) > 0.0f) forward = glm::normalize(forward);
+        frame.submitLight(*obj->light, glm::vec3(world[3]), forward);
+    }
+}
+
+// === Internal helpers ===
+void Scene::rebuildBVH() {
+    bvhObjects.clear();
+    bvhItems.clear();
+
+    std::vector<AABB> bounds;
+    bounds.reserve(objects.size() + staticBatches.size());
+    auto add = [&](Object* obj) {
+        bvhItems[obj] = static_cast<int>(bvhObjects.size());
+        bvhObjects.push_back(obj);
+        bounds.push_back(AABB::fromOBB(obj->obb));
+    };
+
+    // Batched objects are represented by their batch
+    for (auto& [name, obj] : objects) {
+        if (!batchedObjects.count(obj.get())) add(obj.get());
+    }
+    for (auto& batch : staticBatches) {
+        add(batch.get());
+    }
+
+    bvh.build(bounds);
+    bvhDirty = false;
+}
+
+void Scene::cullVisible(const Camera& camera, bool inPlaytest) {
+    // Whole subtrees inside the frustum are accepted without per-object tests
+    glm::mat4 viewProjection = camera.getProjectionMatrix() * camera.getViewMatrix();
+    Frustum frustum = Frustum::fromMatrix(viewProjection);
+    partialItems.clear();
+    bvh.queryFrustum(frustum, visibleItems, partialItems);
+
+    // Objects straddling a plane get the exact batched OBB test
+    cullBoxes.clear();
+    cullBoxes.reserve(partialItems.size());
+    for (int item : partialItems) {
+        cullBoxes.push(bvhObjects[item]->obb);
+    }
+    cullOBBs(frustum, cullBoxes, visibility);
+    for (size_t i = 0; i < partialItems.size(); i++) {
+        if (visibility[i]) visibleItems.push_back(partialItems[i]);
+    }
+
+    // Every object is tested on its own so a culled parent never hides visible children
+    cullStats.culled = bvhObjects.size() - visibleItems.size();
+    cullStats.occluded = 0;
+    if (occlusionCulling) cullOccluded(camera, viewProjection, inPlaytest);
+    cullStats.visible = visibleItems.size();
+}
+
+void Scene::cullOccluded(const Camera& camera, const glm::mat4& viewProjection, bool inPlaytest) {
+    // Occluders are the visible objects covering the most screen, by bounding radius over distance
+    std::vector<std::pair<float, int>> candidates;
+    for (int item : visibleItems) {
+        const Object* obj = bvhObjects[item];
+        if (!obj->mesh || (inPlaytest && obj->isPlayer)) continue;
+        float radius = glm::length(obj->obb.extents);
+        float distance = std::max(glm::length(obj->obb.center - camera.getPosition()), radius);
+        float coverage = radius / distance;
+        if (coverage >= MIN_OCCLUDER_COVERAGE) candidates.push_back({coverage, item});
+    }
+    if (candidates.empty()) return;
+
+    size_t occluderCount = std::min(candidates.size(), MAX_OCCLUDERS);
+    std::partial_sort(candidates.begin(), candidates.begin() + occluderCount, candidates.end(),
+        [](const auto& a, const auto& b) {return a.first > b.first;});
+
+    // A mesh named "<mesh>_occluder" stands in as a simplified occluder
+    occlusion.beginFrame(viewProjection);
+    occluderItems.clear();
+    for (size_t i = 0; i < occluderCount; i++) {
+        const Object* obj = bvhObjects[candidates[i].second];
+        auto proxy = occluderProxies.find(obj->mesh);
+        occlusion.addOccluder(proxy != occluderProxies.end() ? *proxy->second : *obj->mesh, obj->getWorldMatrix());
+        occluderItems.push_back(candidates[i].second);
+    }
+    occlusion.rasterize();
+
+    // Test everything else against the occluders' depth
+    std::sort(occluderItems.begin(), occluderItems.end());
+    occludeeItems.clear();
+    occludeeBoxes.clear();
+    for (int item : visibleItems) {
+        if (!std::binary_search(occluderItems.begin(), occluderItems.end(), item)) {
+            occludeeItems.push_back(item);
+            occludeeBoxes.push_back(&bvhObjects[item]->obb);
+        }
+    }
+    occlusion.cullOBBs(occludeeBoxes, visibility);
+
+    visibleItems = occluderItems;
+    for (size_t i = 0; i < occludeeItems.size(); i++) {
+        if (visibility[i]) visibleItems.push_back(occludeeItems[i]);
+    }
+    cullStats.occluded = occlusion.getStats().occluded;
+}
+
+void Scene::findLitItems() {
+    // A light only shades what its range reaches, everything else can skip the light loop
+    litItems.assign(bvhObjects.size(), 0);
+    for (auto& [name, obj] : objects) {
+        if (!obj->light) continue;
+        lightItems.clear();
+        bvh.querySphere(glm::vec3(obj->getWorldMatrix()[3]), obj->light->range, lightItems);
+        for (int item : lightItems) {
+            litItems[item] = 1;
+        }
+    }
+}
+
+unsigned int Scene::getShaderFeatures(int item, const glm::vec3& viewPos, float fogStart) const {
+    // Specular is always wanted, materials drop it when their constants make it useless
+    unsigned int features = FEATURE_HIGHLIGHT | FEATURE_SPECULAR;
+    if (litItems[item]) features |= FEATURE_LOCAL_LIGHTS;
+
+    // Fog only shows past its start, so objects wholly closer skip it
+    AABB box = AABB::fromOBB(bvhObjects[item]->obb);
+    glm::vec3 farthest = glm::max(glm::abs(box.min - viewPos), glm::abs(box.max - viewPos));
+    if (glm::dot(farthest, farthest) > fogStart * fogStart) features |= FEATURE_FOG;
+    return features;
+}
+
+std::vector<Object*> Scene::toObjects(const std::vector<int>& items) const {
+    std::vector<Object*> result;
+    result.reserve(items.size());
+    for (int item : items) {
+        result.push_back(bvhObjects[item]);
+    }
+    return result;
+}
+
+void Scene::linkOccluderProxies() {
+    occluderProxies.clear();
+    for (const auto& [name, mesh] : meshes) {
+        auto proxy = meshes.find(name + "_occluder");
+        if (proxy != meshes.end()) occluderProxies[mesh.get()] = proxy->second.get();
     }
 }
 
@@ -374,10 +884,11 @@ void Scene::loadAllMeshes() {
         if (entry.is_regular_file()) {
             std::string name = entry.path().stem().string();
             const std::string meshPath = meshRoot + "/" + name + ".vert";
-            meshes[name] = std::make_unique<Mesh>(*loadVertFile(meshPath));
+            meshes[name] = std::unique_ptr<Mesh>(loadVertFile(meshPath));
             std::cout << "    -" << name << " mesh loaded" << std::endl;
         }
     }
+    linkOccluderProxies();
 }
 
 void Scene::loadAllShaders() {
@@ -387,6 +898,9 @@ void Scene::loadAllShaders() {
         if (entry.is_directory()) {
             std::string name = entry.path().filename().string();
 
+            // Render pass programs never show up in the scene's shader list
+            if (std::find(std::begin(PASS_SHADERS), std::end(PASS_SHADERS), name) != std::end(PASS_SHADERS)) continue;
+
             std::string vertPath = entry.path().string() + "/vertex.glsl";
             std::string fragPath = entry.path().string() + "/fragment.glsl";
 
@@ -416,3 +930,43 @@ void Scene::loadAllTextures() {
         }
     }
 }
+
+void Scene::loadAllMaterials() {
+    std::cout << "===Loading in all materials===" << std::endl;
+    std::filesystem::path path = "assets/materials";
+    if (!std::filesystem::exists(path)) return;
+    for (auto& entry : std::filesystem::directory_iterator(path)) {
+        if (!entry.is_regular_file() || entry.path().extension() != ".mat") continue;
+        std::string name = entry.path().stem().string();
+        std::ifstream file(entry.path());
+
+        // shader NAME, texture FILE, color r g b a, specular s, shininess n
+        std::string line, shaderName, textureName;
+        MaterialParams params;
+        while (std::getline(file, line)) {
+            std::istringstream iss(line);
+            std::string token;
+            iss >> token;
+            if (token == "shader") {
+                iss >> shaderName;
+            } else if (token == "texture") {
+                iss >> textureName;
+            } else if (token == "color") {
+                iss >> params.color.r >> params.color.g >> params.color.b >> params.color.a;
+            } else if (token == "specular") {
+                iss >> params.specularStrength;
+            } else if (token == "shininess") {
+                iss >> params.shininess;
+            }
+        }
+
+        Shader* shader = getShader(shaderName);
+        if (!shader) {
+            std::cerr << "Material " << name << " uses missing shader '" << shaderName << "'" << std::endl;
+            continue;
+        }
+        Texture* texture = getTexture(std::filesystem::path(textureName).stem().string());
+        materials[name] = std::make_shared<Material>(name, shader, texture, params);
+        std::cout << "    -" << name << " material loaded" << std::endl;
+    }
+}
@@ -5,50 +5,181 @@
 #include <sstream>
 #include <iostream>
 #include <string>
+#include <vector>
+#include <unordered_set>
+#include <mutex>
+#include <algorithm>
+#include <climits>
 
 #include "shader.hpp"
+#include "renderthread.hpp"
+#include "glstate.hpp"
+
+// KHR_parallel_shader_compile, the loader was generated without extensions
+#ifndef GL_MAX_SHADER_COMPILER_THREADS_KHR
+#define GL_MAX_SHADER_COMPILER_THREADS_KHR 0x91B0
+#define GL_COMPLETION_STATUS_KHR 0x91B1
+#endif
+typedef void (APIENTRYP PFNGLMAXSHADERCOMPILERTHREADSKHRPROC)(GLuint count);
+
+// === Constants ===
+static const char* FEATURE_NAMES[SHADER_FEATURE_COUNT] = {"HIGHLIGHT", "FOG", "SPECULAR", "LOCAL_LIGHTS"};
+static const int SERIAL_LINKS_PER_FRAME = 1; // A driver compiling inline stalls the frame for each
+
+// === Variant requests ===
+static std::mutex requestMutex;
+static std::vector<Shader*> requestingShaders;
+static std::unordered_set<const Shader*> liveFamilies; // Full programs not yet destroyed, guarded by requestMutex
+static std::vector<Shader*> compilingShaders; // Families with links in flight, context thread only
+static bool parallelCompile = false;
 
 // === Constructor ===
 Shader::Shader(const std::string& vertexPath, const std::string& fragmentPath, const std::string& name) 
         : name(name) {
-    // Load in shaders from file path
-    std::string vertexSrc = loadShaderSource(vertexPath);
-    std::string fragmentSrc = loadShaderSource(fragmentPath);
+    // Load in shaders from file path, the sources are kept for variants
+    vertexSource = loadShaderSource(vertexPath);
+    fragmentSource = loadShaderSource(fragmentPath);
+    declared = parseFeatures(vertexSource) | parseFeatures(fragmentSource);
+    enabled = declared;
+    variants[enabled] = this;
+    {
+        std::lock_guard<std::mutex> lock(requestMutex);
+        liveFamilies.insert(this);
+    }
+    std::string vertexSrc = addDefines(vertexSource, enabled);
+    std::string fragmentSrc = addDefines(fragmentSource, enabled);
     
-    // Compile the shaders
-    GLuint vertex = compile(GL_VERTEX_SHADER, vertexSrc.c_str());
-    GLuint fragment = compile(GL_FRAGMENT_SHADER, fragmentSrc.c_str());
-
-    // Initialize new shader program
-    ID = glCreateProgram();
-
-    // Attach and link compiled shaders to program
-    glAttachShader(ID, vertex);
-    glAttachShader(ID, fragment);
-    glLinkProgram(ID);
+    // Compile and link on the thread owning the context
+    RenderThread::get().run([&]() {link(vertexSrc, fragmentSrc);});
+}
 
-    // Check if linking was successful
-    int success;
-    glGetProgramiv(ID, GL_LINK_STATUS, &success);
-    if (!success) {
-        char infoLog[512];
-        glGetProgramInfoLog(ID, 512, nullptr, infoLog);
-        std::cerr << "Shader Linking Error: " << infoLog << "\n";
-    }
+Shader::Shader(Shader& family, unsigned int features)
+        : name(family.name), declared(family.declared), enabled(features), base(&family) {
+    // Only started here, promoteVariants() hands it out once the driver is done
+    std::string vertexSrc = addDefines(family.vertexSource, enabled);
+    std::string fragmentSrc = addDefines(family.fragmentSource, enabled);
+    RenderThread::get().run([&]() {beginLink(vertexSrc, fragmentSrc);});
+}
 
-    // Delete shaders (already loaded, no need for them anymore)
-    glDeleteShader(vertex);
-    glDeleteShader(fragment);
+Shader::Shader(const std::string& computePath, const std::string& name)
+        : name(name) {
+    std::string computeSrc = loadShaderSource(computePath);
+    RenderThread::get().run([&]() {linkCompute(computeSrc);});
 }
 
 // === Deconstructor ===
 Shader::~Shader() {
-    glDeleteProgram(ID);
+    if (base == this) {
+        std::lock_guard<std::mutex> lock(requestMutex);
+        liveFamilies.erase(this);
+        requestingShaders.erase(std::remove(requestingShaders.begin(), requestingShaders.end(), this), requestingShaders.end());
+    }
+    RenderThread::get().run([this]() {
+        if (base == this) {
+            compilingShaders.erase(std::remove(compilingShaders.begin(), compilingShaders.end(), this), compilingShaders.end());
+        }
+        if (vertexStage) glDeleteShader(vertexStage);
+        if (fragmentStage) glDeleteShader(fragmentStage);
+        GLState::get().deleteProgram(ID);
+    });
 }
 
 // === Usage ===
 void Shader::use() const {
-    glUseProgram(ID);
+    GLState::get().useProgram(ID);
+}
+
+// === Variants ===
+Shader* Shader::getVariant(unsigned int features) {
+    unsigned int mask = features & base->declared;
+    Shader* variant = base->variants[mask].load(std::memory_order_acquire);
+    if (variant) return variant;
+
+    // The first request queues the family, the full program draws until the variant is linked
+    unsigned int bit = 1u << mask;
+    if (base->requested.fetch_or(bit) == 0) {
+        std::lock_guard<std::mutex> lock(requestMutex);
+        requestingShaders.push_back(base);
+    }
+    return base;
+}
+
+size_t Shader::getVariantCount() const {
+    size_t count = 0;
+    for (unsigned int mask = 0; mask < (1u << SHADER_FEATURE_COUNT); mask++) {
+        // A failed variant points back at the full program and is not counted
+        Shader* variant = base->variants[mask].load(std::memory_order_acquire);
+        if (variant && (variant != base || mask == base->enabled)) count++;
+    }
+    return count;
+}
+
+void Shader::updateVariants() {
+    // Finished links first, the ones started below get at least a frame in the background
+    compilingShaders.erase(std::remove_if(compilingShaders.begin(), compilingShaders.end(),
+        [](Shader* shader) {return !shader->promoteVariants();}), compilingShaders.end());
+
+    std::vector<Shader*> shaders;
+    {
+        std::lock_guard<std::mutex> lock(requestMutex);
+        shaders.swap(requestingShaders);
+    }
+
+    // Without parallel compilation each link blocks, so only a few start per frame
+    int budget = parallelCompile ? INT_MAX : SERIAL_LINKS_PER_FRAME;
+    std::vector<Shader*> deferred;
+    for (Shader* shader : shaders) {
+        if (std::find(deferred.begin(), deferred.end(), shader) != deferred.end()) continue;
+        budget -= shader->startVariants(budget);
+        if (!shader->compilingVariants.empty() &&
+            std::find(compilingShaders.begin(), compilingShaders.end(), shader) == compilingShaders.end()) {
+            compilingShaders.push_back(shader);
+        }
+        if (shader->requested.load() != 0) deferred.push_back(shader);
+    }
+
+    // Requests past the budget wait for the next frame. A family destroyed since the
+    // swap above already left the request list and must not come back into it.
+    if (!deferred.empty()) {
+        std::lock_guard<std::mutex> lock(requestMutex);
+        for (Shader* shader : deferred) {
+            if (liveFamilies.count(shader)) requestingShaders.push_back(shader);
+        }
+    }
+}
+
+size_t Shader::getCompilingCount() {
+    size_t count = 0;
+    for (const Shader* shader : compilingShaders) {
+        count += shader->compilingVariants.size();
+    }
+    return count;
+}
+
+// === Parallel compilation ===
+void Shader::initParallelCompile(void* (*getProcAddress)(const char* name)) {
+    // The ARB extension shares the tokens, only the entry point differs
+    bool khr = false, arb = false;
+    GLint extensionCount = 0;
+    glGetIntegerv(GL_NUM_EXTENSIONS, &extensionCount);
+    for (GLint i = 0; i < extensionCount; i++) {
+        std::string extension = reinterpret_cast<const char*>(glGetStringi(GL_EXTENSIONS, i));
+        khr |= extension == "GL_KHR_parallel_shader_compile";
+        arb |= extension == "GL_ARB_parallel_shader_compile";
+    }
+
+    PFNGLMAXSHADERCOMPILERTHREADSKHRPROC maxThreads = nullptr;
+    if (khr) maxThreads = (PFNGLMAXSHADERCOMPILERTHREADSKHRPROC)getProcAddress("glMaxShaderCompilerThreadsKHR");
+    if (!maxThreads && arb) maxThreads = (PFNGLMAXSHADERCOMPILERTHREADSKHRPROC)getProcAddress("glMaxShaderCompilerThreadsARB");
+
+    // The driver picks the thread count
+    parallelCompile = maxThreads != nullptr;
+    if (parallelCompile) maxThreads(0xFFFFFFFF);
+    std::cout << "Parallel shader compilation " << (parallelCompile ? "enabled" : "unavailable") << std::endl;
+}
+
+bool Shader::hasParallelCompile() {
+    return parallelCompile;
 }
 
 // === Getters ===
@@ -87,6 +218,14 @@ void Shader::setVec2(const std::string& name, const glm::vec2& value) const {
     }
 }
 
+void Shader::setVec4(const std::string& name, const glm::vec4& value) const {
+    glUniform4fv(glGetUniformLocation(ID, name.c_str()), 1, glm::value_ptr(value));
+}
+
+void Shader::setIVec2(const std::string& name, const glm::ivec2& value) const {
+    glUniform2i(glGetUniformLocation(ID, name.c_str()), value.x, value.y);
+}
+
 void Shader::setFloat(const std::string& name, float value) const {
     GLint location = glGetUniformLocation(ID, name.c_str());
     if (location == -1) {
@@ -107,15 +246,87 @@ void Shader::setBool(const std::string &name, bool value) const {
     glUniform1i(glGetUniformLocation(ID, name.c_str()), (int)value);
 }
 
+void Shader::setUniformBlock(const std::string& name, unsigned int binding) const {
+    GLuint index = glGetUniformBlockIndex(ID, name.c_str());
+    if (index != GL_INVALID_INDEX) {
+        glUniformBlockBinding(ID, index, binding);
+    }
+}
+
 // === Internal compilation ===
+void Shader::link(const std::string& vertexSrc, const std::string& fragmentSrc) {
+    beginLink(vertexSrc, fragmentSrc);
+    finishLink();
+}
+
+void Shader::beginLink(const std::string& vertexSrc, const std::string& fragmentSrc) {
+    // Compile the shaders, nothing is queried so a parallel driver keeps going in the background
+    vertexStage = compile(GL_VERTEX_SHADER, vertexSrc.c_str());
+    fragmentStage = compile(GL_FRAGMENT_SHADER, fragmentSrc.c_str());
+
+    // Initialize new shader program
+    ID = glCreateProgram();
+
+    // Attach and link compiled shaders to program
+    glAttachShader(ID, vertexStage);
+    glAttachShader(ID, fragmentStage);
+    glLinkProgram(ID);
+}
+
+bool Shader::isLinkComplete() const {
+    // Without the extension any query waits, so the link counts as done
+    if (!parallelCompile) return true;
+    GLint complete = GL_FALSE;
+    glGetProgramiv(ID, GL_COMPLETION_STATUS_KHR, &complete);
+    return complete == GL_TRUE;
+}
+
+bool Shader::finishLink() {
+    bool success = checkCompile(vertexStage);
+    success &= checkCompile(fragmentStage);
+    success &= checkLink();
+
+    // Delete shaders (already loaded, no need for them anymore)
+    glDeleteShader(vertexStage);
+    glDeleteShader(fragmentStage);
+    vertexStage = 0;
+    fragmentStage = 0;
+    return success;
+}
+
+void Shader::linkCompute(const std::string& computeSrc) {
+    GLuint compute = compile(GL_COMPUTE_SHADER, computeSrc.c_str());
+    checkCompile(compute);
+    ID = glCreateProgram();
+    glAttachShader(ID, compute);
+    glLinkProgram(ID);
+    checkLink();
+    glDeleteShader(compute);
+}
+
+bool Shader::checkLink() {
+    // Check if linking was successful
+    int success;
+    glGetProgramiv(ID, GL_LINK_STATUS, &success);
+    if (!success) {
+        char infoLog[512];
+        glGetProgramInfoLog(ID, 512, nullptr, infoLog);
+        std::cerr << "Shader Linking Error: " << infoLog << "\n";
+    }
+    return success;
+}
+
 GLuint Shader::compile(GLenum type, const char* src) {
     // Creates shader
     GLuint shader = glCreateShader(type);
     glShaderSource(shader, 1, &src, nullptr);
 
-    // Compiles shader
+    // Compiles shader, checkCompile() reads the result
     glCompileShader(shader);
+    return shader;
+}
 
+bool Shader::checkCompile(GLuint shader) {
     // Check for compilation errors
     int success;
     glGetShaderiv(shader, GL_COMPILE_STATUS, &success);
@@ -124,9 +335,84 @@ GLuint Shader::compile(GLenum type, const char* src) {
         glGetShaderInfoLog(shader, 512, nullptr, infoLog);
         std::cerr << "Shader Compile Error: " << infoLog << "\n";
     }
+    return success;
+}
 
-    // Return final shader
-    return shader;
+int Shader::startVariants(int budget) {
+    int started = 0;
+    for (unsigned int mask = 0; mask < (1u << SHADER_FEATURE_COUNT) && started < budget; mask++) {
+        unsigned int bit = 1u << mask;
+        if (!(requested.load() & bit)) continue;
+        requested.fetch_and(~bit);
+
+        // Asked for again while linking or by another job in the same frame
+        if (variants[mask].load(std::memory_order_acquire)) continue;
+        auto linking = [mask](const std::unique_ptr<Shader>& variant) {return variant->enabled == mask;};
+        if (std::any_of(compilingVariants.begin(), compilingVariants.end(), linking)) continue;
+
+        compilingVariants.emplace_back(new Shader(*this, mask));
+        started++;
+    }
+    return started;
+}
+
+bool Shader::promoteVariants() {
+    for (auto it = compilingVariants.begin(); it != compilingVariants.end();) {
+        Shader* variant = it->get();
+        if (!variant->isLinkComplete()) {
+            ++it;
+            continue;
+        }
+
+        // A variant that failed to build is not asked for again, the full program keeps drawing
+        bool linked = variant->finishLink();
+        variants[variant->enabled].store(linked ? variant : this, std::memory_order_release);
+        ownedVariants.push_back(std::move(*it));
+        it = compilingVariants.erase(it);
+    }
+    return !compilingVariants.empty();
+}
+
+unsigned int Shader::parseFeatures(const std::string& source) {
+    unsigned int features = 0;
+    std::istringstream lines(source);
+    std::string line;
+    while (std::getline(lines, line)) {
+        std::istringstream words(line);
+        std::string directive, pragma, feature;
+        words >> directive >> pragma;
+        if (directive != "#pragma" || pragma != "feature") continue;
+
+        while (words >> feature) {
+            int index = -1;
+            for (int i = 0; i < SHADER_FEATURE_COUNT; i++) {
+                if (feature == FEATURE_NAMES[i]) index = i;
+            }
+            if (index == -1) {
+                std::cerr << "Warning: Unknown shader feature '" << feature << "'\n";
+            } else {
+                features |= 1u << index;
+            }
+        }
+    }
+    return features;
+}
+
+std::string Shader::addDefines(const std::string& source, unsigned int features) {
+    // Defines go right after #version, #line keeps error line numbers matching the file
+    size_t version = source.find("#version");
+    size_t insert = version == std::string::npos ? 0 : source.find('\n', version);
+    if (insert == std::string::npos) return source;
+    if (version != std::string::npos) insert++;
+
+    std::string defines;
+    for (int i = 0; i < SHADER_FEATURE_COUNT; i++) {
+        if (features & (1u << i)) defines += std::string("#define ") + FEATURE_NAMES[i] + " 1\n";
+    }
+    if (defines.empty()) return source;
+    int line = static_cast<int>(std::count(source.begin(), source.begin() + insert, '\n')) + 1;
+    defines += "#line " + std::to_string(line) + "\n";
+    return source.substr(0, insert) + defines + source.substr(insert);
 }
 
 // === Loader ===
@@ -1,51 +1,151 @@
 #include <glad/glad.h>
 #include "texture.hpp"
+#include "texturestreamer.hpp"
+#include "renderthread.hpp"
+#include "glstate.hpp"
 #include <stb_image.h>
+#include <algorithm>
 #include <iostream>
 
+// === Constants ===
+static const size_t GPU_BYTES_PER_TEXEL = 4; // Drivers pad RGB to RGBA
+
 // === Constructor ===
 Texture::Texture(const std::string& path) {
     name = path.substr(path.find_last_of("/\\") + 1);
     stbi_set_flip_vertically_on_load(true);
 
-    int width, height, channels;
+    int width, height;
     unsigned char* data = stbi_load(path.c_str(), &width, &height, &channels, 0);
     if (!data) {
         std::cerr << "Failed to load texture: " << path << std::endl;
         return;
     }
 
-    GLenum format = GL_RGB;
-    if (channels == 4) format = GL_RGBA;
-
-    glGenTextures(1, &id);
-    glBindTexture(GL_TEXTURE_2D, id);
+    // The whole chain is decoded here, the streamer picks which part is on the GPU
+    buildMips(data, width, height);
+    stbi_image_free(data);
 
-    glTexImage2D(GL_TEXTURE_2D, 0, format, width, height, 0, format, GL_UNSIGNED_BYTE, data);
-    glGenerateMipmap(GL_TEXTURE_2D);
+    // Uploaded on the thread owning the context, starting from the smallest mips
+    RenderThread::get().run([this]() {
+        glGenTextures(1, &id);
+        GLState::get().bindTexture(0, GL_TEXTURE_2D, id);
 
-    // Texture parameters
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);	
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT);	
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);	
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+        // Texture parameters
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
 
-    stbi_image_free(data);
+        TextureStreamer::get().add(this);
+    });
 }
 
 // === Deconstructor ===
 Texture::~Texture() {
     if (id) {
-        glDeleteTextures(1, &id);
+        RenderThread::get().run([this]() {
+            TextureStreamer::get().remove(this);
+            GLState::get().deleteTexture(id);
+        });
     }
 }
 
+// === Streaming ===
+void Texture::makeResident(int mip) {
+    if (!id || mips.empty()) return;
+    mip = std::clamp(mip, 0, getMipCount() - 1);
+    int levels = getMipCount() - mip;
+    int previousLevels = residentMip < 0 ? 0 : getMipCount() - residentMip;
+
+    GLenum format = channels == 4 ? GL_RGBA : GL_RGB;
+    GLState::get().bindTexture(0, GL_TEXTURE_2D, id);
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+
+    // Level 0 is the finest resident mip, the sampler never sees the rest of the chain
+    for (int level = 0; level < levels; level++) {
+        const MipLevel& source = mips[mip + level];
+        glTexImage2D(GL_TEXTURE_2D, level, format, source.width, source.height, 0, format, GL_UNSIGNED_BYTE, source.data.data());
+    }
+
+    // Levels left over from a longer chain are emptied so their memory goes back
+    for (int level = levels; level < previousLevels; level++) {
+        glTexImage2D(GL_TEXTURE_2D, level, format, 0, 0, 0, format, GL_UNSIGNED_BYTE, nullptr);
+    }
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAX_LEVEL, levels - 1);
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+    residentMip = mip;
+}
+
+size_t Texture::getResidentBytes(int mip) const {
+    size_t bytes = 0;
+    for (int i = std::max(mip, 0); i < getMipCount(); i++) {
+        bytes += static_cast<size_t>(mips[i].width) * mips[i].height * GPU_BYTES_PER_TEXEL;
+    }
+    return bytes;
+}
+
+size_t Texture::getUploadBytes(int mip) const {
+    size_t bytes = 0;
+    for (int i = std::max(mip, 0); i < getMipCount(); i++) {
+        bytes += mips[i].data.size();
+    }
+    return bytes;
+}
+
 // === Usage ===
 void Texture::bind(unsigned int slot) const {
-    if (id == 0) {
-        std::cerr << "Warning: Trying to bind texture with id=0\n";
-        return;
+    // A texture that failed to load binds 0, so the slot doesn't keep the previous texture
+    GLState::get().bindTexture(static_cast<int>(slot), GL_TEXTURE_2D, id);
+}
+
+// === Internal helpers ===
+// Source texels under one destination texel with their coverage, a texel spans 2 to 3 source texels
+static void getFootprint(int destination, int sourceSize, int destinationSize, int* indices, float* weights, int& count) {
+    float scale = static_cast<float>(sourceSize) / destinationSize;
+    float begin = destination * scale;
+    float end = begin + scale;
+    count = 0;
+    for (int i = static_cast<int>(begin); i < sourceSize && i < end; i++) {
+        float coverage = std::min(end, i + 1.0f) - std::max(begin, static_cast<float>(i));
+        if (coverage <= 0.0f) continue;
+        indices[count] = i;
+        weights[count] = coverage / scale;
+        count++;
+    }
+}
+
+void Texture::buildMips(const unsigned char* pixels, int width, int height) {
+    mips.clear();
+    mips.push_back({width, height, std::vector<unsigned char>(pixels, pixels + static_cast<size_t>(width) * height * channels)});
+
+    // Area-weighted box filter, odd sizes keep their texel centers aligned with the level above
+    while (mips.back().width > 1 || mips.back().height > 1) {
+        const MipLevel& source = mips.back();
+        MipLevel next;
+        next.width = std::max(1, source.width / 2);
+        next.height = std::max(1, source.height / 2);
+        next.data.resize(static_cast<size_t>(next.width) * next.height * channels);
+
+        int xIndices[4], yIndices[4];
+        float xWeights[4], yWeights[4];
+        int xCount, yCount;
+        for (int y = 0; y < next.height; y++) {
+            getFootprint(y, source.height, next.height, yIndices, yWeights, yCount);
+            for (int x = 0; x < next.width; x++) {
+                getFootprint(x, source.width, next.width, xIndices, xWeights, xCount);
+                for (int c = 0; c < channels; c++) {
+                    float sum = 0.0f;
+                    for (int j = 0; j < yCount; j++) {
+                        const unsigned char* row = &source.data[static_cast<size_t>(yIndices[j]) * source.width * channels];
+                        for (int i = 0; i < xCount; i++) {
+                            sum += row[xIndices[i] * channels + c] * xWeights[i] * yWeights[j];
+                        }
+                    }
+                    next.data[(static_cast<size_t>(y) * next.width + x) * channels + c] = static_cast<unsigned char>(std::min(sum + 0.5f, 255.0f));
+                }
+            }
+        }
+        mips.push_back(std::move(next));
     }
-    glActiveTexture(GL_TEXTURE0 + slot);
-    glBindTexture(GL_TEXTURE_2D, id);
 }
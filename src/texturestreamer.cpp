@@ -0,0 +1,150 @@
+#include <algorithm>
+#include <cmath>
+#include <vector>
+
+#include "texturestreamer.hpp"
+
+// === Constants ===
+static const size_t UNUSED_FRAMES = 120; // Frames without a draw before a texture falls back to its starting mips
+
+// === Singleton access ===
+TextureStreamer& TextureStreamer::get() {
+    static TextureStreamer instance;
+    return instance;
+}
+
+// === Registry ===
+void TextureStreamer::add(Texture* texture) {
+    Entry& entry = entries[texture];
+    entry.wantedMip = getStartMip(*texture);
+    entry.lastUsed = frame;
+    setResident(texture, entry.wantedMip);
+}
+
+void TextureStreamer::remove(Texture* texture) {
+    auto it = entries.find(texture);
+    if (it == entries.end()) return;
+    residentBytes -= texture->getResidentBytes(texture->getResidentMip());
+    entries.erase(it);
+}
+
+// === Frame ===
+void TextureStreamer::request(Texture* texture, float screenSize) {
+    auto it = entries.find(texture);
+    if (it == entries.end()) return;
+    it->second.screenSize = std::max(it->second.screenSize, screenSize);
+}
+
+void TextureStreamer::update(int viewportHeight) {
+    frame++;
+    TextureStreamStats frameStats;
+
+    // Wanted mips, a mip is fine enough once a texel covers at least a pixel
+    std::vector<Texture*> raise;
+    for (auto& [texture, entry] : entries) {
+        int startMip = getStartMip(*texture);
+        if (entry.screenSize > 0.0f) {
+            float pixels = entry.screenSize * 0.5f * viewportHeight;
+            float texels = static_cast<float>(std::max(texture->getWidth(), texture->getHeight()));
+            int mip = pixels > 0.0f ? static_cast<int>(std::floor(std::log2(std::max(texels / pixels, 1.0f)))) : startMip;
+            entry.wantedMip = std::min(mip, startMip);
+            entry.lastUsed = frame;
+            entry.screenSize = 0.0f;
+        } else if (frame - entry.lastUsed > UNUSED_FRAMES) {
+            entry.wantedMip = startMip;
+        }
+
+        if (texture->getResidentMip() > entry.wantedMip) raise.push_back(texture);
+        frameStats.fullBytes += texture->getResidentBytes(0);
+    }
+
+    // Largest shortfall first, the name breaks ties so the order is stable
+    std::sort(raise.begin(), raise.end(), [this](Texture* a, Texture* b) {
+        int shortfallA = a->getResidentMip() - entries[a].wantedMip;
+        int shortfallB = b->getResidentMip() - entries[b].wantedMip;
+        if (shortfallA != shortfallB) return shortfallA > shortfallB;
+        return a->getName() < b->getName();
+    });
+
+    size_t budget = uploadBudget;
+    size_t memory = memoryBudget;
+    for (Texture* texture : raise) {
+        int resident = texture->getResidentMip();
+        int wanted = entries[texture].wantedMip;
+
+        // One step, then as many more as the budget allows
+        int target = resident - 1;
+        if (frameStats.uploadedBytes > 0 && frameStats.uploadedBytes + texture->getUploadBytes(target) > budget) {
+            frameStats.pending++;
+            continue;
+        }
+        while (target > wanted && frameStats.uploadedBytes + texture->getUploadBytes(target - 1) <= budget) {
+            target--;
+        }
+
+        // Room is made from mips other textures no longer need
+        size_t growth = texture->getResidentBytes(target) - texture->getResidentBytes(resident);
+        if (residentBytes + growth > memory) {
+            freeMemory(memory > growth ? memory - growth : 0, frameStats);
+            if (residentBytes + growth > memory) {
+                frameStats.pending++;
+                continue;
+            }
+        }
+
+        frameStats.uploadedBytes += texture->getUploadBytes(target);
+        frameStats.uploads++;
+        setResident(texture, target);
+        if (target > wanted) frameStats.pending++;
+    }
+
+    // A lowered budget is honoured without waiting for a texture to grow
+    if (residentBytes > memory) freeMemory(memory, frameStats);
+
+    frameStats.textures = entries.size();
+    frameStats.residentBytes = residentBytes;
+    std::lock_guard<std::mutex> lock(statsMutex);
+    stats = frameStats;
+}
+
+// === Stats ===
+TextureStreamStats TextureStreamer::getStats() const {
+    std::lock_guard<std::mutex> lock(statsMutex);
+    return stats;
+}
+
+// === Internal helpers ===
+int TextureStreamer::getStartMip(const Texture& texture) {
+    int mip = 0;
+    int size = std::max(texture.getWidth(), texture.getHeight());
+    while (size > START_SIZE && mip < texture.getMipCount() - 1) {
+        size = std::max(1, size / 2);
+        mip++;
+    }
+    return mip;
+}
+
+void TextureStreamer::setResident(Texture* texture, int mip) {
+    int previous = texture->getResidentMip();
+    if (previous >= 0) residentBytes -= texture->getResidentBytes(previous);
+    texture->makeResident(mip);
+    residentBytes += texture->getResidentBytes(texture->getResidentMip());
+}
+
+void TextureStreamer::freeMemory(size_t target, TextureStreamStats& frameStats) {
+    // Least recently drawn first, only mips finer than wanted are given back
+    std::vector<Texture*> excess;
+    for (auto& [texture, entry] : entries) {
+        if (texture->getResidentMip() < entry.wantedMip) excess.push_back(texture);
+    }
+    std::sort(excess.begin(), excess.end(), [this](Texture* a, Texture* b) {
+        if (entries[a].lastUsed != entries[b].lastUsed) return entries[a].lastUsed < entries[b].lastUsed;
+        return a->getName() < b->getName();
+    });
+
+    for (Texture* texture : excess) {
+        if (residentBytes <= target) break;
+        setResident(texture, entries[texture].wantedMip);
+        frameStats.drops++;
+    }
+}
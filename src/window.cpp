@@ -2,6 +2,7 @@
 #include <iostream>
 
 #include "window.hpp"
+#include "shader.hpp"
 
 // === Constructor ===
 Window::Window(const std::string& title, bool fullscreen)
@@ -14,11 +15,6 @@ Window::Window(const std::string& title, bool fullscreen)
         return;
     }
 
-    // Set OpenGL version
-    glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 3);
-    glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 3);
-    glfwWindowHint(GLFW_OPENGL_PROFILE, GLFW_OPENGL_CORE_PROFILE);
-
     // Get monitor
     GLFWmonitor* monitor = nullptr;
     const GLFWvidmode* mode = nullptr;
@@ -31,8 +27,17 @@ Window::Window(const std::string& title, bool fullscreen)
         height = mode->height;
     }
 
-    // Create window
-    window = glfwCreateWindow(width, height, title.c_str(), monitor, nullptr);
+    // Create window, asking for the newest OpenGL version first and falling back to 3.3
+    const int glVersions[][2] = {{4, 6}, {4, 3}, {3, 3}};
+    window = nullptr;
+    for (const auto& version : glVersions) {
+        glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, version[0]);
+        glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, version[1]);
+        glfwWindowHint(GLFW_OPENGL_PROFILE, GLFW_OPENGL_CORE_PROFILE);
+
+        window = glfwCreateWindow(width, height, title.c_str(), monitor, nullptr);
+        if (window) break;
+    }
     if (!window) {
         std::cerr << "Failed to create GLFW window\n";
         glfwTerminate();
@@ -42,15 +47,14 @@ Window::Window(const std::string& title, bool fullscreen)
     // Bind OpenGL to current thread
     glfwMakeContextCurrent(window);
 
-    // Resize viewport when screen resizes
-    glfwSetWindowUserPointer(window, this);
+    // Track the framebuffer size, the render thread sets the viewport from it.
+    // The user pointer is the Context main() installs for every callback.
     glfwSetFramebufferSizeCallback(window, [](GLFWwindow* win, int w, int h) {
-        glViewport(0, 0, w, h);
-        
         // Set new dims
-        Window* self = static_cast<Window*>(glfwGetWindowUserPointer(win));
-        self->width = w;
-        self->height = h;
+        Context* context = static_cast<Context*>(glfwGetWindowUserPointer(win));
+        if (!context) return;
+        context->window->width = w;
+        context->window->height = h;
     });
 
     // Load OpenGL functions using GLAD
@@ -58,6 +62,7 @@ Window::Window(const std::string& title, bool fullscreen)
         std::cerr << "Failed to initialize GLAD\n";
         std::exit(-1);
     }
+    Shader::initParallelCompile((void* (*)(const char*))glfwGetProcAddress);
 }
 
 // === Deconstructor ===
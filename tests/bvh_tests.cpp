@@ -0,0 +1,194 @@
+#include <algorithm>
+#include <cmath>
+#include <iomanip>
+#include <random>
+#include <glm/gtc/matrix_transform.hpp>
+
+#include "check.hpp"
+#include "bvh.hpp"
+
+// === Constants ===
+static const size_t SIZES[] = {10000, 100000, 1000000};
+static const int FRUSTUM_QUERIES = 20;
+static const int QUERIES = 200;
+static const float DENSITY_SPACING = 4.0f; // World units per item along each axis
+
+// === Helpers ===
+// Random boxes at a fixed density, so every size sees about the same overlap per query
+static std::vector<AABB> makeBoxes(size_t count, float side, std::mt19937& rng) {
+    std::uniform_real_distribution<float> position(-side * 0.5f, side * 0.5f);
+    std::uniform_real_distribution<float> size(0.1f, 2.0f);
+    std::vector<AABB> boxes(count);
+    for (AABB& box : boxes) {
+        glm::vec3 center(position(rng), position(rng), position(rng));
+        glm::vec3 half(size(rng), size(rng), size(rng));
+        box = AABB(center - half, center + half);
+    }
+    return boxes;
+}
+
+static glm::vec3 randomDirection(std::mt19937& rng) {
+    std::normal_distribution<float> normal;
+    glm::vec3 dir(normal(rng), normal(rng), normal(rng));
+    return glm::normalize(dir);
+}
+
+// Same plane tests as the tree, so both sides round alike
+static bool touchesFrustum(const Frustum& frustum, const AABB& box) {
+    for (const glm::vec4& plane : frustum.planes) {
+        glm::vec3 positive(plane.x >= 0 ? box.max.x : box.min.x,
+                           plane.y >= 0 ? box.max.y : box.min.y,
+                           plane.z >= 0 ? box.max.z : box.min.z);
+        if (glm::dot(glm::vec3(plane), positive) + plane.w < 0.0f) return false;
+    }
+    return true;
+}
+
+static float getEntry(const AABB& box, const glm::vec3& origin, const glm::vec3& invDir) {
+    glm::vec3 t0 = (box.min - origin) * invDir;
+    glm::vec3 t1 = (box.max - origin) * invDir;
+    glm::vec3 tNear = glm::min(t0, t1);
+    glm::vec3 tFar = glm::max(t0, t1);
+    float enter = std::max(std::max(tNear.x, tNear.y), std::max(tNear.z, 0.0f));
+    float exit = std::min(std::min(tFar.x, tFar.y), tFar.z);
+    return enter <= exit ? enter : FLT_MAX;
+}
+
+static bool touchesSphere(const AABB& box, const glm::vec3& center, float radius) {
+    glm::vec3 closest = glm::clamp(center, box.min, box.max);
+    glm::vec3 delta = closest - center;
+    return glm::dot(delta, delta) <= radius * radius;
+}
+
+static bool sameItems(std::vector<int> a, std::vector<int> b) {
+    std::sort(a.begin(), a.end());
+    std::sort(b.begin(), b.end());
+    return a == b;
+}
+
+// Every query kind against a linear scan over the same boxes, returns the mismatch count
+static int compareQueries(const BVH& bvh, const std::vector<AABB>& boxes, float side, std::mt19937& rng,
+                          double& treeMs, double& bruteMs) {
+    std::uniform_real_distribution<float> position(-side * 0.5f, side * 0.5f);
+    int mismatches = 0;
+    std::vector<int> tree, partial, brute;
+
+    // Frustum, partially covered leaves are filtered per item like the scene does
+    for (int q = 0; q < FRUSTUM_QUERIES; q++) {
+        glm::vec3 eye(position(rng), position(rng), position(rng));
+        glm::mat4 view = glm::lookAt(eye, eye + randomDirection(rng), glm::vec3(0.0f, 1.0f, 0.0f));
+        glm::mat4 projection = glm::perspective(glm::radians(60.0f), 16.0f / 9.0f, 0.1f, side * 0.25f);
+        Frustum frustum = Frustum::fromMatrix(projection * view);
+
+        tree.clear();
+        partial.clear();
+        brute.clear();
+        treeMs += timeMs([&]() {
+            bvh.queryFrustum(frustum, tree, partial);
+            for (int item : partial) {
+                if (touchesFrustum(frustum, boxes[item])) tree.push_back(item);
+            }
+        });
+        bruteMs += timeMs([&]() {
+            for (size_t i = 0; i < boxes.size(); i++) {
+                if (touchesFrustum(frustum, boxes[i])) brute.push_back(static_cast<int>(i));
+            }
+        });
+        if (!sameItems(tree, brute)) mismatches++;
+    }
+
+    for (int q = 0; q < QUERIES; q++) {
+        glm::vec3 center(position(rng), position(rng), position(rng));
+
+        // Ray, closest entry distance into any box
+        glm::vec3 dir = randomDirection(rng);
+        glm::vec3 invDir = 1.0f / dir;
+        float treeT = FLT_MAX;
+        int treeItem = -1;
+        treeMs += timeMs([&]() {
+            treeItem = bvh.queryRay(center, dir, [&](int item, float& t) {
+                t = getEntry(boxes[item], center, invDir);
+                return t != FLT_MAX;
+            }, treeT);
+        });
+        float bruteT = FLT_MAX;
+        bruteMs += timeMs([&]() {
+            for (const AABB& box : boxes) {
+                bruteT = std::min(bruteT, getEntry(box, center, invDir));
+            }
+        });
+        if (bruteT == FLT_MAX ? treeItem != -1 : (treeItem == -1 || treeT != bruteT)) mismatches++;
+
+        // Box overlap
+        AABB query(center - glm::vec3(DENSITY_SPACING * 2.0f), center + glm::vec3(DENSITY_SPACING * 2.0f));
+        tree.clear();
+        brute.clear();
+        treeMs += timeMs([&]() {bvh.queryAABB(query, tree);});
+        bruteMs += timeMs([&]() {
+            for (size_t i = 0; i < boxes.size(); i++) {
+                if (boxes[i].overlaps(query)) brute.push_back(static_cast<int>(i));
+            }
+        });
+        if (!sameItems(tree, brute)) mismatches++;
+
+        // Sphere
+        float radius = DENSITY_SPACING * 2.5f;
+        tree.clear();
+        brute.clear();
+        treeMs += timeMs([&]() {bvh.querySphere(center, radius, tree);});
+        bruteMs += timeMs([&]() {
+            for (size_t i = 0; i < boxes.size(); i++) {
+                if (touchesSphere(boxes[i], center, radius)) brute.push_back(static_cast<int>(i));
+            }
+        });
+        if (!sameItems(tree, brute)) mismatches++;
+    }
+    return mismatches;
+}
+
+// === Tests ===
+TEST(bvhQueriesMatchBruteForce) {
+    std::mt19937 rng(29);
+    std::cout << std::fixed << std::setprecision(3);
+
+    for (size_t count : SIZES) {
+        float side = std::cbrt(static_cast<float>(count)) * DENSITY_SPACING;
+        std::vector<AABB> boxes = makeBoxes(count, side, rng);
+
+        BVH bvh;
+        double buildMs = timeMs([&]() {bvh.build(boxes);});
+        CHECK(bvh.getItemCount() == count);
+
+        double treeMs = 0.0, bruteMs = 0.0;
+        int mismatches = compareQueries(bvh, boxes, side, rng, treeMs, bruteMs);
+        CHECK(mismatches == 0);
+
+        int queryCount = FRUSTUM_QUERIES + QUERIES * 3;
+        std::cout << "  " << std::setw(7) << count << " items: build " << buildMs << " ms, "
+                  << treeMs / queryCount << " ms per query vs " << bruteMs / queryCount << " ms brute force ("
+                  << bruteMs / std::max(treeMs, 1e-6) << "x), " << mismatches << " mismatches" << std::endl;
+    }
+}
+
+TEST(bvhRefitMatchesBruteForce) {
+    std::mt19937 rng(30);
+    const size_t count = SIZES[0];
+    float side = std::cbrt(static_cast<float>(count)) * DENSITY_SPACING;
+    std::vector<AABB> boxes = makeBoxes(count, side, rng);
+
+    BVH bvh;
+    bvh.build(boxes);
+
+    // Move a tenth of the items far enough to leave their leaves
+    std::uniform_int_distribution<size_t> pick(0, count - 1);
+    std::uniform_real_distribution<float> offset(-side * 0.25f, side * 0.25f);
+    for (size_t i = 0; i < count / 10; i++) {
+        size_t item = pick(rng);
+        glm::vec3 move(offset(rng), offset(rng), offset(rng));
+        boxes[item] = AABB(boxes[item].min + move, boxes[item].max + move);
+        bvh.update(static_cast<int>(item), boxes[item]);
+    }
+
+    double treeMs = 0.0, bruteMs = 0.0;
+    CHECK(compareQueries(bvh, boxes, side, rng, treeMs, bruteMs) == 0);
+}
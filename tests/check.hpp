@@ -0,0 +1,43 @@
+#pragma once
+
+#include <chrono>
+#include <iostream>
+#include <vector>
+
+// Test case definition
+// Test files register their cases with TEST(name) and main() runs them in
+// registration order. CHECK counts a failure and carries on, so one run
+// reports every mismatch. Benchmarks are plain test cases printing timings.
+struct TestCase {
+    const char* name;
+    void (*run)();
+};
+
+// Registry
+std::vector<TestCase>& getTests();
+int& getFailureCount();
+
+struct TestRegistrar {
+    TestRegistrar(const char* name, void (*run)()) {getTests().push_back({name, run});}
+};
+
+#define TEST(name) \
+    static void name(); \
+    static TestRegistrar name##Registrar(#name, name); \
+    static void name()
+
+#define CHECK(condition) \
+    do { \
+        if (!(condition)) { \
+            std::cerr << "    FAILED " << __FILE__ << ":" << __LINE__ << ": " << #condition << std::endl; \
+            getFailureCount()++; \
+        } \
+    } while (0)
+
+// Milliseconds a call takes
+template <typename Call>
+double timeMs(Call&& call) {
+    auto start = std::chrono::steady_clock::now();
+    call();
+    return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+}
@@ -0,0 +1,154 @@
+#include <map>
+#include <memory>
+#include <random>
+#include <set>
+#include <tuple>
+#include <glm/gtc/matrix_transform.hpp>
+
+#include "check.hpp"
+#include "nullgl.hpp"
+#include "commandbuffer.hpp"
+
+// === Constants ===
+static const int BUFFER_COUNT = 4;
+static const int ITEMS_PER_BUFFER = 500;
+
+// === Helpers ===
+// What an instance should be drawn with, keyed by the id carried in params.w
+struct Expected {
+    unsigned int program;
+    unsigned int material;
+    const Mesh* mesh;
+};
+
+// Null backend that also checks every replayed instance against what was submitted
+class CheckingBackend : public NullBackend {
+public:
+    CheckingBackend(const CommandStream& stream, const std::map<int, Expected>& expected, const std::map<unsigned int, const Mesh*>& meshes)
+        : NullBackend(stream), stream(stream), expected(expected), meshes(meshes) {}
+
+    void bindProgram(Shader* shader) override {
+        NullBackend::bindProgram(shader);
+        program = shader ? shader->getID() : 0;
+    }
+
+    void bindMaterial(unsigned int boundMaterial, Texture* texture) override {
+        NullBackend::bindMaterial(boundMaterial, texture);
+        material = boundMaterial;
+    }
+
+    void draw(size_t firstCommand, size_t commandCount) override {
+        NullBackend::draw(firstCommand, commandCount);
+        for (size_t i = firstCommand; i < firstCommand + commandCount && i < stream.getDraws().size(); i++) {
+            const DrawElementsIndirectCommand& command = stream.getDraws()[i];
+            auto mesh = meshes.find(command.firstIndex);
+            for (unsigned int j = command.baseInstance; j < command.baseInstance + command.instanceCount; j++) {
+                int id = static_cast<int>(stream.getInstances()[j].params.w);
+                auto item = expected.find(id);
+                bool right = item != expected.end() && mesh != meshes.end() && item->second.program == program
+                          && item->second.material == material && item->second.mesh == mesh->second;
+                wrong += !right;
+                drawn.insert(id);
+            }
+        }
+    }
+
+    // Instances drawn with another program, material or mesh than submitted
+    size_t wrong = 0;
+    std::multiset<int> drawn;
+
+private:
+    const CommandStream& stream;
+    const std::map<int, Expected>& expected;
+    const std::map<unsigned int, const Mesh*>& meshes;
+    unsigned int program = 0;
+    unsigned int material = 0;
+};
+
+static std::unique_ptr<Mesh> makeMesh(const std::string& name, float size) {
+    std::vector<Vertex> vertices(3);
+    vertices[0].position = glm::vec3(-size, 0.0f, 0.0f);
+    vertices[1].position = glm::vec3(size, 0.0f, 0.0f);
+    vertices[2].position = glm::vec3(0.0f, size, 0.0f);
+    auto mesh = std::make_unique<Mesh>(name, vertices, std::vector<unsigned int>{0, 1, 2});
+    mesh->calculateBounds(vertices);
+    return mesh;
+}
+
+// === Tests ===
+TEST(commandStreamReplaysWhatWasSubmitted) {
+    loadNullGL();
+
+    // Three programs, the last two share one GL name like a variant still drawing with its fallback
+    std::vector<std::unique_ptr<Shader>> shaders;
+    shaders.push_back(std::make_unique<Shader>("assets/shaders/default/vertex.glsl", "assets/shaders/default/fragment.glsl", "a"));
+    setNextNullGLName(1000);
+    shaders.push_back(std::make_unique<Shader>("assets/shaders/default/vertex.glsl", "assets/shaders/default/fragment.glsl", "b"));
+    setNextNullGLName(1000);
+    shaders.push_back(std::make_unique<Shader>("assets/shaders/default/vertex.glsl", "assets/shaders/default/fragment.glsl", "c"));
+    CHECK(shaders[1]->getID() == shaders[2]->getID());
+
+    std::vector<std::unique_ptr<Material>> materials;
+    for (int i = 0; i < 3; i++) {
+        materials.push_back(std::make_unique<Material>("material" + std::to_string(i), shaders[i].get(), nullptr));
+    }
+
+    std::vector<std::unique_ptr<Mesh>> meshes;
+    std::map<unsigned int, const Mesh*> meshByFirstIndex;
+    for (int i = 0; i < 3; i++) {
+        meshes.push_back(makeMesh("mesh" + std::to_string(i), 1.0f + i));
+        meshByFirstIndex[GeometryArena::get().getCommand(meshes.back()->getArenaHandle()).firstIndex] = meshes.back().get();
+    }
+    CHECK(meshByFirstIndex.size() == meshes.size());
+
+    // Record like the scene's parallel slices do, each buffer on its own
+    std::mt19937 rng(37);
+    std::uniform_int_distribution<int> pick(0, 2);
+    std::uniform_real_distribution<float> distance(1.0f, 100.0f);
+    std::vector<CommandBuffer> buffers(BUFFER_COUNT);
+    std::map<int, Expected> expected;
+    std::multiset<int> submitted;
+    size_t expectedDraws = 0;
+    int nextId = 0;
+    for (CommandBuffer& buffer : buffers) {
+        buffer.begin(glm::mat4(1.0f));
+        std::set<std::tuple<unsigned int, unsigned int, const Mesh*>> keys;
+        for (int i = 0; i < ITEMS_PER_BUFFER; i++) {
+            Shader* shader = shaders[pick(rng)].get();
+            const Material& material = *materials[pick(rng)];
+            const Mesh* mesh = meshes[pick(rng)].get();
+
+            InstanceData instance;
+            instance.model = glm::translate(glm::mat4(1.0f), glm::vec3(0.0f, 0.0f, -distance(rng)));
+            instance.normalMatrix = glm::mat3x4(1.0f);
+            instance.params = glm::vec4(1.0f, 1.0f, 0.0f, static_cast<float>(nextId));
+            buffer.submit(mesh, shader, material, instance);
+
+            expected[nextId] = {shader->getID(), material.getID(), mesh};
+            submitted.insert(nextId++);
+            keys.insert({shader->getID(), material.getID(), mesh});
+        }
+        buffer.end();
+
+        // Equal program, material and mesh always end up in one instanced draw
+        size_t draws = 0;
+        for (const Command& command : buffer.getCommands()) {
+            draws += command.type == CommandType::Draw;
+        }
+        CHECK(draws == keys.size());
+        expectedDraws += keys.size();
+    }
+
+    CommandStream stream;
+    stream.merge(buffers);
+    CheckingBackend backend(stream, expected, meshByFirstIndex);
+    stream.replay(backend);
+
+    CHECK(backend.errors == 0);
+    CHECK(backend.wrong == 0);
+    CHECK(backend.drawn == submitted);
+    CHECK(backend.instances == submitted.size());
+    CHECK(backend.commands == expectedDraws);
+    CHECK(backend.drawCalls == stream.getRunCount());
+    CHECK(stream.getDraws().size() == expectedDraws);
+}
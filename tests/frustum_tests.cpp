@@ -0,0 +1,146 @@
+#include <algorithm>
+#include <cmath>
+#include <iomanip>
+#include <limits>
+#include <random>
+#include <glm/gtc/matrix_transform.hpp>
+
+#include "check.hpp"
+#include "frustum.hpp"
+
+// === Constants ===
+static const size_t BENCH_BOXES = 1000000;
+static const int BENCH_REPEATS = 5;
+static const CullKernel KERNELS[] = {CullKernel::Scalar, CullKernel::SSE, CullKernel::AVX2};
+
+// === Helpers ===
+static OBB makeBox(std::mt19937& rng, float spread) {
+    std::uniform_real_distribution<float> position(-spread, spread);
+    std::uniform_real_distribution<float> size(0.1f, 3.0f);
+    std::uniform_real_distribution<float> angle(-180.0f, 180.0f);
+
+    OBB obb;
+    obb.center = glm::vec3(position(rng), position(rng), position(rng));
+    obb.extents = glm::vec3(size(rng), size(rng), size(rng));
+    glm::mat4 rotation = glm::rotate(glm::mat4(1.0f), glm::radians(angle(rng)), glm::vec3(1, 0, 0));
+    rotation = glm::rotate(rotation, glm::radians(angle(rng)), glm::vec3(0, 1, 0));
+    obb.axes = glm::mat3(rotation);
+    return obb;
+}
+
+static Frustum makeFrustum(const glm::vec3& eye, const glm::vec3& target) {
+    glm::mat4 view = glm::lookAt(eye, target, glm::vec3(0.0f, 1.0f, 0.0f));
+    glm::mat4 projection = glm::perspective(glm::radians(60.0f), 16.0f / 9.0f, 0.1f, 100.0f);
+    return Frustum::fromMatrix(projection * view);
+}
+
+// Runs every kernel the CPU has, returns how many disagree with the scalar one
+static int compareKernels(const Frustum& frustum, const OBBArray& boxes) {
+    std::vector<unsigned char> expected, visible;
+    size_t expectedCount = cullOBBs(frustum, boxes, expected, CullKernel::Scalar);
+
+    int mismatches = 0;
+    for (CullKernel kernel : KERNELS) {
+        if (!hasCullKernel(kernel)) continue;
+        size_t count = cullOBBs(frustum, boxes, visible, kernel);
+        if (count != expectedCount || visible != expected) {
+            std::cerr << "    " << getCullKernelName(kernel) << " disagrees with the scalar kernel" << std::endl;
+            mismatches++;
+        }
+    }
+    return mismatches;
+}
+
+// === Tests ===
+TEST(cullKernelsAgree) {
+    std::mt19937 rng(28);
+    std::uniform_real_distribution<float> position(-50.0f, 50.0f);
+
+    // Every tail length past the widest kernel's stride
+    for (size_t count = 0; count <= 17; count++) {
+        OBBArray boxes;
+        for (size_t i = 0; i < count; i++) boxes.push(makeBox(rng, 20.0f));
+        CHECK(compareKernels(makeFrustum(glm::vec3(0.0f, 0.0f, 30.0f), glm::vec3(0.0f)), boxes) == 0);
+    }
+
+    // Many random views, and the kernels against the single-box test
+    OBBArray boxes;
+    std::vector<OBB> list;
+    for (int i = 0; i < 10000; i++) {
+        list.push_back(makeBox(rng, 60.0f));
+        boxes.push(list.back());
+    }
+    for (int view = 0; view < 50; view++) {
+        Frustum frustum = makeFrustum(glm::vec3(position(rng), position(rng), position(rng)),
+                                      glm::vec3(position(rng), position(rng), position(rng)));
+        CHECK(compareKernels(frustum, boxes) == 0);
+
+        std::vector<unsigned char> visible;
+        cullOBBs(frustum, boxes, visible);
+        size_t disagreements = 0;
+        for (size_t i = 0; i < list.size(); i++) {
+            disagreements += (visible[i] != 0) != frustum.intersects(list[i]);
+        }
+        CHECK(disagreements == 0);
+    }
+}
+
+TEST(cullKernelsKeepDegenerateInput) {
+    const float nan = std::numeric_limits<float>::quiet_NaN();
+    const float inf = std::numeric_limits<float>::infinity();
+    std::mt19937 rng(280);
+    Frustum frustum = makeFrustum(glm::vec3(0.0f, 0.0f, 30.0f), glm::vec3(0.0f));
+
+    // NaN and infinite boxes mixed with ordinary ones, NaNs are never culled
+    OBBArray boxes;
+    std::vector<bool> poisoned;
+    for (int i = 0; i < 64; i++) {
+        OBB obb = makeBox(rng, 200.0f);
+        bool poison = i % 3 == 0;
+        if (i % 6 == 0) obb.center.x = nan;
+        else if (i % 6 == 3) obb.axes[1].y = nan;
+        if (i % 5 == 0) obb.extents.z = inf;
+        boxes.push(obb);
+        poisoned.push_back(poison);
+    }
+    CHECK(compareKernels(frustum, boxes) == 0);
+
+    std::vector<unsigned char> visible;
+    cullOBBs(frustum, boxes, visible);
+    for (size_t i = 0; i < poisoned.size(); i++) {
+        if (poisoned[i]) CHECK(visible[i] == 1);
+    }
+
+    // A zero plane culls nothing, a NaN plane from a singular matrix neither
+    Frustum zeroPlane = frustum;
+    zeroPlane.planes[5] = glm::vec4(0.0f);
+    CHECK(compareKernels(zeroPlane, boxes) == 0);
+
+    Frustum singular = Frustum::fromMatrix(glm::mat4(0.0f));
+    CHECK(compareKernels(singular, boxes) == 0);
+    CHECK(cullOBBs(singular, boxes, visible) == boxes.size());
+}
+
+TEST(cullKernelsBenchmark) {
+    std::mt19937 rng(2800);
+    OBBArray boxes;
+    boxes.reserve(BENCH_BOXES);
+    for (size_t i = 0; i < BENCH_BOXES; i++) boxes.push(makeBox(rng, 200.0f));
+    Frustum frustum = makeFrustum(glm::vec3(0.0f, 0.0f, 150.0f), glm::vec3(0.0f));
+
+    std::cout << std::fixed << std::setprecision(3);
+    std::vector<unsigned char> visible;
+    double scalarMs = 0.0;
+    for (CullKernel kernel : KERNELS) {
+        if (!hasCullKernel(kernel)) continue;
+        double bestMs = 1e30;
+        size_t count = 0;
+        for (int repeat = 0; repeat < BENCH_REPEATS; repeat++) {
+            bestMs = std::min(bestMs, timeMs([&]() {count = cullOBBs(frustum, boxes, visible, kernel);}));
+        }
+        if (kernel == CullKernel::Scalar) scalarMs = bestMs;
+        std::cout << "  " << std::setw(6) << getCullKernelName(kernel) << ": " << bestMs << " ms for "
+                  << BENCH_BOXES << " OBBs (" << scalarMs / bestMs << "x scalar), " << count << " visible" << std::endl;
+    }
+    CHECK(compareKernels(frustum, boxes) == 0);
+}
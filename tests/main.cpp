@@ -0,0 +1,28 @@
+#include <iostream>
+
+#include "check.hpp"
+
+// === Registry ===
+std::vector<TestCase>& getTests() {
+    static std::vector<TestCase> tests;
+    return tests;
+}
+
+int& getFailureCount() {
+    static int failures = 0;
+    return failures;
+}
+
+// === Entry point ===
+int main() {
+    int failedTests = 0;
+    for (const TestCase& test : getTests()) {
+        std::cout << "[" << test.name << "]" << std::endl;
+        int before = getFailureCount();
+        test.run();
+        if (getFailureCount() != before) failedTests++;
+    }
+
+    std::cout << getTests().size() - failedTests << "/" << getTests().size() << " tests passed" << std::endl;
+    return failedTests == 0 ? 0 : 1;
+}
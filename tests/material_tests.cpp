@@ -0,0 +1,35 @@
+#include <memory>
+
+#include "check.hpp"
+#include "nullgl.hpp"
+#include "material.hpp"
+#include "renderthread.hpp"
+
+// === Constants ===
+static const int MATERIALS_PER_FRAME = 50;
+
+// === Tests ===
+TEST(materialSlotsOutliveFramesInFlight) {
+    loadNullGL();
+    MaterialBuffer& buffer = MaterialBuffer::get();
+
+    unsigned int released;
+    {
+        Material material("released", nullptr, nullptr);
+        released = material.getID();
+    }
+
+    // Queued frames may still bind the block until every one of them has been uploaded past
+    std::vector<std::unique_ptr<Material>> held;
+    for (size_t frame = 0; frame < RenderThread::SNAPSHOT_COUNT; frame++) {
+        if (frame > 0) buffer.upload();
+        for (int i = 0; i < MATERIALS_PER_FRAME; i++) {
+            held.push_back(std::make_unique<Material>("held", nullptr, nullptr));
+            CHECK(held.back()->getID() != released);
+        }
+    }
+
+    buffer.upload();
+    held.push_back(std::make_unique<Material>("reused", nullptr, nullptr));
+    CHECK(held.back()->getID() == released);
+}
@@ -0,0 +1,220 @@
+#include <algorithm>
+#include <cfloat>
+#include <cmath>
+#include <iomanip>
+#include <random>
+
+#include "check.hpp"
+#include "nullgl.hpp"
+#include "mesh.hpp"
+#include "jobs.hpp"
+
+// === Constants ===
+static const int SIZES[] = {10000, 100000, 1000000}; // Triangles, roughly
+static const int RAYS = 200;
+static const double QUERY_BUDGET_MS = 1.0; // Mean per ray on the largest mesh
+
+// === Helpers ===
+// Sphere with a few overlapping waves on it, so rays graze and hit more than one layer
+static void makeBumpySphere(int triangles, std::vector<Vertex>& vertices, std::vector<unsigned int>& indices) {
+    int stacks = std::max(2, static_cast<int>(std::sqrt(triangles / 4.0)));
+    int slices = stacks * 2;
+    vertices.clear();
+    indices.clear();
+    for (int i = 0; i <= stacks; i++) {
+        float phi = 3.14159265f * i / stacks;
+        for (int j = 0; j <= slices; j++) {
+            float theta = 6.2831853f * j / slices;
+            glm::vec3 normal(std::sin(phi) * std::cos(theta), std::cos(phi), std::sin(phi) * std::sin(theta));
+            float radius = 1.0f + 0.08f * std::sin(phi * 13.0f) * std::cos(theta * 9.0f) + 0.03f * std::sin(theta * 57.0f);
+            Vertex vertex = {};
+            vertex.position = normal * radius;
+            vertex.normal = normal;
+            vertices.push_back(vertex);
+        }
+    }
+    for (int i = 0; i < stacks; i++) {
+        for (int j = 0; j < slices; j++) {
+            unsigned int a = i * (slices + 1) + j;
+            unsigned int b = a + slices + 1;
+            indices.insert(indices.end(), {a, a + 1, b, a + 1, b + 1, b});
+        }
+    }
+}
+
+// Same Moller-Trumbore as the tree, over every triangle
+static bool intersectBruteForce(const std::vector<Vertex>& vertices, const std::vector<unsigned int>& indices,
+                                const glm::vec3& origin, const glm::vec3& dir, MeshHit& hit) {
+    hit.t = FLT_MAX;
+    hit.triangle = -1;
+    for (size_t triangle = 0; triangle < indices.size() / 3; triangle++) {
+        const glm::vec3& a = vertices[indices[triangle * 3]].position;
+        const glm::vec3& b = vertices[indices[triangle * 3 + 1]].position;
+        const glm::vec3& c = vertices[indices[triangle * 3 + 2]].position;
+        glm::vec3 edge1 = b - a;
+        glm::vec3 edge2 = c - a;
+        glm::vec3 p = glm::cross(dir, edge2);
+        float det = glm::dot(edge1, p);
+        if (det == 0.0f) continue;
+        float invDet = 1.0f / det;
+        glm::vec3 s = origin - a;
+        float u = glm::dot(s, p) * invDet;
+        if (u < 0.0f || u > 1.0f) continue;
+        glm::vec3 q = glm::cross(s, edge1);
+        float v = glm::dot(dir, q) * invDet;
+        if (v < 0.0f || u + v > 1.0f) continue;
+        float t = glm::dot(edge2, q) * invDet;
+        if (t >= 0.0f && t < hit.t) {
+            hit.t = t;
+            hit.triangle = static_cast<int>(triangle);
+            hit.barycentrics = glm::vec2(u, v);
+        }
+    }
+    return hit.triangle != -1;
+}
+
+// Returns whether the tree and the linear scan report the same hit, ties on a shared edge may name either triangle
+static bool sameHit(const std::vector<Vertex>& vertices, const std::vector<unsigned int>& indices,
+                    const glm::vec3& origin, const glm::vec3& dir, bool treeFound, const MeshHit& tree,
+                    bool bruteFound, const MeshHit& brute) {
+    if (treeFound != bruteFound) return false;
+    if (!treeFound) return true;
+    if (tree.t != brute.t) return false;
+    if (tree.triangle == brute.triangle) return tree.barycentrics == brute.barycentrics;
+
+    // Recompute the tree's triangle on its own, it has to be the same distance
+    std::vector<unsigned int> single(indices.begin() + tree.triangle * 3, indices.begin() + tree.triangle * 3 + 3);
+    MeshHit alone;
+    return intersectBruteForce(vertices, single, origin, dir, alone) && alone.t == tree.t && alone.barycentrics == tree.barycentrics;
+}
+
+// === Tests ===
+TEST(meshBVHMatchesBruteForce) {
+    std::mt19937 rng(46);
+    std::normal_distribution<float> normal;
+    std::uniform_real_distribution<float> inside(-0.9f, 0.9f);
+    std::cout << std::fixed << std::setprecision(4);
+
+    for (int size : SIZES) {
+        std::vector<Vertex> vertices;
+        std::vector<unsigned int> indices;
+        makeBumpySphere(size, vertices, indices);
+
+        MeshBVH bvh;
+        double buildMs = timeMs([&]() {bvh.build(vertices, indices);});
+        CHECK(bvh.getTriangleCount() == indices.size() / 3);
+
+        // Rays from outside through the inside, a quarter of them aimed anywhere and often missing
+        int mismatches = 0, hits = 0;
+        double treeMs = 0.0, worstMs = 0.0, bruteMs = 0.0;
+        for (int r = 0; r < RAYS; r++) {
+            glm::vec3 origin = glm::normalize(glm::vec3(normal(rng), normal(rng), normal(rng))) * 3.0f;
+            glm::vec3 target = r % 4 ? glm::vec3(inside(rng), inside(rng), inside(rng)) : origin + glm::vec3(normal(rng), normal(rng), normal(rng));
+            glm::vec3 dir = (target - origin) * 0.5f; // Not normalized on purpose
+
+            MeshHit tree, brute;
+            bool treeFound = false, bruteFound = false;
+            double ms = timeMs([&]() {treeFound = bvh.intersect(vertices, indices, origin, dir, tree);});
+            treeMs += ms;
+            worstMs = std::max(worstMs, ms);
+            bruteMs += timeMs([&]() {bruteFound = intersectBruteForce(vertices, indices, origin, dir, brute);});
+
+            hits += treeFound;
+            mismatches += !sameHit(vertices, indices, origin, dir, treeFound, tree, bruteFound, brute);
+            if (treeFound) CHECK(glm::length(tree.point - (origin + dir * tree.t)) < 1e-5f);
+        }
+        CHECK(mismatches == 0);
+        CHECK(hits > RAYS / 2);
+        if (size == SIZES[2]) CHECK(treeMs / RAYS < QUERY_BUDGET_MS);
+
+        std::cout << "  " << std::setw(7) << indices.size() / 3 << " triangles: build " << buildMs << " ms, "
+                  << bvh.getNodeCount() << " nodes, " << treeMs / RAYS << " ms per ray (worst " << worstMs << ") vs "
+                  << bruteMs / RAYS << " ms brute force, " << mismatches << " mismatches" << std::endl;
+    }
+}
+
+TEST(meshBVHHandlesDegenerateMeshes) {
+    std::mt19937 rng(460);
+    std::uniform_real_distribution<float> position(-1.0f, 1.0f);
+
+    // Every triangle in the z = 0 plane, a quarter of them the same one stacked on a spot
+    const glm::vec3 stacked[3] = {glm::vec3(-0.05f, -0.05f, 0.0f), glm::vec3(0.05f, -0.05f, 0.0f), glm::vec3(0.0f, 0.05f, 0.0f)};
+    std::vector<Vertex> vertices;
+    std::vector<unsigned int> indices;
+    for (int i = 0; i < 20000; i++) {
+        bool isStacked = i % 4 == 0;
+        glm::vec3 center = isStacked ? glm::vec3(0.25f, -0.5f, 0.0f) : glm::vec3(position(rng), position(rng), 0.0f);
+        for (int corner = 0; corner < 3; corner++) {
+            Vertex vertex = {};
+            vertex.position = center + (isStacked ? stacked[corner] : glm::vec3(position(rng), position(rng), 0.0f) * 0.05f);
+            indices.push_back(static_cast<unsigned int>(vertices.size()));
+            vertices.push_back(vertex);
+        }
+    }
+
+    MeshBVH bvh;
+    double buildMs = timeMs([&]() {bvh.build(vertices, indices);});
+    CHECK(bvh.getTriangleCount() == indices.size() / 3);
+    CHECK(bvh.getNodeCount() < indices.size() / 3 * 2);
+
+    // Down onto the plane, along it and away from it
+    int mismatches = 0;
+    for (int r = 0; r < RAYS; r++) {
+        glm::vec3 origin(position(rng), position(rng), 2.0f);
+        glm::vec3 dir;
+        if (r % 3 == 0) dir = glm::vec3(position(rng), position(rng), -1.0f);
+        else if (r % 3 == 1) {
+            origin.z = 0.0f;
+            dir = glm::vec3(position(rng), position(rng), 0.0f);
+        } else dir = glm::vec3(position(rng), position(rng), 1.0f);
+
+        MeshHit tree, brute;
+        bool treeFound = bvh.intersect(vertices, indices, origin, dir, tree);
+        bool bruteFound = intersectBruteForce(vertices, indices, origin, dir, brute);
+        mismatches += !sameHit(vertices, indices, origin, dir, treeFound, tree, bruteFound, brute);
+        if (r % 3 == 2) CHECK(!treeFound);
+    }
+    CHECK(mismatches == 0);
+
+    // Straight down onto the stacked spot
+    MeshHit hit;
+    CHECK(bvh.intersect(vertices, indices, glm::vec3(0.25f, -0.5f, 1.0f), glm::vec3(0.0f, 0.0f, -1.0f), hit));
+    CHECK(std::fabs(hit.t - 1.0f) < 1e-6f);
+
+    // A ray passing beside everything, and an empty tree
+    MeshBVH empty;
+    empty.build(vertices, {});
+    CHECK(!bvh.intersect(vertices, indices, glm::vec3(5.0f, 5.0f, 1.0f), glm::vec3(1.0f, 0.0f, 0.0f), hit));
+    CHECK(!empty.intersect(vertices, {}, glm::vec3(0.0f, 0.0f, 1.0f), glm::vec3(0.0f, 0.0f, -1.0f), hit));
+
+    std::cout << "  " << indices.size() / 3 << " coplanar triangles: build " << std::fixed << std::setprecision(3)
+              << buildMs << " ms, " << bvh.getNodeCount() << " nodes, " << mismatches << " mismatches" << std::endl;
+}
+
+TEST(meshBVHBuildsInBackground) {
+    loadNullGL();
+    std::vector<Vertex> vertices;
+    std::vector<unsigned int> indices;
+    makeBumpySphere(SIZES[2], vertices, indices);
+
+    // Loading only queues the build, the first ray waits for whatever is left of it
+    Mesh mesh("bumpy", vertices, indices);
+    double requestMs = timeMs([&]() {mesh.requestBVH();});
+    MeshHit hit, brute;
+    bool found = false;
+    glm::vec3 origin(0.1f, 0.2f, 3.0f), dir(0.0f, 0.0f, -1.0f);
+    double firstRayMs = timeMs([&]() {found = mesh.raycast(origin, dir, hit);});
+    CHECK(found);
+    CHECK(intersectBruteForce(vertices, indices, origin, dir, brute) && hit.t == brute.t);
+    CHECK(mesh.getBVH().getTriangleCount() == indices.size() / 3);
+
+    // Meshes going away with their build queued or running
+    makeBumpySphere(SIZES[0], vertices, indices);
+    for (int i = 0; i < 50; i++) {
+        Mesh shortLived("short", vertices, indices);
+        shortLived.requestBVH();
+    }
+
+    std::cout << "  " << std::fixed << std::setprecision(3) << "request " << requestMs << " ms, first ray "
+              << firstRayMs << " ms on " << JobSystem::get().getThreadCount() << " threads" << std::endl;
+}
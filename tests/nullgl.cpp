@@ -0,0 +1,106 @@
+#include <glad/glad.h>
+#include <cstdint>
+#include <cstring>
+
+#include "nullgl.hpp"
+
+// === Constants ===
+static const char* NULL_VERSION = "4.6.0 NullGL";
+static const char* NULL_EXTENSION = "GL_NULL_none";
+
+// === Names ===
+static unsigned int nextName = 1;
+
+void setNextNullGLName(unsigned int name) {
+    nextName = name;
+}
+
+// === Stand-ins ===
+static const GLubyte* APIENTRY nullGetString(GLenum name) {
+    return reinterpret_cast<const GLubyte*>(name == GL_VERSION ? NULL_VERSION : "");
+}
+
+static const GLubyte* APIENTRY nullGetStringi(GLenum, GLuint) {
+    return reinterpret_cast<const GLubyte*>(NULL_EXTENSION);
+}
+
+static void APIENTRY nullGetIntegerv(GLenum name, GLint* data) {
+    switch (name) {
+    case GL_NUM_EXTENSIONS:
+        *data = 1;
+        break;
+    case GL_UNIFORM_BUFFER_OFFSET_ALIGNMENT:
+    case GL_SHADER_STORAGE_BUFFER_OFFSET_ALIGNMENT:
+        *data = 256;
+        break;
+    default:
+        *data = 0;
+        break;
+    }
+}
+
+// Compile, link and completion status all succeed with an empty log
+static void APIENTRY nullGetObjectiv(GLuint, GLenum name, GLint* data) {
+    *data = name == GL_INFO_LOG_LENGTH ? 0 : GL_TRUE;
+}
+
+static GLuint APIENTRY nullCreate(GLenum) {
+    return nextName++;
+}
+
+static GLuint APIENTRY nullCreateProgram() {
+    return nextName++;
+}
+
+static void APIENTRY nullGen(GLsizei count, GLuint* names) {
+    for (GLsizei i = 0; i < count; i++) {
+        names[i] = nextName++;
+    }
+}
+
+static GLenum APIENTRY nullCheckFramebufferStatus(GLenum) {
+    return GL_FRAMEBUFFER_COMPLETE;
+}
+
+static GLenum APIENTRY nullClientWaitSync(GLsync, GLbitfield, GLuint64) {
+    return GL_ALREADY_SIGNALED;
+}
+
+// Everything else returns zero. The callers' arguments sit in registers the
+// stand-in never reads, which the platforms the tests run on allow.
+static intptr_t APIENTRY nullEntry() {
+    return 0;
+}
+
+// === Loader ===
+static void* getNullProc(const char* name) {
+    struct Entry {
+        const char* name;
+        void* proc;
+    };
+    static const Entry entries[] = {
+        {"glGetString", reinterpret_cast<void*>(&nullGetString)},
+        {"glGetStringi", reinterpret_cast<void*>(&nullGetStringi)},
+        {"glGetIntegerv", reinterpret_cast<void*>(&nullGetIntegerv)},
+        {"glGetShaderiv", reinterpret_cast<void*>(&nullGetObjectiv)},
+        {"glGetProgramiv", reinterpret_cast<void*>(&nullGetObjectiv)},
+        {"glCreateShader", reinterpret_cast<void*>(&nullCreate)},
+        {"glCreateProgram", reinterpret_cast<void*>(&nullCreateProgram)},
+        {"glGenBuffers", reinterpret_cast<void*>(&nullGen)},
+        {"glGenVertexArrays", reinterpret_cast<void*>(&nullGen)},
+        {"glGenTextures", reinterpret_cast<void*>(&nullGen)},
+        {"glGenFramebuffers", reinterpret_cast<void*>(&nullGen)},
+        {"glGenRenderbuffers", reinterpret_cast<void*>(&nullGen)},
+        {"glGenQueries", reinterpret_cast<void*>(&nullGen)},
+        {"glCheckFramebufferStatus", reinterpret_cast<void*>(&nullCheckFramebufferStatus)},
+        {"glClientWaitSync", reinterpret_cast<void*>(&nullClientWaitSync)},
+    };
+    for (const Entry& entry : entries) {
+        if (std::strcmp(entry.name, name) == 0) return entry.proc;
+    }
+    return reinterpret_cast<void*>(&nullEntry);
+}
+
+void loadNullGL() {
+    gladLoadGLLoader(getNullProc);
+}
@@ -0,0 +1,10 @@
+#pragma once
+
+// Null GL definition
+// Fills glad's entry points with stand-ins so meshes, shaders and materials
+// can be created and recorded without a context. Object names come from a
+// counter, status queries report success and everything else does nothing.
+void loadNullGL();
+
+// Next name handed out, rewinding it gives two objects the same GL name
+void setNextNullGLName(unsigned int name);
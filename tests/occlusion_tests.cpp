@@ -0,0 +1,203 @@
+#include <algorithm>
+#include <cfloat>
+#include <cmath>
+#include <memory>
+#include <random>
+#include <glm/gtc/matrix_transform.hpp>
+
+#include "check.hpp"
+#include "nullgl.hpp"
+#include "occlusion.hpp"
+
+// === Constants ===
+static const int BUFFER_WIDTH = 256;
+static const int BUFFER_HEIGHT = 128;
+static const int BOX_COUNT = 4000;
+
+// === Helpers ===
+// Unit quad in the xy plane, scaled and placed into walls
+static std::unique_ptr<Mesh> makeQuad() {
+    std::vector<Vertex> vertices(4);
+    vertices[0].position = glm::vec3(-0.5f, -0.5f, 0.0f);
+    vertices[1].position = glm::vec3(0.5f, -0.5f, 0.0f);
+    vertices[2].position = glm::vec3(0.5f, 0.5f, 0.0f);
+    vertices[3].position = glm::vec3(-0.5f, 0.5f, 0.0f);
+    auto mesh = std::make_unique<Mesh>("quad", vertices, std::vector<unsigned int>{0, 1, 2, 0, 2, 3});
+    mesh->calculateBounds(vertices);
+    return mesh;
+}
+
+static glm::mat4 makeViewProjection() {
+    glm::mat4 view = glm::lookAt(glm::vec3(0.0f), glm::vec3(0.0f, 0.0f, -1.0f), glm::vec3(0.0f, 1.0f, 0.0f));
+    glm::mat4 projection = glm::perspective(glm::radians(60.0f), static_cast<float>(BUFFER_WIDTH) / BUFFER_HEIGHT, 0.1f, 100.0f);
+    return projection * view;
+}
+
+static float toDepth(const glm::mat4& viewProjection, const glm::vec3& point) {
+    glm::vec4 clip = viewProjection * glm::vec4(point, 1.0f);
+    return clip.z / clip.w * 0.5f + 0.5f;
+}
+
+// Nearest entry of a ray into an OBB, FLT_MAX on a miss
+static float getEntry(const OBB& obb, const glm::vec3& origin, const glm::vec3& dir) {
+    glm::vec3 localOrigin = glm::transpose(obb.axes) * (origin - obb.center);
+    glm::vec3 localDir = glm::transpose(obb.axes) * dir;
+    float enter = 0.0f, exit = FLT_MAX;
+    for (int i = 0; i < 3; i++) {
+        float t0 = (-obb.extents[i] - localOrigin[i]) / localDir[i];
+        float t1 = (obb.extents[i] - localOrigin[i]) / localDir[i];
+        enter = std::max(enter, std::min(t0, t1));
+        exit = std::min(exit, std::max(t0, t1));
+    }
+    return enter <= exit ? enter : FLT_MAX;
+}
+
+// Nearest occluder triangle along a ray, FLT_MAX on a miss
+static float getOccluderEntry(const std::vector<glm::vec3>& triangles, const glm::vec3& origin, const glm::vec3& dir) {
+    float closest = FLT_MAX;
+    for (size_t i = 0; i + 2 < triangles.size(); i += 3) {
+        glm::vec3 edge1 = triangles[i + 1] - triangles[i];
+        glm::vec3 edge2 = triangles[i + 2] - triangles[i];
+        glm::vec3 p = glm::cross(dir, edge2);
+        float det = glm::dot(edge1, p);
+        if (det == 0.0f) continue;
+        glm::vec3 s = origin - triangles[i];
+        float u = glm::dot(s, p) / det;
+        glm::vec3 q = glm::cross(s, edge1);
+        float v = glm::dot(dir, q) / det;
+        float t = glm::dot(edge2, q) / det;
+        if (u >= 0.0f && v >= 0.0f && u + v <= 1.0f && t >= 0.0f) closest = std::min(closest, t);
+    }
+    return closest;
+}
+
+// Visible when any pixel center sees the box in front of every occluder
+static bool isVisibleBruteForce(const OBB& obb, const std::vector<glm::vec3>& triangles, const glm::mat4& viewProjection) {
+    glm::mat4 inverse = glm::inverse(viewProjection);
+    for (int y = 0; y < BUFFER_HEIGHT; y++) {
+        for (int x = 0; x < BUFFER_WIDTH; x++) {
+            glm::vec2 ndc((x + 0.5f) / BUFFER_WIDTH * 2.0f - 1.0f, (y + 0.5f) / BUFFER_HEIGHT * 2.0f - 1.0f);
+            glm::vec4 near = inverse * glm::vec4(ndc, -1.0f, 1.0f);
+            glm::vec4 far = inverse * glm::vec4(ndc, 1.0f, 1.0f);
+            glm::vec3 origin = glm::vec3(near) / near.w;
+            glm::vec3 dir = glm::vec3(far) / far.w - origin;
+
+            float boxT = getEntry(obb, origin, dir);
+            if (boxT == FLT_MAX) continue;
+            float occluderT = getOccluderEntry(triangles, origin, dir);
+            if (occluderT == FLT_MAX) return true;
+            if (toDepth(viewProjection, origin + dir * boxT) < toDepth(viewProjection, origin + dir * occluderT)) return true;
+        }
+    }
+    return false;
+}
+
+static OBB makeBox(const glm::vec3& center, const glm::vec3& extents, float yaw = 0.0f) {
+    OBB obb;
+    obb.center = center;
+    obb.extents = extents;
+    obb.axes = glm::mat3(glm::rotate(glm::mat4(1.0f), glm::radians(yaw), glm::vec3(0.0f, 1.0f, 0.0f)));
+    return obb;
+}
+
+// === Tests ===
+TEST(occlusionNeverCullsVisibleBoxes) {
+    loadNullGL();
+    std::unique_ptr<Mesh> quad = makeQuad();
+    glm::mat4 viewProjection = makeViewProjection();
+
+    // A few walls at different depths, partly overlapping on screen
+    const glm::mat4 walls[] = {
+        glm::scale(glm::translate(glm::mat4(1.0f), glm::vec3(-2.3f, 0.4f, -8.0f)), glm::vec3(6.1f, 4.3f, 1.0f)),
+        glm::scale(glm::translate(glm::mat4(1.0f), glm::vec3(3.1f, -0.7f, -12.0f)), glm::vec3(7.7f, 5.2f, 1.0f)),
+        glm::rotate(glm::scale(glm::translate(glm::mat4(1.0f), glm::vec3(0.6f, 1.3f, -20.0f)), glm::vec3(9.4f, 3.9f, 1.0f)),
+                    glm::radians(35.0f), glm::vec3(0.0f, 1.0f, 0.0f)),
+    };
+
+    OcclusionCuller culler(BUFFER_WIDTH, BUFFER_HEIGHT);
+    culler.beginFrame(viewProjection);
+    std::vector<glm::vec3> triangles;
+    for (const glm::mat4& wall : walls) {
+        culler.addOccluder(*quad, wall);
+        for (unsigned int index : quad->getIndices()) {
+            triangles.push_back(glm::vec3(wall * glm::vec4(quad->getVertices()[index].position, 1.0f)));
+        }
+    }
+    culler.rasterize();
+    CHECK(culler.getStats().triangles == 6);
+
+    // Boxes scattered in front of, between and behind the walls, all past the near plane
+    std::mt19937 rng(30);
+    std::uniform_real_distribution<float> depth(-40.0f, -2.0f);
+    std::uniform_real_distribution<float> spread(-1.0f, 1.0f);
+    std::uniform_real_distribution<float> size(0.05f, 1.5f);
+    std::uniform_real_distribution<float> yaw(0.0f, 360.0f);
+    std::vector<OBB> boxes;
+    std::vector<const OBB*> pointers;
+    for (int i = 0; i < BOX_COUNT; i++) {
+        float z = depth(rng);
+        boxes.push_back(makeBox(glm::vec3(spread(rng) * -z, spread(rng) * -z * 0.5f, z), glm::vec3(size(rng), size(rng), size(rng)), yaw(rng)));
+    }
+
+    // Small boxes hugging the walls' edges just behind them, where conservative rounding matters
+    std::uniform_real_distribution<float> along(-0.6f, 0.6f);
+    std::uniform_real_distribution<float> edge(0.4f, 0.6f);
+    std::uniform_real_distribution<float> gap(0.01f, 0.3f);
+    std::uniform_real_distribution<float> small(0.005f, 0.1f);
+    for (int i = 0; i < BOX_COUNT; i++) {
+        const glm::mat4& wall = walls[i % 3];
+        float side = (i / 3) % 2 ? 1.0f : -1.0f;
+        glm::vec3 local = (i / 6) % 2 ? glm::vec3(edge(rng) * side, along(rng), 0.0f) : glm::vec3(along(rng), edge(rng) * side, 0.0f);
+        glm::vec3 center = glm::vec3(wall * glm::vec4(local, 1.0f)) - glm::normalize(glm::vec3(wall[2])) * gap(rng);
+        boxes.push_back(makeBox(center, glm::vec3(small(rng), small(rng), small(rng))));
+    }
+    for (const OBB& obb : boxes) pointers.push_back(&obb);
+
+    std::vector<unsigned char> visible;
+    size_t visibleCount = 0;
+    double cullMs = timeMs([&]() {visibleCount = culler.cullOBBs(pointers, visible);});
+
+    // Culling a box the brute force sees is a false negative, keeping a hidden one only costs a draw
+    size_t falseNegatives = 0;
+    size_t hidden = 0;
+    for (size_t i = 0; i < boxes.size(); i++) {
+        bool bruteVisible = isVisibleBruteForce(boxes[i], triangles, viewProjection);
+        falseNegatives += bruteVisible && !visible[i];
+        hidden += !bruteVisible;
+    }
+    CHECK(falseNegatives == 0);
+    CHECK(visibleCount < boxes.size());
+
+    std::cout << "  " << boxes.size() << " boxes: " << boxes.size() - visibleCount << " culled of " << hidden
+              << " hidden in " << cullMs << " ms, " << falseNegatives << " false negatives" << std::endl;
+}
+
+TEST(occlusionKeepsEdgeCases) {
+    loadNullGL();
+    std::unique_ptr<Mesh> quad = makeQuad();
+    glm::mat4 viewProjection = makeViewProjection();
+    glm::mat4 wall = glm::scale(glm::translate(glm::mat4(1.0f), glm::vec3(0.0f, 0.0f, -5.0f)), glm::vec3(40.0f, 40.0f, 1.0f));
+
+    OBB behind = makeBox(glm::vec3(0.0f, 0.0f, -20.0f), glm::vec3(1.0f));
+    OBB crossingNear = makeBox(glm::vec3(0.0f, 0.0f, -3.0f), glm::vec3(0.3f, 0.3f, 3.0f)); // Reaches past the wall
+    OBB offScreen = makeBox(glm::vec3(200.0f, 0.0f, -20.0f), glm::vec3(1.0f));
+
+    // A wall filling the screen hides the box behind it, but not boxes it can't reason about
+    OcclusionCuller culler(BUFFER_WIDTH, BUFFER_HEIGHT);
+    culler.beginFrame(viewProjection);
+    culler.addOccluder(*quad, wall);
+    culler.rasterize();
+    CHECK(!culler.isVisible(behind));
+    CHECK(culler.isVisible(crossingNear));
+    CHECK(culler.isVisible(offScreen));
+
+    // Without occluders nothing is culled
+    culler.beginFrame(viewProjection);
+    culler.rasterize();
+    CHECK(culler.isVisible(behind));
+    CHECK(culler.isVisible(crossingNear));
+    CHECK(culler.isVisible(offScreen));
+
+    std::vector<unsigned char> visible;
+    CHECK(culler.cullOBBs({&behind, &crossingNear, &offScreen}, visible) == 3);
+}
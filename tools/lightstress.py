@@ -0,0 +1,71 @@
+#!/usr/bin/env python3
+# Writes the lightstress scene for the clustered lighting: a ground plane,
+# 100 pillars and 4096 small lights, a quarter of them spots.
+# Run from the repository root, or through `make benchscenes`.
+
+import random
+
+# === Constants ===
+PILLAR_GRID = 10
+LIGHT_GRID = 64
+SCENE_PATH = "assets/scenes/lightstress.scn"
+
+
+# ### Scene ###
+def write_object(objects, name, mesh, texture, position, scale, rotation=None, texture_scale=None, static=False, light=None):
+    lines = ["object " + name, "mesh " + mesh, "shader default", "texture " + texture]
+    if texture_scale:
+        lines.append("texturescale %g %g" % texture_scale)
+    lines.append("position %g %g %g" % position)
+    if rotation:
+        lines.append("rotation %g %g %g" % rotation)
+    lines.append("scale %g %g %g" % scale)
+    if static:
+        lines.append("isStatic 1")
+    if light:
+        lines.append("light " + light)
+    lines += ["parent None", "endobject", ""]
+    objects.append("\n".join(lines))
+
+
+def write_scene():
+    # Placement and intensities use separate streams, so tuning one leaves the other alone
+    rng = random.Random(35)
+    intensity = random.Random(7)
+    objects = []
+
+    write_object(objects, "ground", "plane", "cobblestone.jpg", (0, -2, -40), (100, 1, 100), texture_scale=(40, 40), static=True)
+    n = 0
+    for i in range(PILLAR_GRID):
+        for j in range(PILLAR_GRID):
+            n += 1
+            write_object(objects, "pillar%d" % n, "cube", "gray.png", (-36 + i * 8, 0, -4 - j * 8), (1.5, 4, 1.5), static=True)
+
+    # Lights on a jittered grid between the pillars, every fourth one a spot pointing down
+    n = 0
+    for i in range(LIGHT_GRID):
+        for j in range(LIGHT_GRID):
+            n += 1
+            x = -40 + i * 1.25 + rng.uniform(-0.4, 0.4)
+            z = -j * 1.25 - 1 + rng.uniform(-0.4, 0.4)
+            y = rng.uniform(-1.5, 2.5)
+            r, g, b = [round(rng.uniform(0.2, 1), 2) for _ in range(3)]
+            reach = round(rng.uniform(2.5, 5), 2)
+            rng.random()  # Formerly the intensity, kept so the layout stays put
+            power = round(intensity.uniform(0.6, 1.6), 2)
+
+            position = (round(x, 3), round(y, 3), round(z, 3))
+            if n % 4 == 0:
+                write_object(objects, "light%d" % n, "cube", "white.png", position, (0.1, 0.1, 0.1), rotation=(-90, 0, 0),
+                             light="spot %g %g %g %g %g 20 35" % (r, g, b, power, reach + 2))
+            else:
+                write_object(objects, "light%d" % n, "cube", "white.png", position, (0.1, 0.1, 0.1),
+                             light="point %g %g %g %g %g" % (r, g, b, power, reach))
+
+    with open(SCENE_PATH, "w", newline="\n") as file:
+        file.write("\n".join(objects))
+
+
+if __name__ == "__main__":
+    write_scene()
+    print("Wrote " + SCENE_PATH)
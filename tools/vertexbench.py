@@ -0,0 +1,76 @@
+#!/usr/bin/env python3
+# Writes the vertexbench scene and its dense sphere mesh. Both are generated
+# instead of checked in; the mesh is only parsed by the editor once this ran.
+# Run from the repository root, or through `make benchscenes`.
+
+import math
+import random
+
+# === Constants ===
+STACKS = 64
+SLICES = 64
+LAYERS = 4
+ROWS = 6
+COLUMNS = 20
+TEXTURES = ["default.jpg", "wood.jpg", "cobblestone.jpg"]
+MESH_PATH = "assets/models/sphere_64.vert"
+SCENE_PATH = "assets/scenes/vertexbench.scn"
+
+
+# ### Mesh ###
+# UV sphere of radius 0.5, 4225 vertices
+def write_sphere():
+    lines = ["# Dense UV sphere (64 stacks, 64 slices) for vertex throughput tests", "n sphere_64", ""]
+    for i in range(STACKS + 1):
+        phi = math.pi * i / STACKS
+        for j in range(SLICES + 1):
+            theta = 2 * math.pi * j / SLICES
+            x = math.sin(phi) * math.cos(theta)
+            y = math.cos(phi)
+            z = math.sin(phi) * math.sin(theta)
+            lines.append("v %.5f %.5f %.5f  %.5f %.5f %.5f  1.0 1.0 1.0  %.5f %.5f"
+                         % (x * 0.5, y * 0.5, z * 0.5, x, y, z, j / SLICES, i / STACKS))
+    lines.append("")
+
+    # The pole rows collapse to a point, so each only keeps one triangle per quad
+    for i in range(STACKS):
+        for j in range(SLICES):
+            a = i * (SLICES + 1) + j
+            b = a + SLICES + 1
+            if i != 0:
+                lines.append("i %d %d %d" % (a, a + 1, b))
+            if i != STACKS - 1:
+                lines.append("i %d %d %d" % (a + 1, b + 1, b))
+
+    with open(MESH_PATH, "w", newline="\n") as file:
+        file.write("\n".join(lines) + "\n")
+
+
+# ### Scene ###
+# 480 spheres in a grid, every other one with non-uniform scale
+def write_scene():
+    rng = random.Random(33)
+    objects = []
+    n = 0
+    for layer in range(LAYERS):
+        for row in range(ROWS):
+            for column in range(COLUMNS):
+                n += 1
+                x = -19 + column * 2.0
+                y = -5 + row * 2.0
+                z = -6 - layer * 6.0
+                scale = (1.2, 1.2, 1.2) if n % 2 else (1.5, 0.8, 1.1)
+                rotation = (rng.randint(0, 359), rng.randint(0, 359), 0)
+                objects.append("object sphere%d\nmesh sphere_64\nshader default\ntexture %s\ntexturescale 1 1\n"
+                               "position %g %g %g\nrotation %d %d %d\nscale %g %g %g\n"
+                               "isPlayer 0\nisStatic 0\nparent None\nendobject\n"
+                               % ((n, TEXTURES[n % 3], x, y, z) + rotation + scale))
+
+    with open(SCENE_PATH, "w", newline="\n") as file:
+        file.write("\n".join(objects) + "\n")
+
+
+if __name__ == "__main__":
+    write_sphere()
+    write_scene()
+    print("Wrote " + MESH_PATH + " and " + SCENE_PATH)